@@ -0,0 +1,18 @@
+//! Logging macros: defmt over RTT on the target, stdout on the host, where
+//! no defmt logger is linked. Format strings must stay valid for both.
+
+#[cfg(not(feature = "host-target"))]
+macro_rules! log_info { ($($arg:tt)*) => { defmt::info!($($arg)*) }; }
+#[cfg(not(feature = "host-target"))]
+macro_rules! log_debug { ($($arg:tt)*) => { defmt::debug!($($arg)*) }; }
+#[cfg(not(feature = "host-target"))]
+macro_rules! log_trace { ($($arg:tt)*) => { defmt::trace!($($arg)*) }; }
+
+#[cfg(feature = "host-target")]
+macro_rules! log_info { ($($arg:tt)*) => { std::println!("[FW] {}", format_args!($($arg)*)) }; }
+#[cfg(feature = "host-target")]
+macro_rules! log_debug { ($($arg:tt)*) => { std::println!("[FW] {}", format_args!($($arg)*)) }; }
+// Trace messages fire on every heartbeat and UART byte; not worth the
+// host's stdout cost.
+#[cfg(feature = "host-target")]
+macro_rules! log_trace { ($($arg:tt)*) => { { let _ = format_args!($($arg)*); } }; }
@@ -1,6 +1,7 @@
-#![no_std]
-#![no_main]
+#![cfg_attr(not(feature = "host-target"), no_std)]
+#![cfg_attr(not(feature = "host-target"), no_main)]
 
+#[cfg(not(feature = "host-target"))]
 use panic_halt as _;
 
 #[cfg(feature = "cortex-m-target")]
@@ -9,12 +10,16 @@ use cortex_m_rt::entry;
 #[cfg(feature = "riscv-target")]
 use riscv_rt::entry;
 
+#[cfg(not(feature = "host-target"))]
 use defmt_rtt as _;
 use heapless::Vec;
 use heapless::String;
 use heapless::spsc::{Consumer, Producer, Queue};
 use fugit::{Duration, Instant};
 
+#[macro_use]
+mod log;
+mod mmio;
 mod peripheral;
 mod protocol;
 
@@ -50,7 +55,7 @@ impl System {
         self.gpio.init();
         self.timer.init();
         
-        defmt::info!("System initialized");
+        log_info!("System initialized");
     }
 
     pub fn run(&mut self) -> ! {
@@ -77,30 +82,30 @@ impl System {
         match cmd {
             Command::SetGpio { pin, state } => {
                 self.gpio.set_pin(pin, state);
-                defmt::info!("GPIO pin {} set to {}", pin, state);
+                log_info!("GPIO pin {} set to {}", pin, state);
             }
             Command::SendMessage { data } => {
                 self.uart.write(&data);
-                defmt::info!("Sent message: {:?}", data);
+                log_info!("Sent message: {:?}", data);
             }
             Command::Reset => {
-                defmt::info!("System reset requested");
-                cortex_m::peripheral::SCB::sys_reset();
+                log_info!("System reset requested");
+                mmio::sys_reset();
             }
         }
     }
 
     fn process_uart_data(&mut self, data: u8) {
-        defmt::trace!("UART data received: {}", data);
+        log_trace!("UART data received: {}", data);
     }
 
     fn heartbeat(&mut self) {
         self.gpio.toggle_led();
-        defmt::trace!("Heartbeat");
+        log_trace!("Heartbeat");
     }
 }
 
-#[entry]
+#[cfg_attr(not(feature = "host-target"), entry)]
 fn main() -> ! {
     let mut system = System::new();
     system.init();
@@ -0,0 +1,68 @@
+//! Register access for the peripheral drivers. On hardware (and in QEMU)
+//! these are volatile loads and stores. With the `host-target` feature the
+//! firmware runs as a host program, and each access calls straight into
+//! the SystemC models through the C ABI in `systemc/host_bridge.h`.
+
+#[cfg(feature = "host-target")]
+mod host {
+    extern "C" {
+        pub fn host_mmio_read(addr: u32, size: u32) -> u32;
+        pub fn host_mmio_write(addr: u32, size: u32, value: u32);
+        pub fn host_system_reset();
+    }
+}
+
+#[cfg(not(feature = "host-target"))]
+#[inline(always)]
+pub fn read32(addr: u32) -> u32 {
+    unsafe { core::ptr::read_volatile(addr as *const u32) }
+}
+
+#[cfg(not(feature = "host-target"))]
+#[inline(always)]
+pub fn write32(addr: u32, value: u32) {
+    unsafe { core::ptr::write_volatile(addr as *mut u32, value) }
+}
+
+#[cfg(not(feature = "host-target"))]
+#[inline(always)]
+pub fn read8(addr: u32) -> u8 {
+    unsafe { core::ptr::read_volatile(addr as *const u8) }
+}
+
+#[cfg(not(feature = "host-target"))]
+#[inline(always)]
+pub fn write8(addr: u32, value: u8) {
+    unsafe { core::ptr::write_volatile(addr as *mut u8, value) }
+}
+
+#[cfg(feature = "host-target")]
+pub fn read32(addr: u32) -> u32 {
+    unsafe { host::host_mmio_read(addr, 4) }
+}
+
+#[cfg(feature = "host-target")]
+pub fn write32(addr: u32, value: u32) {
+    unsafe { host::host_mmio_write(addr, 4, value) }
+}
+
+#[cfg(feature = "host-target")]
+pub fn read8(addr: u32) -> u8 {
+    unsafe { host::host_mmio_read(addr, 1) as u8 }
+}
+
+#[cfg(feature = "host-target")]
+pub fn write8(addr: u32, value: u8) {
+    unsafe { host::host_mmio_write(addr, 1, value as u32) }
+}
+
+/// Resets the system; on the host this ends the run.
+pub fn sys_reset() -> ! {
+    #[cfg(feature = "host-target")]
+    {
+        unsafe { host::host_system_reset() };
+        unreachable!()
+    }
+    #[cfg(not(feature = "host-target"))]
+    cortex_m::peripheral::SCB::sys_reset()
+}
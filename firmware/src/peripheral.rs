@@ -1,5 +1,7 @@
 use heapless::Vec;
 
+use crate::mmio;
+
 pub struct Uart {
     buffer: Vec<u8, 256>,
 }
@@ -12,21 +14,19 @@ impl Uart {
     }
 
     pub fn init(&mut self) {
-        defmt::debug!("UART initialized");
+        log_debug!("UART initialized");
     }
 
     pub fn write(&mut self, data: &[u8]) {
         for &byte in data {
-            unsafe {
-                core::ptr::write_volatile(0x4000_4400 as *mut u8, byte);
-            }
+            mmio::write8(0x4000_4400, byte);
         }
     }
 
     pub fn read(&mut self) -> Option<u8> {
-        let status = unsafe { core::ptr::read_volatile(0x4000_4404 as *const u32) };
+        let status = mmio::read32(0x4000_4404);
         if status & 0x01 != 0 {
-            Some(unsafe { core::ptr::read_volatile(0x4000_4400 as *const u8) })
+            Some(mmio::read8(0x4000_4400))
         } else {
             None
         }
@@ -43,22 +43,16 @@ impl Gpio {
     }
 
     pub fn init(&mut self) {
-        unsafe {
-            let gpio_base = 0x4002_0000 as *mut u32;
-            core::ptr::write_volatile(gpio_base.offset(0), 0x0000_0001);
-        }
-        defmt::debug!("GPIO initialized");
+        mmio::write32(0x4002_0000, 0x0000_0001);
+        log_debug!("GPIO initialized");
     }
 
     pub fn set_pin(&mut self, pin: u8, state: bool) {
-        unsafe {
-            let gpio_base = 0x4002_0000 as *mut u32;
-            let current = core::ptr::read_volatile(gpio_base.offset(1));
-            if state {
-                core::ptr::write_volatile(gpio_base.offset(1), current | (1 << pin));
-            } else {
-                core::ptr::write_volatile(gpio_base.offset(1), current & !(1 << pin));
-            }
+        let current = mmio::read32(0x4002_0004);
+        if state {
+            mmio::write32(0x4002_0004, current | (1 << pin));
+        } else {
+            mmio::write32(0x4002_0004, current & !(1 << pin));
         }
     }
 
@@ -78,15 +72,12 @@ impl Timer {
     }
 
     pub fn init(&mut self) {
-        unsafe {
-            let tim_base = 0x4000_0000 as *mut u32;
-            core::ptr::write_volatile(tim_base.offset(0), 0x0000_0001);
-        }
-        defmt::debug!("Timer initialized");
+        mmio::write32(0x4000_0000, 0x0000_0001);
+        log_debug!("Timer initialized");
     }
 
     pub fn get_tick(&mut self) -> fugit::Instant<u32, 1, 1000> {
-        self.counter = unsafe { core::ptr::read_volatile(0x4000_0004 as *const u32) };
+        self.counter = mmio::read32(0x4000_0004);
         fugit::Instant::from_ticks(self.counter)
     }
 }
\ No newline at end of file
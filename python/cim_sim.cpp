@@ -0,0 +1,209 @@
+// Python bindings for the CIM array model (//rtl/memory:memory_bridge).
+//
+// NumPy arrays are passed through the buffer protocol. Their data pointers
+// become TLM payload data pointers, so weights, inputs and results are
+// never copied. Arguments must already be C-contiguous with the right
+// dtype (int8 in, int32 out); anything else raises TypeError instead of
+// being converted silently. The GIL is released while the model runs.
+//
+// SystemC elaborates once per process, so one CimArray per interpreter;
+// parallel sweeps use one process per configuration.
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rust_bindings/memory_interface.h"
+
+namespace py = pybind11;
+
+namespace {
+
+const uint64_t CTRL_REG_OFFSET = 0x0000;
+const uint64_t SHADOW_BASE_REG_OFFSET = 0x0028;
+const uint64_t MEMO_ENTRIES_REG_OFFSET = 0x002C;
+const uint64_t MEMO_HITS_REG_OFFSET = 0x0030;
+const uint64_t MEMO_MISSES_REG_OFFSET = 0x0034;
+const uint64_t INPUT_BASE = 0x10000;
+const uint64_t RESULT_BASE = 0x20000;
+const uint64_t WEIGHT_BASE = 0x100000;
+const uint32_t CTRL_COMPUTE = 1u << 0;
+const uint32_t CTRL_MODE_SHIFT = 1;
+const uint32_t CTRL_SWAP = 1u << 4;
+
+enum ComputeMode {
+    MODE_MAC = 0,
+    MODE_ADD = 1,
+    MODE_SHIFT = 2,
+    MODE_XOR = 3
+};
+
+typedef py::array_t<int8_t, py::array::c_style> Int8Array;
+typedef py::array_t<int32_t, py::array::c_style> Int32Array;
+
+MemIfRequest make_request(uint64_t addr, void* data, size_t len, bool is_write) {
+    MemIfRequest request = {};
+    request.addr = addr;
+    request.data = static_cast<uint8_t*>(data);
+    request.len = static_cast<uint32_t>(len);
+    request.is_write = is_write;
+    return request;
+}
+
+class CimArray {
+public:
+    CimArray(uint32_t rows, uint32_t cols, uint32_t data_width, uint32_t compute_width)
+        : rows(rows), cols(cols) {
+        system = memif_create(rows, cols, data_width, compute_width);
+        if (!system) {
+            throw std::runtime_error("cannot create a " + std::to_string(rows) + "x" + std::to_string(cols) +
+                                     " array (out of range, or one already exists in this process)");
+        }
+    }
+
+    // Ends the simulation; a deleted array cannot be replaced in this process.
+    ~CimArray() { memif_destroy(system); }
+
+    CimArray(const CimArray&) = delete;
+    CimArray& operator=(const CimArray&) = delete;
+
+    // shadow=True loads the shadow bank; computes use it after swap_weights().
+    void load_weights(Int8Array weights, bool shadow) {
+        if (weights.ndim() != 2 || weights.shape(0) != py::ssize_t(rows) || weights.shape(1) != py::ssize_t(cols)) {
+            throw py::value_error("weights must have shape (rows, cols)");
+        }
+        uint64_t base = shadow ? read_register(SHADOW_BASE_REG_OFFSET) : WEIGHT_BASE;
+        // Writes only read their buffer, so read-only arrays are fine.
+        std::vector<MemIfRequest> batch = {
+            make_request(base, const_cast<int8_t*>(weights.data()), weights.nbytes(), true)};
+        submit(batch);
+    }
+
+    void swap_weights() {
+        unsigned char ctrl[4] = {static_cast<unsigned char>(CTRL_SWAP), 0, 0, 0};
+        std::vector<MemIfRequest> batch = {make_request(CTRL_REG_OFFSET, ctrl, 4, true)};
+        submit(batch);
+    }
+
+    // Memoises up to `entries` computes; 0 turns it off.
+    void set_memo(uint32_t entries) {
+        unsigned char value[4] = {static_cast<unsigned char>(entries), static_cast<unsigned char>(entries >> 8),
+                                  static_cast<unsigned char>(entries >> 16), static_cast<unsigned char>(entries >> 24)};
+        std::vector<MemIfRequest> batch = {make_request(MEMO_ENTRIES_REG_OFFSET, value, 4, true)};
+        submit(batch);
+    }
+
+    py::tuple memo_stats() {
+        return py::make_tuple(read_register(MEMO_HITS_REG_OFFSET), read_register(MEMO_MISSES_REG_OFFSET));
+    }
+
+    // inputs: (rows,) or (n, rows); results: (cols,) or (n, cols).
+    Int32Array compute(Int8Array inputs, ComputeMode mode, py::object out) {
+        bool single = inputs.ndim() == 1;
+        if ((inputs.ndim() != 1 && inputs.ndim() != 2) || inputs.shape(inputs.ndim() - 1) != py::ssize_t(rows)) {
+            throw py::value_error("inputs must have shape (rows,) or (n, rows)");
+        }
+        py::ssize_t vectors = single ? 1 : inputs.shape(0);
+
+        Int32Array results;
+        if (out.is_none()) {
+            results = single ? Int32Array(cols) : Int32Array({vectors, static_cast<py::ssize_t>(cols)});
+        } else {
+            // Checked by hand: a cast would convert (copy) a mismatched array.
+            if (!py::isinstance<py::array>(out)) {
+                throw py::type_error("out must be a NumPy array");
+            }
+            py::array array = py::reinterpret_borrow<py::array>(out);
+            if (!array.dtype().is(py::dtype::of<int32_t>()) || !(array.flags() & py::array::c_style) ||
+                !array.writeable()) {
+                throw py::type_error("out must be a writable C-contiguous int32 array");
+            }
+            // The exact shape, not just the size: (cols,) or (n, cols).
+            bool shape_ok = array.ndim() == inputs.ndim() && array.shape(array.ndim() - 1) == py::ssize_t(cols) &&
+                            (single || array.shape(0) == vectors);
+            if (!shape_ok) {
+                throw py::value_error("out must have shape (cols,) or (n, cols) to match inputs");
+            }
+            results = py::reinterpret_borrow<Int32Array>(array);
+        }
+
+        uint32_t ctrl_value = CTRL_COMPUTE | (static_cast<uint32_t>(mode) << CTRL_MODE_SHIFT);
+        unsigned char ctrl[4] = {static_cast<unsigned char>(ctrl_value), 0, 0, 0};
+        int8_t* in = const_cast<int8_t*>(inputs.data());
+        int32_t* res = results.mutable_data();
+        std::vector<MemIfRequest> batch;
+        batch.reserve(3 * vectors);
+        for (py::ssize_t i = 0; i < vectors; ++i) {
+            batch.push_back(make_request(INPUT_BASE, in + i * rows, rows, true));
+            batch.push_back(make_request(CTRL_REG_OFFSET, ctrl, 4, true));
+            batch.push_back(make_request(RESULT_BASE, res + i * cols, cols * 4, false));
+        }
+        submit(batch);
+        return results;
+    }
+
+    uint32_t read_register(uint64_t offset) {
+        unsigned char value[4] = {0, 0, 0, 0};
+        std::vector<MemIfRequest> batch = {make_request(offset, value, 4, false)};
+        submit(batch);
+        return value[0] | (value[1] << 8) | (value[2] << 16) | (static_cast<uint32_t>(value[3]) << 24);
+    }
+
+    uint32_t rows;
+    uint32_t cols;
+
+    uint64_t transactions() const { return memif_transactions(system); }
+    uint64_t sim_time_ps() const { return memif_sim_time_ps(system); }
+    uint64_t region_size() const { return memif_region_size(system); }
+
+private:
+    void submit(std::vector<MemIfRequest>& batch) {
+        size_t done;
+        {
+            // Buffers stay referenced by the caller's frame; the lock keeps
+            // other Python threads out of the (single-threaded) kernel.
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> guard(lock);
+            done = memif_submit(system, batch.data(), batch.size());
+        }
+        if (done < batch.size()) {
+            throw std::runtime_error("transaction " + std::to_string(done) + " failed with status " +
+                                     std::to_string(batch[done].status));
+        }
+    }
+
+    MemIfSystem* system;
+    std::mutex lock;
+};
+
+} // namespace
+
+PYBIND11_MODULE(cim_sim, m) {
+    m.doc() = "Zero-copy bindings for the SystemC CIM array model";
+
+    py::enum_<ComputeMode>(m, "ComputeMode")
+        .value("MAC", MODE_MAC)
+        .value("ADD", MODE_ADD)
+        .value("SHIFT", MODE_SHIFT)
+        .value("XOR", MODE_XOR);
+
+    py::class_<CimArray>(m, "CimArray")
+        .def(py::init<uint32_t, uint32_t, uint32_t, uint32_t>(), py::arg("rows"), py::arg("cols"),
+             py::arg("data_width") = 8, py::arg("compute_width") = 16)
+        .def("load_weights", &CimArray::load_weights, py::arg("weights").noconvert(), py::arg("shadow") = false)
+        .def("swap_weights", &CimArray::swap_weights)
+        .def("set_memo", &CimArray::set_memo, py::arg("entries"))
+        .def("memo_stats", &CimArray::memo_stats, "(hits, misses) of the result memo")
+        .def("compute", &CimArray::compute, py::arg("inputs").noconvert(),
+             py::arg("mode") = MODE_MAC, py::arg("out") = py::none())
+        .def("read_register", &CimArray::read_register, py::arg("offset"))
+        .def_readonly("rows", &CimArray::rows)
+        .def_readonly("cols", &CimArray::cols)
+        .def_property_readonly("transactions", &CimArray::transactions)
+        .def_property_readonly("sim_time_ps", &CimArray::sim_time_ps)
+        .def_property_readonly("region_size", &CimArray::region_size);
+}
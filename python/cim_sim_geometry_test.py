@@ -0,0 +1,36 @@
+"""cim_sim.CimArray must refuse geometries and precisions the model cannot
+hold with an exception, instead of aborting or corrupting the process."""
+
+import unittest
+
+import cim_sim
+
+BAD = [
+    (0, 16, 8, 16),
+    (16, 0, 8, 16),
+    (16, 16, 9, 16),
+    (16, 16, 8, 33),
+    (0x8001, 1, 8, 16),
+    (1, 0x40000000, 8, 16),
+    (1, 0xC0000000, 8, 16),
+    (0x8000, 0x38000, 8, 16),
+]
+
+
+class GeometryTest(unittest.TestCase):
+    def test_refused(self):
+        for rows, cols, data_width, compute_width in BAD:
+            with self.subTest(rows=rows, cols=cols, data_width=data_width, compute_width=compute_width):
+                with self.assertRaises(RuntimeError):
+                    cim_sim.CimArray(rows, cols, data_width, compute_width)
+
+    def test_valid_after_refused(self):
+        for rows, cols, data_width, compute_width in BAD:
+            with self.assertRaises(RuntimeError):
+                cim_sim.CimArray(rows, cols, data_width, compute_width)
+        array = cim_sim.CimArray(16, 16)
+        self.assertEqual((array.rows, array.cols), (16, 16))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,101 @@
+"""cim_sim.CimArray.compute through the buffer protocol: one vector (gemv)
+and a batch (gemm), each with and without out=, in every mode, against
+NumPy. Runs in its own process, since there is one array per process."""
+
+import unittest
+
+import numpy as np
+
+import cim_sim
+
+ROWS = 16
+COLS = 24
+BATCH = 5
+
+
+def wrap16(sums):
+    return ((sums + 2 ** 15) % 2 ** 16 - 2 ** 15).astype(np.int32)
+
+
+def expected(weights, inputs, mode):
+    """Column sums of an 8-bit, 16-bit-accumulator array with every row and
+    column enabled. inputs is (rows,) or (n, rows)."""
+    w = weights.astype(np.int64)
+    x = inputs.astype(np.int64)[..., :, np.newaxis]
+    if mode == cim_sim.ComputeMode.MAC:
+        cells = w * x
+    elif mode == cim_sim.ComputeMode.ADD:
+        cells = w + x
+    elif mode == cim_sim.ComputeMode.SHIFT:
+        cells = (w & 0xFF) * (x & 0xFF)
+    else:
+        cells = (w ^ x) & 0xFF
+    return wrap16(cells.sum(axis=-2))
+
+
+class ComputeTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        rng = np.random.default_rng(3)
+        cls.weights = rng.integers(-128, 128, size=(ROWS, COLS), dtype=np.int8)
+        cls.vector = rng.integers(-128, 128, size=ROWS, dtype=np.int8)
+        cls.batch = rng.integers(-128, 128, size=(BATCH, ROWS), dtype=np.int8)
+        cls.array = cim_sim.CimArray(ROWS, COLS)
+        cls.array.load_weights(cls.weights)
+
+    def test_gemv(self):
+        for mode in cim_sim.ComputeMode.__members__.values():
+            with self.subTest(mode=mode):
+                result = self.array.compute(self.vector, mode)
+                self.assertEqual((result.dtype, result.shape), (np.int32, (COLS,)))
+                np.testing.assert_array_equal(result, expected(self.weights, self.vector, mode))
+
+    def test_gemm(self):
+        for mode in cim_sim.ComputeMode.__members__.values():
+            with self.subTest(mode=mode):
+                result = self.array.compute(self.batch, mode)
+                self.assertEqual((result.dtype, result.shape), (np.int32, (BATCH, COLS)))
+                np.testing.assert_array_equal(result, expected(self.weights, self.batch, mode))
+
+    def test_out_is_written_in_place(self):
+        out = np.full(COLS, -1, dtype=np.int32)
+        self.assertIs(self.array.compute(self.vector, out=out), out)
+        np.testing.assert_array_equal(out, expected(self.weights, self.vector, cim_sim.ComputeMode.MAC))
+
+        out = np.full((BATCH, COLS), -1, dtype=np.int32)
+        self.array.compute(self.batch, cim_sim.ComputeMode.XOR, out=out)
+        np.testing.assert_array_equal(out, expected(self.weights, self.batch, cim_sim.ComputeMode.XOR))
+
+    def test_rows_of_a_batch_match_single_vectors(self):
+        batch = self.array.compute(self.batch)
+        for i in range(BATCH):
+            np.testing.assert_array_equal(batch[i], self.array.compute(self.batch[i]))
+
+    def test_bad_shapes(self):
+        with self.assertRaises(ValueError):
+            self.array.compute(np.zeros(ROWS + 1, dtype=np.int8))
+        with self.assertRaises(ValueError):
+            self.array.compute(np.zeros((2, 2, ROWS), dtype=np.int8))
+        with self.assertRaises(ValueError):
+            self.array.compute(self.vector, out=np.zeros(COLS + 1, dtype=np.int32))
+        with self.assertRaises(ValueError):
+            self.array.compute(self.batch, out=np.zeros((BATCH + 1, COLS), dtype=np.int32))
+        # Same size, different shape.
+        with self.assertRaises(ValueError):
+            self.array.compute(self.batch, out=np.zeros((COLS, BATCH), dtype=np.int32))
+        with self.assertRaises(ValueError):
+            self.array.load_weights(np.zeros((COLS, ROWS), dtype=np.int8))
+
+    def test_no_silent_conversion(self):
+        with self.assertRaises(TypeError):
+            self.array.compute(self.vector.astype(np.int16))
+        with self.assertRaises(TypeError):
+            self.array.compute(np.zeros((BATCH, 2 * ROWS), dtype=np.int8)[:, ::2])
+        with self.assertRaises(TypeError):
+            self.array.compute(self.vector, out=np.zeros(COLS, dtype=np.int64))
+        with self.assertRaises(TypeError):
+            self.array.compute(self.batch, out=np.zeros((COLS, BATCH), dtype=np.int32).T)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,136 @@
+#include "qemu/osdep.h"
+#include "qapi/error.h"
+#include "qemu/timer.h"
+#include "qemu/host-utils.h"
+#include "exec/memory.h"
+#include "hw/core/cpu.h"
+#include "hw/irq.h"
+#include "hw/qdev-core.h"
+
+#include "cosim_shm.h"
+#include "systemc/cosim_channel.h"
+
+// Interrupt poll period in guest time; also bounds how far the server's
+// clock can lag behind while the firmware makes no accesses
+#define COSIM_IRQ_POLL_NS 10000
+
+struct CosimShm {
+    MemoryRegion iomem;
+    CosimChannel *channel;
+    QEMUTimer poll_timer;
+    qemu_irq irqs[COSIM_IRQ_LINES];
+    uint32_t irq_seq;
+    uint32_t level[COSIM_IRQ_WORDS];
+};
+
+// Runs on the accessing vCPU's thread without the BQL. Each vCPU posts
+// into the shared ring and waits on its own response slot.
+static MemTxResult cosim_shm_access(CosimShm *s, uint32_t cmd, hwaddr addr,
+                                    uint64_t *data, unsigned size)
+{
+    CosimChannel *channel = s->channel;
+    uint32_t vcpu = current_cpu ? current_cpu->cpu_index : 0;
+    uint64_t response_data = 0;
+    uint32_t ticket;
+
+    if (vcpu >= COSIM_MAX_VCPUS) {
+        return MEMTX_ERROR;
+    }
+
+    ticket = cosim_post(channel, vcpu, cmd, size, addr, *data,
+                        qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL));
+    if (cosim_wait_response(channel, vcpu, ticket, &response_data) != COSIM_STATUS_OK) {
+        return MEMTX_ERROR;
+    }
+    *data = response_data;
+    return MEMTX_OK;
+}
+
+static MemTxResult cosim_shm_read(void *opaque, hwaddr addr, uint64_t *data,
+                                  unsigned size, MemTxAttrs attrs)
+{
+    *data = 0;
+    return cosim_shm_access(opaque, COSIM_CMD_READ, addr, data, size);
+}
+
+static MemTxResult cosim_shm_write(void *opaque, hwaddr addr, uint64_t data,
+                                   unsigned size, MemTxAttrs attrs)
+{
+    return cosim_shm_access(opaque, COSIM_CMD_WRITE, addr, &data, size);
+}
+
+static const MemoryRegionOps cosim_shm_ops = {
+    .read_with_attrs = cosim_shm_read,
+    .write_with_attrs = cosim_shm_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid = {
+        .min_access_size = 1,
+        .max_access_size = 8,
+    },
+};
+
+// Runs in the main loop with the BQL held. Applies every interrupt change
+// the server published since the last poll, then republishes guest time.
+static void cosim_shm_poll(void *opaque)
+{
+    CosimShm *s = opaque;
+    CosimChannel *channel = s->channel;
+    int64_t now = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    uint32_t seq = cosim_load(&channel->irq_seq);
+
+    if (seq != s->irq_seq) {
+        s->irq_seq = seq;
+        for (int i = 0; i < COSIM_IRQ_WORDS; i++) {
+            uint32_t pulse = __atomic_exchange_n(&channel->irq_pulse[i], 0, __ATOMIC_ACQ_REL);
+            uint32_t level = __atomic_load_n(&channel->irq_level[i], __ATOMIC_ACQUIRE);
+            uint32_t changed = (level ^ s->level[i]) | pulse;
+
+            while (changed) {
+                int bit = ctz32(changed);
+                qemu_irq irq = s->irqs[i * 32 + bit];
+
+                changed &= changed - 1;
+                // A pulse may have dropped (or dropped and risen) again
+                // before this poll; replay the edge so the NVIC latches it
+                if (pulse & (1u << bit)) {
+                    qemu_irq_lower(irq);
+                    qemu_irq_raise(irq);
+                }
+                qemu_set_irq(irq, (level >> bit) & 1);
+            }
+            s->level[i] = level;
+        }
+    }
+
+    __atomic_store_n(&channel->guest_time_ns, now, __ATOMIC_RELAXED);
+    timer_mod(&s->poll_timer, now + COSIM_IRQ_POLL_NS);
+}
+
+void cosim_shm_connect_irqs(CosimShm *s, DeviceState *nvic)
+{
+    for (int i = 0; i < COSIM_IRQ_LINES; i++) {
+        s->irqs[i] = qdev_get_gpio_in(nvic, i);
+    }
+    timer_init_ns(&s->poll_timer, QEMU_CLOCK_VIRTUAL, cosim_shm_poll, s);
+    timer_mod(&s->poll_timer, qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL));
+}
+
+CosimShm *cosim_shm_init(MemoryRegion *parent, hwaddr base, uint64_t size,
+                         const char *shm_name, Error **errp)
+{
+    CosimShm *s = g_new0(CosimShm, 1);
+
+    s->channel = cosim_channel_open(shm_name, 0);
+    if (!s->channel) {
+        error_setg(errp, "cosim-shm: cannot map channel %s", shm_name);
+        g_free(s);
+        return NULL;
+    }
+
+    memory_region_init_io(&s->iomem, NULL, &cosim_shm_ops, s, "cosim-shm", size);
+    // The channel is safe for concurrent producers, so vCPUs under MTTCG
+    // do not serialise on the BQL while waiting for SystemC.
+    memory_region_clear_global_locking(&s->iomem);
+    memory_region_add_subregion(parent, base, &s->iomem);
+    return s;
+}
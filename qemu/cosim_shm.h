@@ -0,0 +1,22 @@
+#ifndef COSIM_SHM_H
+#define COSIM_SHM_H
+
+#include "exec/memory.h"
+#include "hw/qdev-core.h"
+
+// Maps an MMIO window at `base` whose accesses are forwarded to a SystemC
+// server over the shared-memory channel `shm_name` (systemc/cosim_channel.h).
+// The vCPU waits for each response, so firmware sees SystemC register
+// semantics synchronously; a server error becomes a bus fault. Accesses
+// run outside the BQL, so several vCPUs may be in flight at once.
+typedef struct CosimShm CosimShm;
+
+CosimShm *cosim_shm_init(MemoryRegion *parent, hwaddr base, uint64_t size,
+                         const char *shm_name, Error **errp);
+
+// Routes the server's interrupt lines to the GPIO inputs of `nvic` (an
+// armv7m) and starts polling for them. Edges published between two polls
+// are applied together.
+void cosim_shm_connect_irqs(CosimShm *s, DeviceState *nvic);
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef CUSTOM_ARM_H
+#define CUSTOM_ARM_H
+
+// Limits of the custom-arm machines in machine_config.c, shared with the
+// tools that launch them (tools/cosim/orchestrator.cpp).
+#define CUSTOM_ARM_MC_MAX_CORES 4
+
+#endif
@@ -6,24 +6,72 @@
 #include "hw/sysbus.h"
 #include "exec/address-spaces.h"
 #include "sysemu/sysemu.h"
+#include "qapi/error.h"
+#include "hw/core/cpu.h"
+#include "sysemu/reset.h"
+
+#include "cosim_shm.h"
+#include "custom_arm.h"
 
 #define FLASH_BASE 0x08000000
 #define FLASH_SIZE (256 * 1024)
 #define SRAM_BASE  0x20000000
 #define SRAM_SIZE  (64 * 1024)
 #define PERIPH_BASE 0x40000000
+// Up to the end of the GPIO port at 0x40020000, so the co-simulation
+// window covers the timer, UART and GPIO of firmware/src/peripheral.rs
+#define PERIPH_SIZE 0x20400
+#define SYSINFO_BASE 0x40001000
+#define MAX_CORES CUSTOM_ARM_MC_MAX_CORES
 
 typedef struct {
     MachineState parent;
-    ARMv7MState armv7m;
+    ARMv7MState armv7m[MAX_CORES];
+    char *cosim_shm;
 } CustomMachineState;
 
-static void custom_machine_init(MachineState *machine)
+// SYSINFO: 0x0 CORE_ID of the accessing core, 0x4 NUM_CORES (read-only)
+static uint64_t sysinfo_read(void *opaque, hwaddr addr, unsigned size)
+{
+    MachineState *machine = opaque;
+    
+    switch (addr) {
+    case 0x0:
+        return current_cpu ? current_cpu->cpu_index : 0;
+    case 0x4:
+        return machine->smp.cpus;
+    default:
+        return 0;
+    }
+}
+
+static void sysinfo_write(void *opaque, hwaddr addr, uint64_t value, unsigned size)
+{
+}
+
+static const MemoryRegionOps sysinfo_ops = {
+    .read = sysinfo_read,
+    .write = sysinfo_write,
+    .endianness = DEVICE_LITTLE_ENDIAN,
+    .valid = {
+        .min_access_size = 4,
+        .max_access_size = 4,
+    },
+};
+
+// armv7m_load_kernel() only registers a reset for the boot core
+static void custom_core_reset(void *opaque)
+{
+    cpu_reset(CPU(opaque));
+}
+
+static void custom_machine_init_cores(MachineState *machine, unsigned int num_cores)
 {
     CustomMachineState *s = (CustomMachineState *)machine;
     MemoryRegion *system_memory = get_system_memory();
     MemoryRegion *flash = g_new(MemoryRegion, 1);
     MemoryRegion *sram = g_new(MemoryRegion, 1);
+    CosimShm *cosim = NULL;
     
     // Initialize Flash memory
     memory_region_init_rom(flash, NULL, "flash", FLASH_SIZE, &error_fatal);
@@ -33,19 +81,72 @@ static void custom_machine_init(MachineState *machine)
     memory_region_init_ram(sram, NULL, "sram", SRAM_SIZE, &error_fatal);
     memory_region_add_subregion(system_memory, SRAM_BASE, sram);
     
-    // Initialize ARMv7M
-    object_initialize_child(OBJECT(machine), "armv7m", &s->armv7m, TYPE_ARMV7M);
-    qdev_prop_set_uint32(DEVICE(&s->armv7m), "num-irq", 96);
-    qdev_prop_set_string(DEVICE(&s->armv7m), "cpu-type", machine->cpu_type);
-    qdev_prop_set_bit(DEVICE(&s->armv7m), "enable-bitband", true);
-    object_property_set_link(OBJECT(&s->armv7m), "memory",
-                             OBJECT(system_memory), &error_abort);
-    sysbus_realize(SYS_BUS_DEVICE(&s->armv7m), &error_fatal);
+    // Peripheral window served by a SystemC co-simulation server
+    if (s->cosim_shm) {
+        cosim = cosim_shm_init(system_memory, PERIPH_BASE, PERIPH_SIZE, s->cosim_shm, &error_fatal);
+    }
+    
+    // Initialize ARMv7M, one per core; all cores share flash, SRAM and
+    // the peripheral bridge, each with its own NVIC
+    for (unsigned int i = 0; i < num_cores; i++) {
+        ARMv7MState *armv7m = &s->armv7m[i];
+        char *name = num_cores > 1 ? g_strdup_printf("armv7m[%u]", i) : g_strdup("armv7m");
+        
+        object_initialize_child(OBJECT(machine), name, armv7m, TYPE_ARMV7M);
+        qdev_prop_set_uint32(DEVICE(armv7m), "num-irq", 96);
+        qdev_prop_set_string(DEVICE(armv7m), "cpu-type", machine->cpu_type);
+        qdev_prop_set_bit(DEVICE(armv7m), "enable-bitband", true);
+        object_property_set_link(OBJECT(armv7m), "memory",
+                                 OBJECT(system_memory), &error_abort);
+        sysbus_realize(SYS_BUS_DEVICE(armv7m), &error_fatal);
+        g_free(name);
+    }
+    
+    // SystemC interrupts go to the boot core's NVIC
+    if (cosim) {
+        cosim_shm_connect_irqs(cosim, DEVICE(&s->armv7m[0]));
+    }
     
     // Load firmware
     if (machine->firmware) {
         armv7m_load_kernel(ARM_CPU(first_cpu), machine->firmware, 0, FLASH_SIZE);
     }
+    for (unsigned int i = 1; i < num_cores; i++) {
+        qemu_register_reset(custom_core_reset, s->armv7m[i].cpu);
+    }
+}
+
+static void custom_machine_init(MachineState *machine)
+{
+    custom_machine_init_cores(machine, 1);
+}
+
+// Multi-core variant: every core boots the same image and tells itself
+// apart through SYSINFO.CORE_ID. Runs under multi-threaded TCG
+// (-accel tcg,thread=multi), one host thread per core.
+static void custom_mc_machine_init(MachineState *machine)
+{
+    MemoryRegion *sysinfo = g_new(MemoryRegion, 1);
+    
+    memory_region_init_io(sysinfo, NULL, &sysinfo_ops, machine, "sysinfo", 0x8);
+    memory_region_clear_global_locking(sysinfo);
+    // Inside the co-simulation window, which it takes precedence over
+    memory_region_add_subregion_overlap(get_system_memory(), SYSINFO_BASE, sysinfo, 1);
+    
+    custom_machine_init_cores(machine, machine->smp.cpus);
+}
+
+static char *custom_machine_get_cosim_shm(Object *obj, Error **errp)
+{
+    CustomMachineState *s = (CustomMachineState *)obj;
+    return g_strdup(s->cosim_shm);
+}
+
+static void custom_machine_set_cosim_shm(Object *obj, const char *value, Error **errp)
+{
+    CustomMachineState *s = (CustomMachineState *)obj;
+    g_free(s->cosim_shm);
+    s->cosim_shm = g_strdup(value);
 }
 
 static void custom_machine_class_init(ObjectClass *oc, void *data)
@@ -55,6 +156,21 @@ static void custom_machine_class_init(ObjectClass *oc, void *data)
     mc->desc = "Custom ARM Cortex-M4 board";
     mc->init = custom_machine_init;
     mc->default_cpu_type = ARM_CPU_TYPE_NAME("cortex-m4");
+    
+    object_class_property_add_str(oc, "cosim-shm", custom_machine_get_cosim_shm,
+                                  custom_machine_set_cosim_shm);
+    object_class_property_set_description(oc, "cosim-shm",
+                                          "Shared-memory channel of a SystemC co-simulation server");
+}
+
+static void custom_mc_machine_class_init(ObjectClass *oc, void *data)
+{
+    MachineClass *mc = MACHINE_CLASS(oc);
+    
+    mc->desc = "Custom ARM multi-core Cortex-M4 board";
+    mc->init = custom_mc_machine_init;
+    mc->default_cpus = 2;
+    mc->max_cpus = MAX_CORES;
 }
 
 static const TypeInfo custom_machine_type = {
@@ -64,9 +180,16 @@ static const TypeInfo custom_machine_type = {
     .class_init = custom_machine_class_init,
 };
 
+static const TypeInfo custom_mc_machine_type = {
+    .name = MACHINE_TYPE_NAME("custom-arm-mc"),
+    .parent = MACHINE_TYPE_NAME("custom-arm"),
+    .class_init = custom_mc_machine_class_init,
+};
+
 static void custom_machine_register_types(void)
 {
     type_register_static(&custom_machine_type);
+    type_register_static(&custom_mc_machine_type);
 }
 
 type_init(custom_machine_register_types)
\ No newline at end of file
@@ -0,0 +1,317 @@
+// TCG plugin modelling L1 instruction/data caches and an optional unified
+// TLB in front of the zero-latency flash and SRAM regions, so firmware
+// runs report estimated cycles rather than just a functional result.
+//
+//   -plugin libcache_model.so,icache_size=4k,icache_assoc=2,icache_line=32,
+//           dcache_size=4k,dcache_assoc=4,dcache_line=32,tlb_entries=0,
+//           miss_penalty=10,tlb_penalty=20,sample=1,cpu_hz=80000000
+//
+// A size or tlb_entries of 0 disables that structure. sample=N simulates
+// one window of sample_window accesses in every N and extrapolates the
+// miss counts from the sampled miss rate. Addresses are virtual: Cortex-M
+// and bare-metal RISC-V run untranslated, so they equal physical ones.
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <qemu-plugin.h>
+
+#include "cache_sim.h"
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
+
+#define MAX_USER_VCPUS 64
+#define TLB_PAGE_SIZE 4096
+
+typedef struct {
+    CacheSim icache;
+    CacheSim dcache;
+    CacheSim tlb;
+    uint64_t insns;
+    uint64_t fetches;       // fetch groups, i.e. TLB lookups from the I side
+    uint64_t loads;
+    uint64_t stores;
+    uint64_t io_accesses;
+    uint64_t events;        // sampling position
+} VcpuState;
+
+static struct {
+    uint64_t icache_size, icache_assoc, icache_line;
+    uint64_t dcache_size, dcache_assoc, dcache_line;
+    uint64_t tlb_entries;
+    uint64_t miss_penalty;
+    uint64_t tlb_penalty;
+    uint64_t sample;
+    uint64_t sample_window;
+    uint64_t cpu_hz;
+} config = {
+    .icache_size = 4096, .icache_assoc = 2, .icache_line = 32,
+    .dcache_size = 4096, .dcache_assoc = 4, .dcache_line = 32,
+    .tlb_entries = 0,
+    .miss_penalty = 10,
+    .tlb_penalty = 20,
+    .sample = 1,
+    .sample_window = 10000,
+    .cpu_hz = 80000000,
+};
+
+static VcpuState *vcpus;
+static unsigned int num_vcpus;
+static bool system_emulation;
+
+static inline bool in_sample(VcpuState *vcpu)
+{
+    return config.sample <= 1 || (vcpu->events++ / config.sample_window) % config.sample == 0;
+}
+
+// userdata packs the fetch line address with (instructions in line - 1);
+// instructions are at least 2 bytes, so the count always fits below the
+// line offset bits.
+static void vcpu_fetch(unsigned int vcpu_index, void *userdata)
+{
+    if (vcpu_index >= num_vcpus) {
+        return;
+    }
+
+    VcpuState *vcpu = &vcpus[vcpu_index];
+    uint64_t packed = (uintptr_t)userdata;
+    uint64_t count = (packed & (config.icache_line - 1)) + 1;
+    uint64_t addr = packed & ~(config.icache_line - 1);
+
+    vcpu->insns += count;
+    vcpu->fetches++;
+    if (!in_sample(vcpu)) {
+        return;
+    }
+
+    // Only the first instruction of a line can miss.
+    if (cache_sim_enabled(&vcpu->icache)) {
+        cache_sim_access(&vcpu->icache, addr);
+        vcpu->icache.hits += count - 1;
+    }
+    if (cache_sim_enabled(&vcpu->tlb)) {
+        cache_sim_access(&vcpu->tlb, addr);
+    }
+}
+
+static void vcpu_mem(unsigned int vcpu_index, qemu_plugin_meminfo_t info, uint64_t vaddr, void *userdata)
+{
+    if (vcpu_index >= num_vcpus) {
+        return;
+    }
+
+    VcpuState *vcpu = &vcpus[vcpu_index];
+
+    // Device memory is never cached.
+    if (system_emulation) {
+        struct qemu_plugin_hwaddr *hwaddr = qemu_plugin_get_hwaddr(info, vaddr);
+        if (hwaddr && qemu_plugin_hwaddr_is_io(hwaddr)) {
+            vcpu->io_accesses++;
+            return;
+        }
+    }
+
+    if (qemu_plugin_mem_is_store(info)) {
+        vcpu->stores++;
+    } else {
+        vcpu->loads++;
+    }
+    if (!in_sample(vcpu)) {
+        return;
+    }
+
+    if (cache_sim_enabled(&vcpu->dcache)) {
+        cache_sim_access(&vcpu->dcache, vaddr);
+    }
+    if (cache_sim_enabled(&vcpu->tlb)) {
+        cache_sim_access(&vcpu->tlb, vaddr);
+    }
+}
+
+// One fetch callback per I-cache line the block touches instead of one per
+// instruction, and a memory callback on every instruction.
+static void vcpu_tb_trans(qemu_plugin_id_t id, struct qemu_plugin_tb *tb)
+{
+    size_t n = qemu_plugin_tb_n_insns(tb);
+    struct qemu_plugin_insn *group_insn = NULL;
+    uint64_t group_line = 0;
+    uint64_t group_count = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        struct qemu_plugin_insn *insn = qemu_plugin_tb_get_insn(tb, i);
+        uint64_t line = qemu_plugin_insn_vaddr(insn) & ~(config.icache_line - 1);
+
+        if (group_count && line != group_line) {
+            qemu_plugin_register_vcpu_insn_exec_cb(group_insn, vcpu_fetch, QEMU_PLUGIN_CB_NO_REGS,
+                                                   (void *)(uintptr_t)(group_line | (group_count - 1)));
+            group_count = 0;
+        }
+        if (!group_count) {
+            group_insn = insn;
+            group_line = line;
+        }
+        group_count++;
+
+        qemu_plugin_register_vcpu_mem_cb(insn, vcpu_mem, QEMU_PLUGIN_CB_NO_REGS,
+                                         QEMU_PLUGIN_MEM_RW, NULL);
+    }
+
+    if (group_count) {
+        qemu_plugin_register_vcpu_insn_exec_cb(group_insn, vcpu_fetch, QEMU_PLUGIN_CB_NO_REGS,
+                                               (void *)(uintptr_t)(group_line | (group_count - 1)));
+    }
+}
+
+// Misses over all accesses, extrapolated from the sampled miss rate.
+static uint64_t estimated_misses(const CacheSim *cache, uint64_t accesses)
+{
+    uint64_t simulated = cache->hits + cache->misses;
+    if (!simulated) {
+        return 0;
+    }
+    return (uint64_t)((double)cache->misses / simulated * accesses);
+}
+
+static void report_cache(const char *name, const CacheSim *cache, uint64_t accesses)
+{
+    char line[256];
+    uint64_t simulated = cache->hits + cache->misses;
+
+    snprintf(line, sizeof(line),
+             "[CacheModel] %-6s %" PRIu64 " accesses, %" PRIu64 " simulated, %" PRIu64
+             " misses (%.2f%%), %" PRIu64 " evictions\n",
+             name, accesses, simulated, cache->misses,
+             simulated ? 100.0 * cache->misses / simulated : 0.0, cache->evictions);
+    qemu_plugin_outs(line);
+}
+
+static void plugin_exit(qemu_plugin_id_t id, void *userdata)
+{
+    CacheSim icache = {0}, dcache = {0}, tlb = {0};
+    uint64_t insns = 0, fetches = 0, data = 0, io = 0;
+    char line[256];
+
+    for (unsigned int i = 0; i < num_vcpus; i++) {
+        VcpuState *vcpu = &vcpus[i];
+        icache.hits += vcpu->icache.hits;
+        icache.misses += vcpu->icache.misses;
+        icache.evictions += vcpu->icache.evictions;
+        dcache.hits += vcpu->dcache.hits;
+        dcache.misses += vcpu->dcache.misses;
+        dcache.evictions += vcpu->dcache.evictions;
+        tlb.hits += vcpu->tlb.hits;
+        tlb.misses += vcpu->tlb.misses;
+        tlb.evictions += vcpu->tlb.evictions;
+        insns += vcpu->insns;
+        fetches += vcpu->fetches;
+        data += vcpu->loads + vcpu->stores;
+        io += vcpu->io_accesses;
+    }
+
+    uint64_t cycles = insns;
+    if (config.icache_size) {
+        report_cache("icache", &icache, insns);
+        cycles += estimated_misses(&icache, insns) * config.miss_penalty;
+    }
+    if (config.dcache_size) {
+        report_cache("dcache", &dcache, data);
+        cycles += estimated_misses(&dcache, data) * config.miss_penalty;
+    }
+    if (config.tlb_entries) {
+        report_cache("tlb", &tlb, fetches + data);
+        cycles += estimated_misses(&tlb, fetches + data) * config.tlb_penalty;
+    }
+
+    snprintf(line, sizeof(line),
+             "[CacheModel] %" PRIu64 " instructions, %" PRIu64 " data accesses, %" PRIu64
+             " device accesses\n",
+             insns, data, io);
+    qemu_plugin_outs(line);
+    snprintf(line, sizeof(line),
+             "[CacheModel] estimated %" PRIu64 " cycles (CPI %.2f), %.3f ms at %" PRIu64 " Hz\n",
+             cycles, insns ? (double)cycles / insns : 0.0,
+             1e3 * cycles / config.cpu_hz, config.cpu_hz);
+    qemu_plugin_outs(line);
+
+    for (unsigned int i = 0; i < num_vcpus; i++) {
+        cache_sim_free(&vcpus[i].icache);
+        cache_sim_free(&vcpus[i].dcache);
+        cache_sim_free(&vcpus[i].tlb);
+    }
+    free(vcpus);
+}
+
+static bool parse_args(int argc, char **argv)
+{
+    for (int i = 0; i < argc; i++) {
+        const char *arg = argv[i];
+        if (!cache_sim_parse_arg(arg, "icache_size", &config.icache_size) &&
+            !cache_sim_parse_arg(arg, "icache_assoc", &config.icache_assoc) &&
+            !cache_sim_parse_arg(arg, "icache_line", &config.icache_line) &&
+            !cache_sim_parse_arg(arg, "dcache_size", &config.dcache_size) &&
+            !cache_sim_parse_arg(arg, "dcache_assoc", &config.dcache_assoc) &&
+            !cache_sim_parse_arg(arg, "dcache_line", &config.dcache_line) &&
+            !cache_sim_parse_arg(arg, "tlb_entries", &config.tlb_entries) &&
+            !cache_sim_parse_arg(arg, "miss_penalty", &config.miss_penalty) &&
+            !cache_sim_parse_arg(arg, "tlb_penalty", &config.tlb_penalty) &&
+            !cache_sim_parse_arg(arg, "sample", &config.sample) &&
+            !cache_sim_parse_arg(arg, "sample_window", &config.sample_window) &&
+            !cache_sim_parse_arg(arg, "cpu_hz", &config.cpu_hz)) {
+            fprintf(stderr, "cache_model: unknown argument %s\n", arg);
+            return false;
+        }
+    }
+
+    // The fetch line also sets the fetch grouping, so it must stay valid
+    // with the I-cache disabled.
+    if (!cache_sim_is_pow2(config.icache_line) || config.icache_line < 4 ||
+        !config.sample_window || !config.cpu_hz) {
+        fprintf(stderr, "cache_model: invalid icache_line, sample_window or cpu_hz\n");
+        return false;
+    }
+    return true;
+}
+
+static bool init_vcpu(VcpuState *vcpu)
+{
+    if (config.icache_size &&
+        !cache_sim_init(&vcpu->icache, config.icache_size, config.icache_assoc, config.icache_line)) {
+        fprintf(stderr, "cache_model: invalid icache geometry\n");
+        return false;
+    }
+    if (config.dcache_size &&
+        !cache_sim_init(&vcpu->dcache, config.dcache_size, config.dcache_assoc, config.dcache_line)) {
+        fprintf(stderr, "cache_model: invalid dcache geometry\n");
+        return false;
+    }
+    // Fully associative.
+    if (config.tlb_entries &&
+        !cache_sim_init(&vcpu->tlb, config.tlb_entries * TLB_PAGE_SIZE, config.tlb_entries, TLB_PAGE_SIZE)) {
+        fprintf(stderr, "cache_model: invalid tlb_entries\n");
+        return false;
+    }
+    return true;
+}
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_install(qemu_plugin_id_t id, const qemu_info_t *info,
+                                           int argc, char **argv)
+{
+    if (!parse_args(argc, argv)) {
+        return -1;
+    }
+
+    system_emulation = info->system_emulation;
+    num_vcpus = system_emulation ? info->system.max_vcpus : MAX_USER_VCPUS;
+    vcpus = calloc(num_vcpus, sizeof(VcpuState));
+    if (!vcpus) {
+        return -1;
+    }
+    for (unsigned int i = 0; i < num_vcpus; i++) {
+        if (!init_vcpu(&vcpus[i])) {
+            return -1;
+        }
+    }
+
+    qemu_plugin_register_vcpu_tb_trans_cb(id, vcpu_tb_trans);
+    qemu_plugin_register_atexit_cb(id, plugin_exit, NULL);
+    return 0;
+}
@@ -0,0 +1,132 @@
+#ifndef CACHE_SIM_H
+#define CACHE_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Tag-only set-associative cache with LRU replacement, shared by the TCG
+// timing plugins. A TLB is the same structure with the page as the line.
+typedef struct {
+    uint64_t *lines;        // sets * ways line numbers, CACHE_SIM_EMPTY if unused
+    uint64_t *stamps;       // last-use tick per way, 0 if unused
+    uint32_t sets;
+    uint32_t ways;
+    uint32_t line_shift;
+    uint64_t tick;
+    uint64_t last_line;     // MRU line, hits without a set search
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} CacheSim;
+
+#define CACHE_SIM_EMPTY UINT64_MAX
+
+static inline bool cache_sim_is_pow2(uint64_t value)
+{
+    return value && !(value & (value - 1));
+}
+
+static inline void cache_sim_free(CacheSim *cache)
+{
+    free(cache->lines);
+    free(cache->stamps);
+    cache->lines = NULL;
+    cache->stamps = NULL;
+}
+
+// Returns false unless size / (ways * line) is a whole power of two.
+static inline bool cache_sim_init(CacheSim *cache, uint64_t size, uint32_t ways, uint32_t line)
+{
+    memset(cache, 0, sizeof(*cache));
+    if (!cache_sim_is_pow2(line) || ways == 0 || size % ((uint64_t)ways * line) != 0) {
+        return false;
+    }
+
+    uint64_t sets = size / ((uint64_t)ways * line);
+    if (!cache_sim_is_pow2(sets) || sets > UINT32_MAX) {
+        return false;
+    }
+
+    cache->sets = (uint32_t)sets;
+    cache->ways = ways;
+    cache->line_shift = __builtin_ctz(line);
+    cache->lines = malloc(sizeof(uint64_t) * sets * ways);
+    cache->stamps = calloc(sets * ways, sizeof(uint64_t));
+    if (!cache->lines || !cache->stamps) {
+        cache_sim_free(cache);
+        return false;
+    }
+
+    for (uint64_t i = 0; i < sets * ways; i++) {
+        cache->lines[i] = CACHE_SIM_EMPTY;
+    }
+    cache->last_line = CACHE_SIM_EMPTY;
+    return true;
+}
+
+static inline bool cache_sim_enabled(const CacheSim *cache)
+{
+    return cache->lines != NULL;
+}
+
+// Looks up addr, filling the line on a miss. Returns true on a hit.
+static inline bool cache_sim_access(CacheSim *cache, uint64_t addr)
+{
+    uint64_t line = addr >> cache->line_shift;
+    cache->tick++;
+
+    // The previous access made this line the newest in its set already.
+    if (line == cache->last_line) {
+        cache->hits++;
+        return true;
+    }
+    cache->last_line = line;
+
+    uint64_t base = (uint64_t)(line & (cache->sets - 1)) * cache->ways;
+    uint64_t *lines = cache->lines + base;
+    uint64_t *stamps = cache->stamps + base;
+    uint32_t victim = 0;
+
+    for (uint32_t way = 0; way < cache->ways; way++) {
+        if (lines[way] == line) {
+            stamps[way] = cache->tick;
+            cache->hits++;
+            return true;
+        }
+        if (stamps[way] < stamps[victim]) {
+            victim = way;
+        }
+    }
+
+    if (lines[victim] != CACHE_SIM_EMPTY) {
+        cache->evictions++;
+    }
+    lines[victim] = line;
+    stamps[victim] = cache->tick;
+    cache->misses++;
+    return false;
+}
+
+// Reads "key=value" with an optional k/K or m/M suffix. Returns false if
+// arg is for a different key.
+static inline bool cache_sim_parse_arg(const char *arg, const char *key, uint64_t *value)
+{
+    size_t key_len = strlen(key);
+    if (strncmp(arg, key, key_len) != 0 || arg[key_len] != '=') {
+        return false;
+    }
+
+    char *end;
+    uint64_t parsed = strtoull(arg + key_len + 1, &end, 0);
+    if (*end == 'k' || *end == 'K') {
+        parsed <<= 10;
+    } else if (*end == 'm' || *end == 'M') {
+        parsed <<= 20;
+    }
+    *value = parsed;
+    return true;
+}
+
+#endif
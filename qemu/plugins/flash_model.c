@@ -0,0 +1,311 @@
+// TCG plugin modelling the embedded flash behind FLASH_BASE: wait states,
+// the sequential prefetch buffer and an ART-style accelerator (a small
+// instruction cache plus a literal cache for constant loads), so a run
+// reports an execution time that reflects the image's layout.
+//
+//   -plugin libflash_model.so,cpu_hz=168000000,flash_hz=30000000,
+//           prefetch=on,art=on,art_lines=64,art_data_lines=8
+//
+// wait_states=N overrides the value derived from cpu_hz / flash_hz. Every
+// instruction is charged one cycle; flash stalls are added on top. With
+// art=off the flash interface still holds the last 16-byte line it read,
+// so refetching that line costs no wait states. The model follows vCPU 0
+// only, matching the single-core Cortex-M4 board.
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <qemu-plugin.h>
+
+#include "cache_sim.h"
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
+
+#define FLASH_LINE 16   // 128-bit flash read width
+#define HOT_LINES 10
+
+static struct {
+    uint64_t flash_base;
+    uint64_t flash_size;
+    uint64_t cpu_hz;
+    uint64_t flash_hz;
+    uint64_t wait_states;
+    bool wait_states_set;
+    bool prefetch;
+    bool art;
+    uint64_t art_lines;
+    uint64_t art_data_lines;
+} config = {
+    .flash_base = 0x08000000,
+    .flash_size = 256 * 1024,
+    .cpu_hz = 168000000,
+    .flash_hz = 30000000,
+    .prefetch = true,
+    .art = true,
+    .art_lines = 64,
+    .art_data_lines = 8,
+};
+
+static struct {
+    CacheSim art_insn;
+    CacheSim art_data;
+    uint64_t cycles;            // instructions plus stalls so far
+    uint64_t insns;
+    uint64_t prefetch_line;     // line being prefetched, CACHE_SIM_EMPTY if none
+    uint64_t prefetch_start;    // cycle the prefetch was issued
+    uint64_t last_line;         // line in vCPU 0's line buffer, CACHE_SIM_EMPTY if none
+    uint64_t fetch_stalls;
+    uint64_t data_stalls;
+    uint64_t line_fetches;
+    uint64_t art_hits;
+    uint64_t prefetch_hits;
+    uint64_t line_buffer_hits;
+    uint64_t data_reads;
+    uint32_t *line_stalls;      // stall cycles per flash line, for the hot list
+} flash;
+
+static inline bool in_flash(uint64_t addr)
+{
+    return addr - config.flash_base < config.flash_size;
+}
+
+static inline void add_stall(uint64_t addr, uint64_t stall)
+{
+    flash.cycles += stall;
+    flash.line_stalls[(addr - config.flash_base) / FLASH_LINE] += (uint32_t)stall;
+}
+
+// userdata packs the 16-byte fetch line with (instructions in line - 1).
+static void vcpu_fetch(unsigned int vcpu_index, void *userdata)
+{
+    if (vcpu_index != 0) {
+        return;
+    }
+
+    uint64_t packed = (uintptr_t)userdata;
+    uint64_t count = (packed & (FLASH_LINE - 1)) + 1;
+    uint64_t addr = packed & ~(uint64_t)(FLASH_LINE - 1);
+
+    flash.insns += count;
+    flash.cycles += count;
+    if (!in_flash(addr)) {
+        return;
+    }
+
+    uint64_t line = addr / FLASH_LINE;
+    uint64_t stall = config.wait_states;
+    bool same_line = line == flash.last_line;
+    flash.line_fetches++;
+    flash.last_line = line;
+
+    if (config.art && cache_sim_access(&flash.art_insn, addr)) {
+        stall = 0;
+        flash.art_hits++;
+    } else if (!config.art && same_line) {
+        // A loop or a TB boundary inside the line: no new flash read.
+        stall = 0;
+        flash.line_buffer_hits++;
+    } else if (config.prefetch && line == flash.prefetch_line) {
+        // The read was issued while the previous line executed.
+        uint64_t elapsed = flash.cycles - count - flash.prefetch_start;
+        stall = elapsed >= config.wait_states + 1 ? 0 : config.wait_states + 1 - elapsed;
+        flash.prefetch_hits++;
+    }
+
+    if (stall) {
+        add_stall(addr, stall);
+        flash.fetch_stalls += stall;
+    }
+
+    // The next line is requested as soon as this one starts executing;
+    // re-entering the line leaves that request in flight.
+    if (config.prefetch && !(same_line && flash.prefetch_line == line + 1)) {
+        flash.prefetch_line = line + 1;
+        flash.prefetch_start = flash.cycles - count;
+    }
+}
+
+// Constant loads (literal pools, lookup tables) read flash too.
+static void vcpu_mem(unsigned int vcpu_index, qemu_plugin_meminfo_t info, uint64_t vaddr, void *userdata)
+{
+    if (vcpu_index != 0 || !in_flash(vaddr) || qemu_plugin_mem_is_store(info)) {
+        return;
+    }
+
+    flash.data_reads++;
+    if (config.art && cache_sim_access(&flash.art_data, vaddr)) {
+        return;
+    }
+    add_stall(vaddr, config.wait_states);
+    flash.data_stalls += config.wait_states;
+
+    // A data read interrupts the sequential prefetch.
+    flash.prefetch_line = CACHE_SIM_EMPTY;
+}
+
+static void vcpu_tb_trans(qemu_plugin_id_t id, struct qemu_plugin_tb *tb)
+{
+    size_t n = qemu_plugin_tb_n_insns(tb);
+    struct qemu_plugin_insn *group_insn = NULL;
+    uint64_t group_line = 0;
+    uint64_t group_count = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        struct qemu_plugin_insn *insn = qemu_plugin_tb_get_insn(tb, i);
+        uint64_t line = qemu_plugin_insn_vaddr(insn) & ~(uint64_t)(FLASH_LINE - 1);
+
+        if (group_count && line != group_line) {
+            qemu_plugin_register_vcpu_insn_exec_cb(group_insn, vcpu_fetch, QEMU_PLUGIN_CB_NO_REGS,
+                                                   (void *)(uintptr_t)(group_line | (group_count - 1)));
+            group_count = 0;
+        }
+        if (!group_count) {
+            group_insn = insn;
+            group_line = line;
+        }
+        group_count++;
+
+        qemu_plugin_register_vcpu_mem_cb(insn, vcpu_mem, QEMU_PLUGIN_CB_NO_REGS,
+                                         QEMU_PLUGIN_MEM_R, NULL);
+    }
+
+    if (group_count) {
+        qemu_plugin_register_vcpu_insn_exec_cb(group_insn, vcpu_fetch, QEMU_PLUGIN_CB_NO_REGS,
+                                               (void *)(uintptr_t)(group_line | (group_count - 1)));
+    }
+}
+
+// Flash lines with the most stall cycles; a layout change that moves hot
+// code out of them shows up directly here.
+static void report_hot_lines(void)
+{
+    uint64_t lines = config.flash_size / FLASH_LINE;
+    uint64_t hot[HOT_LINES];
+    unsigned int num_hot = 0;
+    char line[128];
+
+    for (uint64_t i = 0; i < lines; i++) {
+        if (!flash.line_stalls[i]) {
+            continue;
+        }
+        unsigned int pos = num_hot < HOT_LINES ? num_hot++ : HOT_LINES;
+        while (pos > 0 && flash.line_stalls[hot[pos - 1]] < flash.line_stalls[i]) {
+            if (pos < HOT_LINES) {
+                hot[pos] = hot[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < HOT_LINES) {
+            hot[pos] = i;
+        }
+    }
+
+    for (unsigned int i = 0; i < num_hot; i++) {
+        snprintf(line, sizeof(line), "[FlashModel]   0x%08" PRIx64 "  %" PRIu32 " stall cycles\n",
+                 config.flash_base + hot[i] * FLASH_LINE, flash.line_stalls[hot[i]]);
+        qemu_plugin_outs(line);
+    }
+}
+
+static void plugin_exit(qemu_plugin_id_t id, void *userdata)
+{
+    char line[256];
+
+    snprintf(line, sizeof(line),
+             "[FlashModel] %" PRIu64 " wait states, prefetch %s, ART %s\n",
+             config.wait_states, config.prefetch ? "on" : "off", config.art ? "on" : "off");
+    qemu_plugin_outs(line);
+    snprintf(line, sizeof(line),
+             "[FlashModel] %" PRIu64 " line fetches: %" PRIu64 " %s hits, %" PRIu64
+             " prefetch hits, %" PRIu64 " stall cycles\n",
+             flash.line_fetches, config.art ? flash.art_hits : flash.line_buffer_hits,
+             config.art ? "ART" : "line buffer", flash.prefetch_hits, flash.fetch_stalls);
+    qemu_plugin_outs(line);
+    snprintf(line, sizeof(line),
+             "[FlashModel] %" PRIu64 " constant reads, %" PRIu64 " stall cycles\n",
+             flash.data_reads, flash.data_stalls);
+    qemu_plugin_outs(line);
+    snprintf(line, sizeof(line),
+             "[FlashModel] %" PRIu64 " instructions, %" PRIu64 " cycles (CPI %.2f), %.3f ms at %" PRIu64
+             " Hz\n",
+             flash.insns, flash.cycles, flash.insns ? (double)flash.cycles / flash.insns : 0.0,
+             1e3 * flash.cycles / config.cpu_hz, config.cpu_hz);
+    qemu_plugin_outs(line);
+    report_hot_lines();
+
+    cache_sim_free(&flash.art_insn);
+    cache_sim_free(&flash.art_data);
+    free(flash.line_stalls);
+}
+
+static bool parse_bool(const char *arg, const char *key, bool *value, bool *ok)
+{
+    size_t key_len = strlen(key);
+    if (strncmp(arg, key, key_len) != 0 || arg[key_len] != '=') {
+        return false;
+    }
+    *ok = qemu_plugin_bool_parse(key, arg + key_len + 1, value);
+    return true;
+}
+
+static bool parse_args(int argc, char **argv)
+{
+    for (int i = 0; i < argc; i++) {
+        const char *arg = argv[i];
+        bool ok = true;
+
+        if (cache_sim_parse_arg(arg, "wait_states", &config.wait_states)) {
+            config.wait_states_set = true;
+        } else if (!cache_sim_parse_arg(arg, "flash_base", &config.flash_base) &&
+                   !cache_sim_parse_arg(arg, "flash_size", &config.flash_size) &&
+                   !cache_sim_parse_arg(arg, "cpu_hz", &config.cpu_hz) &&
+                   !cache_sim_parse_arg(arg, "flash_hz", &config.flash_hz) &&
+                   !cache_sim_parse_arg(arg, "art_lines", &config.art_lines) &&
+                   !cache_sim_parse_arg(arg, "art_data_lines", &config.art_data_lines) &&
+                   !parse_bool(arg, "prefetch", &config.prefetch, &ok) &&
+                   !parse_bool(arg, "art", &config.art, &ok)) {
+            ok = false;
+        }
+
+        if (!ok) {
+            fprintf(stderr, "flash_model: invalid argument %s\n", arg);
+            return false;
+        }
+    }
+
+    if (!config.cpu_hz || !config.flash_hz || !config.flash_size) {
+        fprintf(stderr, "flash_model: cpu_hz, flash_hz and flash_size must be non-zero\n");
+        return false;
+    }
+    if (!config.wait_states_set) {
+        config.wait_states = (config.cpu_hz - 1) / config.flash_hz;
+    }
+    return true;
+}
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_install(qemu_plugin_id_t id, const qemu_info_t *info,
+                                           int argc, char **argv)
+{
+    if (!parse_args(argc, argv)) {
+        return -1;
+    }
+
+    // Both ART caches are fully associative.
+    if (config.art &&
+        (!cache_sim_init(&flash.art_insn, config.art_lines * FLASH_LINE, config.art_lines, FLASH_LINE) ||
+         !cache_sim_init(&flash.art_data, config.art_data_lines * FLASH_LINE, config.art_data_lines,
+                         FLASH_LINE))) {
+        fprintf(stderr, "flash_model: art_lines and art_data_lines must be non-zero\n");
+        return -1;
+    }
+
+    flash.line_stalls = calloc(config.flash_size / FLASH_LINE + 1, sizeof(uint32_t));
+    if (!flash.line_stalls) {
+        return -1;
+    }
+    flash.prefetch_line = CACHE_SIM_EMPTY;
+    flash.last_line = CACHE_SIM_EMPTY;
+
+    qemu_plugin_register_vcpu_tb_trans_cb(id, vcpu_tb_trans);
+    qemu_plugin_register_atexit_cb(id, plugin_exit, NULL);
+    return 0;
+}
@@ -0,0 +1,524 @@
+// TCG plugin: PC-sampling profiler for the firmware.
+//
+//   -plugin libprofiler.so,elf=bazel-bin/firmware/firmware,interval=10000,
+//           out=firmware.folded
+//
+// Every `interval` executed instructions the vCPU's current block and
+// shadow call stack are sampled. The shadow stack is built from calls
+// decoded at translation time (Thumb BL/BLX, RISC-V JAL/JALR to ra) and
+// unwound when execution reaches a pending return address, so it needs no
+// frame pointers. Samples are symbolised against the ELF symbol table and
+// written as folded stacks ("caller;callee count"), the input format of
+// flamegraph.pl and speedscope. A flat profile is printed at exit.
+//
+// Interrupt handlers are not calls, so their samples appear on top of the
+// stack they interrupted.
+
+#include <elf.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <qemu-plugin.h>
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
+
+#define MAX_DEPTH 64
+#define MAX_USER_VCPUS 64
+#define UNWIND_SEARCH 4     // stack levels searched for a return target
+#define FLAT_TOP 15
+
+typedef struct {
+    uint32_t addr;
+    uint32_t size;
+    char *name;
+} Symbol;
+
+typedef struct {
+    uint64_t remaining;             // instructions until the next sample
+    uint32_t returns[MAX_DEPTH];    // pending return addresses, innermost last
+    uint32_t depth;
+    uint32_t overflow;              // calls deeper than MAX_DEPTH, not tracked; samples
+                                    // taken meanwhile have truncated stacks
+} VcpuState;
+
+// One distinct stack, as symbol indices from the outermost caller.
+typedef struct {
+    uint32_t *frames;
+    uint32_t depth;
+    uint64_t count;
+} Stack;
+
+static struct {
+    const char *elf;
+    const char *out;
+    uint64_t interval;
+} config = {
+    .elf = NULL,
+    .out = "firmware.folded",
+    .interval = 10000,
+};
+
+static Symbol *symbols;
+static uint32_t num_symbols;        // index num_symbols means unknown
+
+static VcpuState *vcpus;
+static unsigned int num_vcpus;
+static bool riscv;
+
+static pthread_mutex_t stacks_lock = PTHREAD_MUTEX_INITIALIZER;
+static Stack *stacks;               // open addressing, capacity a power of two
+static uint64_t stacks_capacity;
+static uint64_t stacks_used;
+static uint64_t total_samples;
+static uint64_t truncated_samples;  // taken deeper than MAX_DEPTH
+
+// ---------------------------------------------------------------------------
+// Symbols
+
+// Legacy Rust mangling: _ZN<len><ident>...17h<hash>E -> ident::ident.
+static char *demangle(const char *name)
+{
+    static const struct { const char *from; const char *to; } escapes[] = {
+        {"$LT$", "<"}, {"$GT$", ">"}, {"$RF$", "&"}, {"$BP$", "*"}, {"$C$", ","},
+        {"$u20$", " "}, {"$u27$", "'"}, {"$u5b$", "["}, {"$u5d$", "]"},
+        {"$u7b$", "{"}, {"$u7d$", "}"}, {"$u7e$", "~"}, {"..", "::"},
+    };
+
+    if (strncmp(name, "_ZN", 3) != 0) {
+        return strdup(name);
+    }
+
+    // "::" replaces each length prefix, so one-letter components grow the
+    // name by up to half; escapes only shrink it.
+    size_t cap = 2 * strlen(name) + 1;
+    char *out = malloc(cap);
+    size_t len = 0;
+    const char *p = name + 3;
+
+    out[0] = '\0';
+    while (*p >= '0' && *p <= '9') {
+        char *end;
+        unsigned long n = strtoul(p, &end, 10);
+        p = end;
+        if (strlen(p) < n) {
+            break;
+        }
+        // Drop the trailing hash component.
+        if (n == 17 && p[0] == 'h' && p[n] == 'E') {
+            break;
+        }
+        if (len) {
+            len += snprintf(out + len, cap - len, "::");
+            // snprintf returns the untruncated length; stay inside out.
+            len = len < cap ? len : cap - 1;
+        }
+        for (unsigned long i = 0; i < n && len + 1 < cap;) {
+            bool escaped = false;
+            for (size_t e = 0; e < sizeof(escapes) / sizeof(escapes[0]); e++) {
+                size_t from_len = strlen(escapes[e].from);
+                if (from_len <= n - i && strncmp(p + i, escapes[e].from, from_len) == 0) {
+                    len += snprintf(out + len, cap - len, "%s", escapes[e].to);
+                    len = len < cap ? len : cap - 1;
+                    i += from_len;
+                    escaped = true;
+                    break;
+                }
+            }
+            if (!escaped) {
+                out[len++] = p[i++];
+                out[len] = '\0';
+            }
+        }
+        p += n;
+    }
+    return out;
+}
+
+static int compare_symbols(const void *a, const void *b)
+{
+    const Symbol *x = a;
+    const Symbol *y = b;
+    return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+// Loads STT_FUNC symbols from a little-endian ELF32 image.
+static bool load_symbols(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "profiler: cannot open %s\n", path);
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char *image = malloc(file_size);
+    bool read_ok = image && fread(image, 1, file_size, file) == (size_t)file_size;
+    fclose(file);
+
+    const Elf32_Ehdr *ehdr = (const Elf32_Ehdr *)image;
+    if (!read_ok || file_size < (long)sizeof(*ehdr) || memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 ||
+        ehdr->e_ident[EI_CLASS] != ELFCLASS32 || ehdr->e_ident[EI_DATA] != ELFDATA2LSB ||
+        ehdr->e_shoff + (uint64_t)ehdr->e_shnum * sizeof(Elf32_Shdr) > (uint64_t)file_size) {
+        fprintf(stderr, "profiler: %s is not a little-endian ELF32 file\n", path);
+        free(image);
+        return false;
+    }
+
+    const Elf32_Shdr *sections = (const Elf32_Shdr *)(image + ehdr->e_shoff);
+    for (unsigned int s = 0; s < ehdr->e_shnum; s++) {
+        const Elf32_Shdr *symtab = &sections[s];
+        if (symtab->sh_type != SHT_SYMTAB || symtab->sh_link >= ehdr->e_shnum) {
+            continue;
+        }
+        const Elf32_Shdr *strtab = &sections[symtab->sh_link];
+        if (symtab->sh_offset + (uint64_t)symtab->sh_size > (uint64_t)file_size ||
+            strtab->sh_offset + (uint64_t)strtab->sh_size > (uint64_t)file_size) {
+            break;
+        }
+
+        const Elf32_Sym *syms = (const Elf32_Sym *)(image + symtab->sh_offset);
+        const char *names = (const char *)(image + strtab->sh_offset);
+        uint32_t count = symtab->sh_size / sizeof(Elf32_Sym);
+
+        symbols = calloc(count, sizeof(Symbol));
+        for (uint32_t i = 0; i < count; i++) {
+            if (ELF32_ST_TYPE(syms[i].st_info) != STT_FUNC || syms[i].st_name >= strtab->sh_size) {
+                continue;
+            }
+            // Bit 0 marks Thumb code, not part of the address.
+            symbols[num_symbols].addr = syms[i].st_value & ~1u;
+            symbols[num_symbols].size = syms[i].st_size;
+            symbols[num_symbols].name = demangle(names + syms[i].st_name);
+            num_symbols++;
+        }
+        break;
+    }
+    free(image);
+
+    if (!num_symbols) {
+        fprintf(stderr, "profiler: no function symbols in %s\n", path);
+        return false;
+    }
+    qsort(symbols, num_symbols, sizeof(Symbol), compare_symbols);
+    return true;
+}
+
+static uint32_t lookup_symbol(uint32_t addr)
+{
+    uint32_t lo = 0;
+    uint32_t hi = num_symbols;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (symbols[mid].addr <= addr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) {
+        return num_symbols;
+    }
+
+    const Symbol *sym = &symbols[lo - 1];
+    return (sym->size == 0 || addr - sym->addr < sym->size) ? lo - 1 : num_symbols;
+}
+
+static const char *symbol_name(uint32_t index)
+{
+    return index < num_symbols ? symbols[index].name : "[unknown]";
+}
+
+// ---------------------------------------------------------------------------
+// Stack aggregation
+
+static uint64_t hash_frames(const uint32_t *frames, uint32_t depth)
+{
+    uint64_t hash = 1469598103934665603ull;
+    for (uint32_t i = 0; i < depth; i++) {
+        hash = (hash ^ frames[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static Stack *find_stack(Stack *table, uint64_t capacity, const uint32_t *frames, uint32_t depth)
+{
+    uint64_t slot = hash_frames(frames, depth) & (capacity - 1);
+    while (table[slot].frames &&
+           (table[slot].depth != depth ||
+            memcmp(table[slot].frames, frames, depth * sizeof(uint32_t)) != 0)) {
+        slot = (slot + 1) & (capacity - 1);
+    }
+    return &table[slot];
+}
+
+static void grow_stacks(void)
+{
+    uint64_t capacity = stacks_capacity ? stacks_capacity * 2 : 1024;
+    Stack *table = calloc(capacity, sizeof(Stack));
+
+    for (uint64_t i = 0; i < stacks_capacity; i++) {
+        if (stacks[i].frames) {
+            *find_stack(table, capacity, stacks[i].frames, stacks[i].depth) = stacks[i];
+        }
+    }
+    free(stacks);
+    stacks = table;
+    stacks_capacity = capacity;
+}
+
+static void record_sample(VcpuState *vcpu, uint32_t pc)
+{
+    uint32_t frames[MAX_DEPTH + 1];
+    uint32_t depth = 0;
+
+    // A return address lies just past the call, inside the caller.
+    for (uint32_t i = 0; i < vcpu->depth; i++) {
+        frames[depth++] = lookup_symbol(vcpu->returns[i] - 1);
+    }
+    frames[depth++] = lookup_symbol(pc);
+
+    pthread_mutex_lock(&stacks_lock);
+    if ((stacks_used + 1) * 2 > stacks_capacity) {
+        grow_stacks();
+    }
+    Stack *stack = find_stack(stacks, stacks_capacity, frames, depth);
+    if (!stack->frames) {
+        stack->frames = malloc(depth * sizeof(uint32_t));
+        memcpy(stack->frames, frames, depth * sizeof(uint32_t));
+        stack->depth = depth;
+        stacks_used++;
+    }
+    stack->count++;
+    total_samples++;
+    if (vcpu->overflow) {
+        truncated_samples++;
+    }
+    pthread_mutex_unlock(&stacks_lock);
+}
+
+// ---------------------------------------------------------------------------
+// Execution callbacks
+
+// userdata is the block's start address; the instruction count is packed
+// above bit 32 (QEMU plugins are only built for 64-bit hosts).
+static void vcpu_tb_exec(unsigned int vcpu_index, void *userdata)
+{
+    if (vcpu_index >= num_vcpus) {
+        return;
+    }
+
+    VcpuState *vcpu = &vcpus[vcpu_index];
+    uint64_t packed = (uintptr_t)userdata;
+    uint32_t pc = (uint32_t)packed;
+    uint64_t insns = packed >> 32;
+
+    // Returning to a pending return address pops to that frame. Deeper
+    // levels are searched too, to recover from frames left by tail calls.
+    for (uint32_t level = 0; level < UNWIND_SEARCH && level < vcpu->depth; level++) {
+        if (vcpu->returns[vcpu->depth - 1 - level] == pc) {
+            vcpu->depth -= level + 1;
+            vcpu->overflow = 0;
+            break;
+        }
+    }
+
+    if (insns >= vcpu->remaining) {
+        record_sample(vcpu, pc);
+        vcpu->remaining = config.interval;
+    } else {
+        vcpu->remaining -= insns;
+    }
+}
+
+static void vcpu_call(unsigned int vcpu_index, void *userdata)
+{
+    if (vcpu_index >= num_vcpus) {
+        return;
+    }
+
+    VcpuState *vcpu = &vcpus[vcpu_index];
+    if (vcpu->depth < MAX_DEPTH) {
+        vcpu->returns[vcpu->depth++] = (uint32_t)(uintptr_t)userdata;
+    } else {
+        vcpu->overflow++;
+    }
+}
+
+static uint16_t read_u16(const unsigned char *bytes)
+{
+    return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+// Thumb BL, BLX <label> and BLX <Rm>.
+static bool is_thumb_call(const unsigned char *bytes, size_t size)
+{
+    uint16_t first = read_u16(bytes);
+    if (size == 2) {
+        return (first & 0xFF87) == 0x4780;
+    }
+    uint16_t second = read_u16(bytes + 2);
+    return (first & 0xF800) == 0xF000 && (second & 0xC000) == 0xC000;
+}
+
+// JAL/JALR and C.JAL/C.JALR with ra as the link register.
+static bool is_riscv_call(const unsigned char *bytes, size_t size)
+{
+    if (size == 2) {
+        uint16_t insn = read_u16(bytes);
+        bool c_jal = (insn & 0xE003) == 0x2001;
+        bool c_jalr = (insn & 0xF07F) == 0x9002 && (insn & 0x0F80) != 0;
+        return c_jal || c_jalr;
+    }
+    uint32_t insn = read_u16(bytes) | ((uint32_t)read_u16(bytes + 2) << 16);
+    uint32_t opcode = insn & 0x7F;
+    uint32_t rd = (insn >> 7) & 0x1F;
+    return (opcode == 0x6F || opcode == 0x67) && rd == 1;
+}
+
+static void vcpu_tb_trans(qemu_plugin_id_t id, struct qemu_plugin_tb *tb)
+{
+    size_t n = qemu_plugin_tb_n_insns(tb);
+    uint64_t pc = qemu_plugin_tb_vaddr(tb);
+
+    qemu_plugin_register_vcpu_tb_exec_cb(tb, vcpu_tb_exec, QEMU_PLUGIN_CB_NO_REGS,
+                                         (void *)(uintptr_t)(((uint64_t)n << 32) | (uint32_t)pc));
+
+    // Calls end a block, but checking every instruction costs nothing at
+    // run time.
+    for (size_t i = 0; i < n; i++) {
+        struct qemu_plugin_insn *insn = qemu_plugin_tb_get_insn(tb, i);
+        unsigned char bytes[4];
+        size_t size = qemu_plugin_insn_size(insn);
+
+        if ((size != 2 && size != 4) || qemu_plugin_insn_data(insn, bytes, size) != size) {
+            continue;
+        }
+        if (riscv ? is_riscv_call(bytes, size) : is_thumb_call(bytes, size)) {
+            uint64_t ret = qemu_plugin_insn_vaddr(insn) + size;
+            qemu_plugin_register_vcpu_insn_exec_cb(insn, vcpu_call, QEMU_PLUGIN_CB_NO_REGS,
+                                                   (void *)(uintptr_t)ret);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Output
+
+static void write_folded(void)
+{
+    FILE *out = fopen(config.out, "w");
+    if (!out) {
+        fprintf(stderr, "profiler: cannot write %s\n", config.out);
+        return;
+    }
+
+    for (uint64_t i = 0; i < stacks_capacity; i++) {
+        const Stack *stack = &stacks[i];
+        if (!stack->frames) {
+            continue;
+        }
+        for (uint32_t f = 0; f < stack->depth; f++) {
+            fprintf(out, "%s%s", f ? ";" : "", symbol_name(stack->frames[f]));
+        }
+        fprintf(out, " %" PRIu64 "\n", stack->count);
+    }
+    fclose(out);
+}
+
+// Self samples per function, i.e. the leaf frame of each stack.
+static void report_flat(void)
+{
+    uint64_t *self = calloc(num_symbols + 1, sizeof(uint64_t));
+    char line[256];
+
+    for (uint64_t i = 0; i < stacks_capacity; i++) {
+        if (stacks[i].frames) {
+            self[stacks[i].frames[stacks[i].depth - 1]] += stacks[i].count;
+        }
+    }
+
+    snprintf(line, sizeof(line), "[Profiler] %" PRIu64 " samples every %" PRIu64
+             " instructions, %" PRIu64 " distinct stacks -> %s\n",
+             total_samples, config.interval, stacks_used, config.out);
+    qemu_plugin_outs(line);
+    if (truncated_samples) {
+        snprintf(line, sizeof(line),
+                 "[Profiler] %" PRIu64 " samples deeper than %d calls miss their innermost callers\n",
+                 truncated_samples, MAX_DEPTH);
+        qemu_plugin_outs(line);
+    }
+
+    for (unsigned int rank = 0; rank < FLAT_TOP; rank++) {
+        uint32_t best = 0;
+        for (uint32_t s = 1; s <= num_symbols; s++) {
+            if (self[s] > self[best]) {
+                best = s;
+            }
+        }
+        if (!self[best]) {
+            break;
+        }
+        snprintf(line, sizeof(line), "[Profiler] %6.2f%%  %s\n",
+                 100.0 * self[best] / total_samples, symbol_name(best));
+        qemu_plugin_outs(line);
+        self[best] = 0;
+    }
+    free(self);
+}
+
+static void plugin_exit(qemu_plugin_id_t id, void *userdata)
+{
+    write_folded();
+    report_flat();
+}
+
+static bool parse_args(int argc, char **argv)
+{
+    for (int i = 0; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strncmp(arg, "elf=", 4) == 0) {
+            config.elf = arg + 4;
+        } else if (strncmp(arg, "out=", 4) == 0) {
+            config.out = arg + 4;
+        } else if (strncmp(arg, "interval=", 9) == 0) {
+            config.interval = strtoull(arg + 9, NULL, 0);
+        } else {
+            fprintf(stderr, "profiler: unknown argument %s\n", arg);
+            return false;
+        }
+    }
+
+    if (!config.elf || !config.interval) {
+        fprintf(stderr, "profiler: elf=<firmware> and a non-zero interval are required\n");
+        return false;
+    }
+    return true;
+}
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_install(qemu_plugin_id_t id, const qemu_info_t *info,
+                                           int argc, char **argv)
+{
+    if (!parse_args(argc, argv) || !load_symbols(config.elf)) {
+        return -1;
+    }
+
+    riscv = strncmp(info->target_name, "riscv", 5) == 0;
+    num_vcpus = info->system_emulation ? info->system.max_vcpus : MAX_USER_VCPUS;
+    vcpus = calloc(num_vcpus, sizeof(VcpuState));
+    if (!vcpus) {
+        return -1;
+    }
+    for (unsigned int i = 0; i < num_vcpus; i++) {
+        vcpus[i].remaining = config.interval;
+    }
+    grow_stacks();
+
+    qemu_plugin_register_vcpu_tb_trans_cb(id, vcpu_tb_trans);
+    qemu_plugin_register_atexit_cb(id, plugin_exit, NULL);
+    return 0;
+}
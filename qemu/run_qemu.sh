@@ -3,6 +3,16 @@
 FIRMWARE_BIN="${1:-bazel-bin/firmware/firmware}"
 QEMU_SYSTEM_ARM="${QEMU_SYSTEM_ARM:-qemu-system-arm}"
 
+# Space-separated TCG plugins, each "path[,arg=value...]", e.g.
+#   QEMU_PLUGINS="bazel-bin/qemu/libcache_model.so,icache_size=8k,sample=10"
+PLUGIN_ARGS=()
+for plugin in $QEMU_PLUGINS; do
+    PLUGIN_ARGS+=(-plugin "$plugin")
+done
+if [ ${#PLUGIN_ARGS[@]} -gt 0 ]; then
+    PLUGIN_ARGS+=(-d plugin)
+fi
+
 if [ ! -f "$FIRMWARE_BIN" ]; then
     echo "Error: Firmware binary not found at $FIRMWARE_BIN"
     echo "Please build the firmware first with: bazel build //firmware:firmware"
@@ -11,6 +21,9 @@ fi
 
 echo "Starting QEMU simulation..."
 echo "Firmware: $FIRMWARE_BIN"
+if [ -n "$QEMU_PLUGINS" ]; then
+    echo "Plugins: $QEMU_PLUGINS"
+fi
 echo "Press Ctrl+A, X to exit"
 
 $QEMU_SYSTEM_ARM \
@@ -19,5 +32,6 @@ $QEMU_SYSTEM_ARM \
     -nographic \
     -semihosting-config enable=on,target=native \
     -kernel "$FIRMWARE_BIN" \
+    "${PLUGIN_ARGS[@]}" \
     -monitor telnet:127.0.0.1:1234,server,nowait \
     -gdb tcp::3333
\ No newline at end of file
@@ -0,0 +1,50 @@
+// In-memory compute cell instantiated by cell_array.v.jinja2.
+//
+// The cell stores one DATA_WIDTH-bit weight. Its word line (enable) is the
+// row's binary input, so an enabled cell contributes its weight to the
+// column sum: sign extended for MAC and ADD, zero extended for SHIFT and
+// XOR. cim::VerilatedArray (rtl/memory/engine/verilated_array.h) builds
+// multi-bit MAC and SHIFT out of this, one input bit plane per compute.
+// A disabled or power-gated cell contributes 0.
+
+module imc_cell #(
+    parameter DATA_WIDTH = 8,
+    parameter COMPUTE_WIDTH = 16,
+    parameter ROW_ADDR = 0,
+    parameter COL_ADDR = 0,
+    parameter CELL_TYPE = "SRAM"  // SRAM, RRAM, PCM, MRAM
+)(
+    input wire clk,
+    input wire rst_n,
+    input wire enable,
+
+    // Writes land on the rising edge while the cell is enabled
+    input wire write_enable,
+    input wire [DATA_WIDTH-1:0] write_data,
+
+    input wire compute_enable,
+    input wire [1:0] compute_mode,  // 00: MAC, 01: ADD, 10: SHIFT, 11: XOR
+    output wire [COMPUTE_WIDTH-1:0] result,
+
+    input wire power_gate
+);
+
+    reg [DATA_WIDTH-1:0] weight;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            weight <= {DATA_WIDTH{1'b0}};
+        end else if (enable && write_enable && !power_gate) begin
+            weight <= write_data;
+        end
+    end
+
+    // Width conversion by assignment, so COMPUTE_WIDTH may be narrower
+    wire signed [COMPUTE_WIDTH-1:0] sign_extended = $signed(weight);
+    wire [COMPUTE_WIDTH-1:0] zero_extended = weight;
+    wire is_signed = (compute_mode == 2'b00) || (compute_mode == 2'b01);
+
+    assign result = !(enable && !power_gate) ? {COMPUTE_WIDTH{1'b0}} :
+                    is_signed ? sign_extended : zero_extended;
+
+endmodule
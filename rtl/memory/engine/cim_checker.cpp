@@ -0,0 +1,276 @@
+#include "rtl/memory/engine/cim_checker.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace cim {
+
+namespace {
+
+void write_hex(std::ostream& out, const uint8_t* data, size_t size) {
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < size; i++) {
+        out << digits[data[i] >> 4] << digits[data[i] & 0xF];
+    }
+}
+
+bool read_hex(const std::string& text, uint8_t* data, size_t size) {
+    if (text.size() != size * 2) {
+        return false;
+    }
+    for (size_t i = 0; i < size; i++) {
+        unsigned int value;
+        if (std::sscanf(text.c_str() + i * 2, "%2x", &value) != 1) {
+            return false;
+        }
+        data[i] = static_cast<uint8_t>(value);
+    }
+    return true;
+}
+
+bool same_state(const Engine& a, const Engine& b) {
+    return a.rows() == b.rows() && a.cols() == b.cols() &&
+           a.precision().data_width == b.precision().data_width &&
+           a.precision().compute_width == b.precision().compute_width &&
+           std::memcmp(a.weights(), b.weights(), a.weight_bytes()) == 0 &&
+           std::memcmp(a.row_enable(), b.row_enable(), a.row_enable_bytes()) == 0 &&
+           std::memcmp(a.col_enable(), b.col_enable(), a.col_enable_bytes()) == 0;
+}
+
+} // namespace
+
+SampledChecker::SampledChecker(RtlArray& rtl, CheckerConfig config)
+    : rtl(rtl), config(config), rng(config.seed), observed(0), busy(false), stopping(false), dumps(0),
+      worker(&SampledChecker::run, this) {}
+
+SampledChecker::~SampledChecker() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    work_ready.notify_one();
+    worker.join();
+}
+
+bool SampledChecker::sample_next() {
+    if (config.every && observed % config.every == 0) {
+        return true;
+    }
+    if (config.probability > 0.0) {
+        return std::uniform_real_distribution<double>(0.0, 1.0)(rng) < config.probability;
+    }
+    return false;
+}
+
+// Samples share one copy of the array state until it changes. Comparing
+// costs a pass over the weights, but only on sampled computes. The copy
+// holds what the RTL is loaded from, not the engine's planes, cache or
+// memo.
+std::shared_ptr<const Engine> SampledChecker::snapshot(const Engine& engine) {
+    if (!last_state || !same_state(*last_state, engine)) {
+        auto state = std::make_shared<Engine>(engine.rows(), engine.cols(), engine.precision());
+        std::memcpy(state->weights(), engine.weights(), engine.weight_bytes());
+        std::memcpy(state->row_enable(), engine.row_enable(), engine.row_enable_bytes());
+        std::memcpy(state->col_enable(), engine.col_enable(), engine.col_enable_bytes());
+        last_state = std::move(state);
+    }
+    return last_state;
+}
+
+void SampledChecker::observe(const Engine& engine, Mode mode, const uint8_t* input, const int32_t* output) {
+    uint64_t op = observed;
+    bool sampled = sample_next();
+    observed++;
+    if (!sampled) {
+        return;
+    }
+
+    // Only this thread adds to the queue, so a slot seen free here stays
+    // free until the push below; a full queue costs no snapshot.
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        counters.sampled++;
+        if (queue.size() >= config.queue_depth) {
+            counters.dropped++;
+            return;
+        }
+    }
+
+    Sample sample;
+    sample.op = op;
+    sample.mode = mode;
+    sample.state = snapshot(engine);
+    sample.input.assign(input, input + engine.rows());
+    sample.expected.assign(output, output + engine.cols());
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        queue.push_back(std::move(sample));
+    }
+    work_ready.notify_one();
+}
+
+void SampledChecker::flush() {
+    std::unique_lock<std::mutex> guard(lock);
+    idle.wait(guard, [this] { return queue.empty() && !busy; });
+}
+
+CheckerStats SampledChecker::stats() const {
+    std::lock_guard<std::mutex> guard(lock);
+    CheckerStats result = counters;
+    result.observed = observed;
+    return result;
+}
+
+void SampledChecker::run() {
+    std::shared_ptr<const Engine> loaded;
+    std::vector<int32_t> actual;
+
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        work_ready.wait(guard, [this] { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            break;
+        }
+        Sample sample = std::move(queue.front());
+        queue.pop_front();
+        busy = true;
+        guard.unlock();
+
+        if (loaded != sample.state) {
+            rtl.load(*sample.state);
+            loaded = sample.state;
+        }
+        actual.resize(sample.expected.size());
+        bool supported = rtl.gemv(sample.mode, sample.input.data(), actual.data());
+        bool mismatch = supported && actual != sample.expected;
+        if (mismatch) {
+            report(sample, actual);
+        }
+
+        guard.lock();
+        busy = false;
+        if (supported) {
+            counters.checked++;
+        } else {
+            counters.unsupported++;
+        }
+        if (mismatch) {
+            counters.mismatches++;
+        }
+        if (queue.empty()) {
+            idle.notify_all();
+        }
+    }
+}
+
+void SampledChecker::report(const Sample& sample, const std::vector<int32_t>& actual) {
+    const Engine& state = *sample.state;
+    size_t first = 0;
+    size_t differing = 0;
+    for (size_t c = actual.size(); c-- > 0;) {
+        if (actual[c] != sample.expected[c]) {
+            first = c;
+            differing++;
+        }
+    }
+
+    std::ostringstream message;
+    message << "[Checker] op " << sample.op << " mode " << static_cast<int>(sample.mode) << ": "
+            << differing << " of " << actual.size() << " columns differ, first " << first
+            << " (model " << sample.expected[first] << ", rtl " << actual[first] << ")";
+
+    // Only the worker writes files, so `dumps` needs no lock.
+    if (dumps < config.max_dumps) {
+        dumps++;
+        std::string path = config.dump_prefix + "_" + std::to_string(sample.op) + ".txt";
+        std::ofstream out(path);
+        out << "cim-replay 1\n";
+        out << "op " << sample.op << "\n";
+        out << "geometry " << state.rows() << " " << state.cols() << " " << state.precision().data_width
+            << " " << state.precision().compute_width << "\n";
+        out << "mode " << static_cast<int>(sample.mode) << "\n";
+        out << "row_enable ";
+        write_hex(out, state.row_enable(), state.row_enable_bytes());
+        out << "\ncol_enable ";
+        write_hex(out, state.col_enable(), state.col_enable_bytes());
+        out << "\ninput ";
+        write_hex(out, sample.input.data(), sample.input.size());
+        out << "\nexpected";
+        for (int32_t value : sample.expected) {
+            out << " " << value;
+        }
+        out << "\nactual";
+        for (int32_t value : actual) {
+            out << " " << value;
+        }
+        out << "\nweights\n";
+        for (unsigned int r = 0; r < state.rows(); r++) {
+            write_hex(out, state.weights() + static_cast<size_t>(r) * state.cols(), state.cols());
+            out << "\n";
+        }
+        message << ", replay " << path;
+    }
+    std::cerr << message.str() << std::endl;
+}
+
+bool load_replay(const std::string& path, Replay& replay) {
+    std::ifstream in(path);
+    std::string key;
+    std::string text;
+    unsigned int version = 0;
+    unsigned int rows = 0;
+    unsigned int cols = 0;
+    int mode = 0;
+    Precision precision;
+
+    if (!(in >> key >> version) || key != "cim-replay" || version != 1 ||
+        !(in >> key >> replay.op) || key != "op" ||
+        !(in >> key >> rows >> cols >> precision.data_width >> precision.compute_width) || key != "geometry" ||
+        !(in >> key >> mode) || key != "mode" || mode < 0 || mode > 3) {
+        return false;
+    }
+    replay.mode = static_cast<Mode>(mode);
+    try {
+        replay.state = std::make_shared<Engine>(rows, cols, precision);
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+    Engine& state = *replay.state;
+
+    replay.input.resize(rows);
+    if (!(in >> key >> text) || key != "row_enable" || !read_hex(text, state.row_enable(), state.row_enable_bytes()) ||
+        !(in >> key >> text) || key != "col_enable" || !read_hex(text, state.col_enable(), state.col_enable_bytes()) ||
+        !(in >> key >> text) || key != "input" || !read_hex(text, replay.input.data(), rows)) {
+        return false;
+    }
+
+    const char* lists[] = {"expected", "actual"};
+    std::vector<int32_t>* values[] = {&replay.expected, &replay.actual};
+    for (int i = 0; i < 2; i++) {
+        values[i]->resize(cols);
+        if (!(in >> key) || key != lists[i]) {
+            return false;
+        }
+        for (unsigned int c = 0; c < cols; c++) {
+            if (!(in >> (*values[i])[c])) {
+                return false;
+            }
+        }
+    }
+
+    if (!(in >> key) || key != "weights") {
+        return false;
+    }
+    for (unsigned int r = 0; r < rows; r++) {
+        if (!(in >> text) || !read_hex(text, state.weights() + static_cast<size_t>(r) * cols, cols)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace cim
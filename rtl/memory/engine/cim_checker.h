@@ -0,0 +1,113 @@
+#ifndef CIM_CHECKER_H
+#define CIM_CHECKER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "rtl/memory/engine/cim_engine.h"
+#include "rtl/memory/engine/cim_rtl_array.h"
+
+// Checks a sample of model computes against an RTL array (usually
+// VerilatedArray) on a worker thread. The simulation thread only
+// snapshots what a sampled compute needs and queues it. The weights and
+// enables are copied only when they changed since the last sample. When
+// the worker falls behind, samples are dropped rather than stalling the
+// simulation.
+//
+// A mismatch is reported on stderr and written to a replay file holding
+// the full array state, the mode, the input and both results.
+// load_replay() reads the file back so the compute can be re-run in
+// isolation.
+namespace cim {
+
+struct CheckerConfig {
+    uint64_t every = 0;             // check every Nth compute; 0 disables
+    double probability = 0.0;       // or each compute with this probability
+    uint64_t seed = 1;              // for `probability`, so runs repeat
+    size_t queue_depth = 64;        // queued samples before dropping
+    std::string dump_prefix = "cim_mismatch";   // <prefix>_<op>.txt
+    unsigned int max_dumps = 16;
+};
+
+struct CheckerStats {
+    uint64_t observed = 0;
+    uint64_t sampled = 0;
+    uint64_t checked = 0;
+    uint64_t mismatches = 0;
+    uint64_t dropped = 0;           // queue full
+    uint64_t unsupported = 0;       // mode the RTL cannot run
+};
+
+struct Replay {
+    uint64_t op = 0;
+    Mode mode = Mode::MAC;
+    std::shared_ptr<Engine> state;  // weights, enables and precision
+    std::vector<uint8_t> input;
+    std::vector<int32_t> expected;  // model
+    std::vector<int32_t> actual;    // RTL
+};
+
+class SampledChecker {
+public:
+    // `rtl` belongs to the worker thread from here on and must outlive
+    // the checker; it must not also be attached to a MemoryWrapper.
+    SampledChecker(RtlArray& rtl, CheckerConfig config = CheckerConfig());
+    ~SampledChecker();
+
+    SampledChecker(const SampledChecker&) = delete;
+    SampledChecker& operator=(const SampledChecker&) = delete;
+
+    // Called after every model compute with its inputs and column sums.
+    void observe(const Engine& engine, Mode mode, const uint8_t* input, const int32_t* output);
+
+    // Waits until every queued sample has been checked.
+    void flush();
+
+    // From the simulation thread, like observe().
+    CheckerStats stats() const;
+
+private:
+    struct Sample {
+        uint64_t op;
+        Mode mode;
+        std::shared_ptr<const Engine> state;
+        std::vector<uint8_t> input;
+        std::vector<int32_t> expected;
+    };
+
+    bool sample_next();
+    std::shared_ptr<const Engine> snapshot(const Engine& engine);
+    void run();
+    void report(const Sample& sample, const std::vector<int32_t>& actual);
+
+    RtlArray& rtl;
+    CheckerConfig config;
+    std::mt19937_64 rng;
+    // Simulation thread only
+    uint64_t observed;
+    std::shared_ptr<const Engine> last_state;
+
+    mutable std::mutex lock;
+    std::condition_variable work_ready;
+    std::condition_variable idle;
+    std::deque<Sample> queue;
+    bool busy;
+    bool stopping;
+    CheckerStats counters;
+    unsigned int dumps;
+
+    std::thread worker;
+};
+
+// Reads a replay file written by SampledChecker; false if malformed.
+bool load_replay(const std::string& path, Replay& replay);
+
+} // namespace cim
+
+#endif
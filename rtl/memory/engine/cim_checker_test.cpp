@@ -0,0 +1,159 @@
+// Runs SampledChecker against a reference array built on a plain
+// cim::Engine. A correct run must check every sample without a mismatch;
+// a faulty array must be caught and leave a replay that loads back.
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "rtl/memory/engine/cim_checker.h"
+#include "rtl/memory/engine/cim_engine.h"
+
+namespace {
+
+const unsigned int ROWS = 32;
+const unsigned int COLS = 24;
+
+int failures = 0;
+
+void expect(bool ok, const char* what) {
+    if (!ok) {
+        std::printf("[Test] FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// Stands in for the RTL: a fresh Engine loaded from each snapshot, with
+// no planes, cache or memo. `fault_column` >= 0 corrupts that column.
+class EngineArray : public cim::RtlArray {
+public:
+    explicit EngineArray(int fault_column = -1) : fault(fault_column), loads(0), computes(0) {}
+
+    void load(const cim::Engine& state) override {
+        engine.reset(new cim::Engine(state.rows(), state.cols(), state.precision()));
+        std::copy(state.weights(), state.weights() + state.weight_bytes(), engine->weights());
+        std::copy(state.row_enable(), state.row_enable() + state.row_enable_bytes(), engine->row_enable());
+        std::copy(state.col_enable(), state.col_enable() + state.col_enable_bytes(), engine->col_enable());
+        loads++;
+    }
+
+    bool gemv(cim::Mode mode, const uint8_t* input, int32_t* output) override {
+        if (mode == cim::Mode::XOR) {
+            return false;
+        }
+        engine->gemv(mode, input, output);
+        if (fault >= 0) {
+            output[fault] ^= 1;
+        }
+        computes++;
+        return true;
+    }
+
+    uint64_t cycles() const override { return computes; }
+
+    int fault;
+    unsigned int loads;
+    uint64_t computes;
+
+private:
+    std::unique_ptr<cim::Engine> engine;
+};
+
+void randomise(cim::Engine& engine, std::mt19937& rng) {
+    for (size_t i = 0; i < engine.weight_bytes(); i++) {
+        engine.weights()[i] = static_cast<uint8_t>(rng());
+    }
+    engine.weights_changed();
+}
+
+// `computes` random MACs, SHIFTs and XORs on `model`, each observed, with
+// new weights every `reload` computes.
+void drive(cim::Engine& model, cim::SampledChecker& checker, std::mt19937& rng, int computes, int reload) {
+    const cim::Mode modes[] = {cim::Mode::MAC, cim::Mode::SHIFT, cim::Mode::XOR};
+    std::vector<uint8_t> input(ROWS);
+    std::vector<int32_t> output(COLS);
+    for (int i = 0; i < computes; i++) {
+        if (i % reload == 0) {
+            randomise(model, rng);
+        }
+        for (uint8_t& x : input) {
+            x = static_cast<uint8_t>(rng() % 4);
+        }
+        cim::Mode mode = modes[i % 3];
+        model.gemv(mode, input.data(), output.data());
+        checker.observe(model, mode, input.data(), output.data());
+    }
+    checker.flush();
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(3);
+
+    {
+        // The model runs with every derived state on, like MemoryWrapper.
+        cim::Engine model(ROWS, COLS);
+        model.set_bit_planes(true);
+        model.set_incremental(8);
+        model.set_memo(16);
+        EngineArray rtl;
+        cim::CheckerConfig config;
+        config.every = 1;
+        config.queue_depth = 300;
+        config.dump_prefix = "cim_checker_test_clean";
+        {
+            cim::SampledChecker checker(rtl, config);
+            drive(model, checker, rng, 300, 50);
+            cim::CheckerStats stats = checker.stats();
+            expect(stats.observed == 300 && stats.sampled == 300, "every compute sampled");
+            expect(stats.checked == 200 && stats.unsupported == 100, "MAC and SHIFT checked, XOR skipped");
+            expect(stats.mismatches == 0 && stats.dropped == 0, "correct run passes");
+        }
+        expect(rtl.loads == 6, "one load per weight change");
+    }
+
+    {
+        cim::Engine model(ROWS, COLS);
+        EngineArray rtl(5);
+        cim::CheckerConfig config;
+        config.every = 3;
+        config.dump_prefix = "cim_checker_test_fault";
+        config.max_dumps = 1;
+        cim::SampledChecker checker(rtl, config);
+        drive(model, checker, rng, 30, 30);
+        cim::CheckerStats stats = checker.stats();
+        expect(stats.sampled == 10 && stats.checked == 10, "every third compute checked");
+        expect(stats.mismatches == stats.checked, "faulty array caught");
+
+        // op 0 is a MAC on the first weights; its replay reproduces it.
+        cim::Replay replay;
+        expect(cim::load_replay("cim_checker_test_fault_0.txt", replay), "replay loads");
+        if (replay.state) {
+            std::vector<int32_t> again(COLS);
+            replay.state->gemv(replay.mode, replay.input.data(), again.data());
+            expect(replay.op == 0 && replay.mode == cim::Mode::MAC, "replay op and mode");
+            expect(again == replay.expected, "replay state reproduces the model");
+            expect(replay.actual[5] == (replay.expected[5] ^ 1), "replay holds the rtl result");
+        }
+    }
+
+    {
+        // No room in the queue: everything sampled is dropped unchecked.
+        cim::Engine model(ROWS, COLS);
+        EngineArray rtl;
+        cim::CheckerConfig config;
+        config.every = 1;
+        config.queue_depth = 0;
+        cim::SampledChecker checker(rtl, config);
+        drive(model, checker, rng, 20, 20);
+        cim::CheckerStats stats = checker.stats();
+        expect(stats.dropped == 20 && stats.checked == 0, "full queue drops");
+        expect(rtl.loads == 0, "dropped samples load nothing");
+    }
+
+    std::printf("[Test] cim_checker: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
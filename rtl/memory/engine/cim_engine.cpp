@@ -0,0 +1,516 @@
+#include "rtl/memory/engine/cim_engine.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace cim {
+
+namespace {
+
+size_t plane_words(unsigned int rows) {
+    return (rows + 63) / 64;
+}
+
+const size_t NO_SLOT = static_cast<size_t>(-1);
+
+// 64-bit FNV-1a
+const uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+const uint64_t FNV_PRIME = 0x100000001b3ull;
+
+uint64_t fnv1a(uint64_t hash, const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+} // namespace
+
+Engine::Engine(unsigned int rows, unsigned int cols, Precision precision)
+    : num_rows(rows), num_cols(cols), prec(precision), use_planes(false), planes_stale(true),
+      cache_limit(0), all_dirty(true), weight_version(0), memo_limit(0), memo_head(NO_SLOT),
+      memo_tail(NO_SLOT) {
+    if (rows == 0 || cols == 0) {
+        throw std::invalid_argument("cim::Engine: empty array");
+    }
+    if (precision.data_width < 1 || precision.data_width > 8 ||
+        precision.compute_width < 1 || precision.compute_width > 32) {
+        throw std::invalid_argument("cim::Engine: unsupported precision");
+    }
+    weight_codes.assign(static_cast<size_t>(rows) * cols, 0);
+    row_mask.assign((rows + 7) / 8, 0xFF);
+    col_mask.assign((cols + 7) / 8, 0xFF);
+}
+
+void Engine::gemv(Mode mode, const uint8_t* input, int32_t* output) const {
+    gemm(mode, input, 1, output);
+}
+
+void Engine::gemm(Mode mode, const uint8_t* inputs, size_t count, int32_t* outputs) const {
+    bool use_planes_now = planes_for(mode);
+    // Row-enable words, then one input plane per bit.
+    std::vector<uint64_t> scratch(use_planes_now ? plane_words(num_rows) * (prec.data_width + 1) : 0);
+    std::vector<int64_t> sums(num_cols);
+    if (cache_limit) {
+        sync_cache();
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* input = inputs + i * num_rows;
+        int32_t* output = outputs + i * num_cols;
+        uint64_t key = 0;
+        if (memo_limit) {
+            key = memo_key(mode, input);
+            if (memo_lookup(key, mode, input, output)) {
+                continue;
+            }
+        }
+        if (!(cache_limit && cached_result(mode, input, output))) {
+            if (use_planes_now) {
+                compute_planes(mode, input, output, sums.data(), scratch.data());
+            } else {
+                compute(mode, input, output, sums.data());
+            }
+            counters.full++;
+            if (cache_limit) {
+                remember(mode, input, sums.data());
+            }
+        }
+        if (memo_limit) {
+            memo_insert(key, mode, input, output);
+        }
+    }
+}
+
+void Engine::swap_weights(std::vector<uint8_t>& bank) {
+    if (bank.size() != weight_codes.size()) {
+        throw std::invalid_argument("cim::Engine: weight bank size mismatch");
+    }
+    weight_codes.swap(bank);
+    weights_changed();
+}
+
+void Engine::set_bit_planes(bool enable) {
+    use_planes = enable;
+    planes_stale = true;
+    if (!enable) {
+        std::vector<uint64_t>().swap(planes);
+    }
+}
+
+// Row-outer order walks the row-major weights sequentially; the inner
+// loops are branch-free so they vectorise.
+void Engine::compute(Mode mode, const uint8_t* input, int32_t* output, int64_t* sums) const {
+    uint32_t mask = (1u << prec.data_width) - 1;
+    std::fill(sums, sums + num_cols, 0);
+
+    for (unsigned int r = 0; r < num_rows; r++) {
+        if (!(row_mask[r / 8] & (1u << (r % 8)))) {
+            continue;
+        }
+        const uint8_t* w = &weight_codes[static_cast<size_t>(r) * num_cols];
+        switch (mode) {
+            case Mode::MAC: {
+                int32_t x = sign_extend(input[r]);
+                if (x == 0) {
+                    break;
+                }
+                for (unsigned int c = 0; c < num_cols; c++) {
+                    sums[c] += static_cast<int64_t>(sign_extend(w[c])) * x;
+                }
+                break;
+            }
+            case Mode::ADD: {
+                int32_t x = sign_extend(input[r]);
+                for (unsigned int c = 0; c < num_cols; c++) {
+                    sums[c] += static_cast<int64_t>(sign_extend(w[c])) + x;
+                }
+                break;
+            }
+            case Mode::SHIFT: {
+                // Shift-and-add over the input bits equals the unsigned product.
+                uint32_t x = input[r] & mask;
+                if (x == 0) {
+                    break;
+                }
+                for (unsigned int c = 0; c < num_cols; c++) {
+                    sums[c] += static_cast<int64_t>(w[c] & mask) * x;
+                }
+                break;
+            }
+            case Mode::XOR:
+            default: {
+                uint32_t x = input[r] & mask;
+                for (unsigned int c = 0; c < num_cols; c++) {
+                    sums[c] += (w[c] ^ x) & mask;
+                }
+                break;
+            }
+        }
+    }
+
+    for (unsigned int c = 0; c < num_cols; c++) {
+        output[c] = (col_mask[c / 8] & (1u << (c % 8))) ? wrap(sums[c]) : 0;
+    }
+}
+
+void Engine::set_incremental(size_t vectors) {
+    cache_limit = vectors;
+    cached.clear();
+    all_dirty = true;
+    dirty_rows.clear();
+    row_dirty.assign(vectors ? num_rows : 0, 0);
+    if (!vectors) {
+        std::vector<uint8_t>().swap(reference);
+    }
+}
+
+void Engine::set_memo(size_t entries) {
+    memo_limit = entries;
+    std::vector<MemoEntry>().swap(memo_slots);
+    memo_index.clear();
+    memo_head = NO_SLOT;
+    memo_tail = NO_SLOT;
+}
+
+void Engine::weights_changed() {
+    planes_stale = true;
+    all_dirty = true;
+    weight_version++;
+}
+
+void Engine::weights_changed(size_t offset, size_t len) {
+    planes_stale = true;
+    weight_version++;
+    if (!cache_limit || all_dirty || len == 0) {
+        return;
+    }
+    size_t last = std::min<size_t>((offset + len - 1) / num_cols, num_rows - 1);
+    for (size_t r = offset / num_cols; r <= last; r++) {
+        if (!row_dirty[r]) {
+            row_dirty[r] = 1;
+            dirty_rows.push_back(static_cast<unsigned int>(r));
+        }
+    }
+}
+
+// SHIFT needs data_width^2 popcounts per 64 rows, which stops paying off
+// beyond 4-bit data.
+bool Engine::planes_for(Mode mode) const {
+    return use_planes && (mode == Mode::XOR || (mode == Mode::SHIFT && prec.data_width <= 4));
+}
+
+void Engine::build_planes() const {
+    size_t words = plane_words(num_rows);
+    unsigned int bits = prec.data_width;
+    planes.assign(static_cast<size_t>(num_cols) * bits * words, 0);
+
+    for (unsigned int r = 0; r < num_rows; r++) {
+        const uint8_t* w = &weight_codes[static_cast<size_t>(r) * num_cols];
+        uint64_t row_bit = uint64_t(1) << (r % 64);
+        uint64_t* word = &planes[r / 64];
+        for (unsigned int c = 0; c < num_cols; c++) {
+            for (unsigned int b = 0; b < bits; b++) {
+                if ((w[c] >> b) & 1) {
+                    word[(static_cast<size_t>(c) * bits + b) * words] |= row_bit;
+                }
+            }
+        }
+    }
+    planes_stale = false;
+}
+
+void Engine::compute_planes(Mode mode, const uint8_t* input, int32_t* output, int64_t* sums,
+                            uint64_t* scratch) const {
+    if (planes_stale) {
+        build_planes();
+    }
+    size_t words = plane_words(num_rows);
+    unsigned int bits = prec.data_width;
+    uint64_t* enabled = scratch;
+    uint64_t* x = scratch + words;
+
+    // Input planes hold enabled rows only.
+    std::fill(scratch, scratch + words * (bits + 1), 0);
+    for (unsigned int r = 0; r < num_rows; r++) {
+        if (!(row_mask[r / 8] & (1u << (r % 8)))) {
+            continue;
+        }
+        uint64_t row_bit = uint64_t(1) << (r % 64);
+        enabled[r / 64] |= row_bit;
+        for (unsigned int b = 0; b < bits; b++) {
+            if ((input[r] >> b) & 1) {
+                x[b * words + r / 64] |= row_bit;
+            }
+        }
+    }
+
+    // SHIFT skips input planes that are all zero.
+    uint32_t live_inputs = 0;
+    for (unsigned int k = 0; k < bits; k++) {
+        for (size_t i = 0; i < words; i++) {
+            if (x[k * words + i]) {
+                live_inputs |= 1u << k;
+                break;
+            }
+        }
+    }
+
+    for (unsigned int c = 0; c < num_cols; c++) {
+        if (!(col_mask[c / 8] & (1u << (c % 8)))) {
+            sums[c] = 0;
+            output[c] = 0;
+            continue;
+        }
+        const uint64_t* w = &planes[static_cast<size_t>(c) * bits * words];
+        uint64_t sum = 0;
+        for (unsigned int b = 0; b < bits; b++) {
+            const uint64_t* wb = w + b * words;
+            if (mode == Mode::XOR) {
+                uint64_t count = 0;
+                for (size_t i = 0; i < words; i++) {
+                    count += __builtin_popcountll((wb[i] ^ x[b * words + i]) & enabled[i]);
+                }
+                sum += count << b;
+                continue;
+            }
+            for (unsigned int k = 0; k < bits; k++) {
+                if (!(live_inputs & (1u << k))) {
+                    continue;
+                }
+                uint64_t count = 0;
+                for (size_t i = 0; i < words; i++) {
+                    count += __builtin_popcountll(wb[i] & x[k * words + i]);
+                }
+                sum += count << (b + k);
+            }
+        }
+        sums[c] = static_cast<int64_t>(sum);
+        output[c] = wrap(sums[c]);
+    }
+}
+
+int64_t Engine::cell(Mode mode, uint8_t weight, uint8_t input) const {
+    uint32_t mask = (1u << prec.data_width) - 1;
+    switch (mode) {
+        case Mode::MAC:
+            return static_cast<int64_t>(sign_extend(weight)) * sign_extend(input);
+        case Mode::ADD:
+            return static_cast<int64_t>(sign_extend(weight)) + sign_extend(input);
+        case Mode::SHIFT:
+            return static_cast<int64_t>(weight & mask) * (input & mask);
+        case Mode::XOR:
+        default:
+            return (weight ^ input) & mask;
+    }
+}
+
+// Brings every cached sum up to date with the weights, or drops them all
+// when folding the dirty rows in would cost more than recomputing.
+void Engine::sync_cache() const {
+    if (all_dirty || dirty_rows.size() * cached.size() > num_rows) {
+        cached.clear();
+        reference = weight_codes;
+    } else {
+        for (unsigned int r : dirty_rows) {
+            const uint8_t* now = &weight_codes[static_cast<size_t>(r) * num_cols];
+            uint8_t* before = &reference[static_cast<size_t>(r) * num_cols];
+            for (CachedSums& entry : cached) {
+                if (!(entry.row_mask[r / 8] & (1u << (r % 8)))) {
+                    continue;
+                }
+                uint8_t x = entry.input[r];
+                for (unsigned int c = 0; c < num_cols; c++) {
+                    if (now[c] != before[c]) {
+                        entry.sums[c] += cell(entry.mode, now[c], x) - cell(entry.mode, before[c], x);
+                    }
+                }
+            }
+            std::copy(now, now + num_cols, before);
+        }
+        counters.delta_rows += dirty_rows.size();
+    }
+
+    for (unsigned int r : dirty_rows) {
+        row_dirty[r] = 0;
+    }
+    dirty_rows.clear();
+    all_dirty = false;
+}
+
+bool Engine::cached_result(Mode mode, const uint8_t* input, int32_t* output) const {
+    for (size_t i = 0; i < cached.size(); i++) {
+        CachedSums& entry = cached[i];
+        if (entry.mode != mode || !std::equal(input, input + num_rows, entry.input.begin()) ||
+            entry.row_mask != row_mask || entry.col_mask != col_mask) {
+            continue;
+        }
+        for (unsigned int c = 0; c < num_cols; c++) {
+            output[c] = (col_mask[c / 8] & (1u << (c % 8))) ? wrap(entry.sums[c]) : 0;
+        }
+        std::rotate(cached.begin(), cached.begin() + i, cached.begin() + i + 1);
+        counters.cached++;
+        return true;
+    }
+    return false;
+}
+
+void Engine::remember(Mode mode, const uint8_t* input, const int64_t* sums) const {
+    if (cached.size() < cache_limit) {
+        cached.emplace_back();
+    }
+    std::rotate(cached.begin(), cached.end() - 1, cached.end());
+    CachedSums& entry = cached.front();
+    entry.mode = mode;
+    entry.input.assign(input, input + num_rows);
+    entry.row_mask = row_mask;
+    entry.col_mask = col_mask;
+    entry.sums.assign(sums, sums + num_cols);
+}
+
+// The key covers everything a compute depends on, so a slot is only ever
+// reused for the same key. Lookups still compare the contents to rule out
+// hash collisions.
+uint64_t Engine::memo_key(Mode mode, const uint8_t* input) const {
+    uint64_t hash = FNV_OFFSET;
+    hash = fnv1a(hash, reinterpret_cast<const uint8_t*>(&weight_version), sizeof(weight_version));
+    uint8_t mode_code = static_cast<uint8_t>(mode);
+    hash = fnv1a(hash, &mode_code, 1);
+    hash = fnv1a(hash, row_mask.data(), row_mask.size());
+    hash = fnv1a(hash, col_mask.data(), col_mask.size());
+    return fnv1a(hash, input, num_rows);
+}
+
+bool Engine::memo_lookup(uint64_t key, Mode mode, const uint8_t* input, int32_t* output) const {
+    auto found = memo_index.find(key);
+    if (found != memo_index.end()) {
+        const MemoEntry& entry = memo_slots[found->second];
+        if (entry.version == weight_version && entry.mode == mode &&
+            std::equal(input, input + num_rows, entry.input.begin()) &&
+            entry.row_mask == row_mask && entry.col_mask == col_mask) {
+            std::copy(entry.output.begin(), entry.output.end(), output);
+            memo_unlink(found->second);
+            memo_push_front(found->second);
+            counters.memo_hits++;
+            return true;
+        }
+    }
+    counters.memo_misses++;
+    return false;
+}
+
+void Engine::memo_insert(uint64_t key, Mode mode, const uint8_t* input, const int32_t* output) const {
+    size_t slot;
+    auto found = memo_index.find(key);
+    if (found != memo_index.end()) {
+        // A collision: the newer compute takes the slot.
+        slot = found->second;
+        memo_unlink(slot);
+    } else if (memo_slots.size() < memo_limit) {
+        slot = memo_slots.size();
+        memo_slots.emplace_back();
+        memo_index[key] = slot;
+    } else {
+        slot = memo_tail;
+        memo_unlink(slot);
+        memo_index.erase(memo_slots[slot].key);
+        memo_index[key] = slot;
+        counters.memo_evictions++;
+    }
+
+    MemoEntry& entry = memo_slots[slot];
+    entry.key = key;
+    entry.version = weight_version;
+    entry.mode = mode;
+    entry.input.assign(input, input + num_rows);
+    entry.row_mask = row_mask;
+    entry.col_mask = col_mask;
+    entry.output.assign(output, output + num_cols);
+    memo_push_front(slot);
+}
+
+void Engine::memo_unlink(size_t slot) const {
+    MemoEntry& entry = memo_slots[slot];
+    if (entry.prev != NO_SLOT) {
+        memo_slots[entry.prev].next = entry.next;
+    } else {
+        memo_head = entry.next;
+    }
+    if (entry.next != NO_SLOT) {
+        memo_slots[entry.next].prev = entry.prev;
+    } else {
+        memo_tail = entry.prev;
+    }
+}
+
+void Engine::memo_push_front(size_t slot) const {
+    MemoEntry& entry = memo_slots[slot];
+    entry.prev = NO_SLOT;
+    entry.next = memo_head;
+    if (memo_head != NO_SLOT) {
+        memo_slots[memo_head].prev = slot;
+    } else {
+        memo_tail = slot;
+    }
+    memo_head = slot;
+}
+
+int32_t Engine::sign_extend(uint8_t code) const {
+    int32_t shift = 32 - prec.data_width;
+    return static_cast<int32_t>(static_cast<uint32_t>(code) << shift) >> shift;
+}
+
+// Two's-complement wrap to COMPUTE_WIDTH bits.
+int32_t Engine::wrap(int64_t sum) const {
+    uint64_t mask = (uint64_t(1) << prec.compute_width) - 1;
+    uint64_t value = static_cast<uint64_t>(sum) & mask;
+    if (value & (uint64_t(1) << (prec.compute_width - 1))) {
+        value |= ~mask;
+    }
+    return static_cast<int32_t>(static_cast<int64_t>(value));
+}
+
+void tiled_gemm(Mode mode, Precision precision, TileGeometry tile,
+                const int8_t* weights, unsigned int k, unsigned int n,
+                const int8_t* inputs, size_t m, int32_t* outputs) {
+    if (tile.rows == 0 || tile.cols == 0) {
+        throw std::invalid_argument("cim::tiled_gemm: empty tile");
+    }
+    std::fill(outputs, outputs + m * n, 0);
+
+    std::vector<uint8_t> tile_inputs;
+    std::vector<int32_t> tile_outputs;
+    for (unsigned int k0 = 0; k0 < k; k0 += tile.rows) {
+        unsigned int tk = std::min(tile.rows, k - k0);
+
+        // Gather this K slice of every input vector once for all column tiles.
+        tile_inputs.resize(m * tk);
+        for (size_t i = 0; i < m; ++i) {
+            const int8_t* src = inputs + i * k + k0;
+            std::copy(src, src + tk, reinterpret_cast<int8_t*>(&tile_inputs[i * tk]));
+        }
+
+        for (unsigned int n0 = 0; n0 < n; n0 += tile.cols) {
+            unsigned int tn = std::min(tile.cols, n - n0);
+            Engine engine(tk, tn, precision);
+            // Building the planes costs about data_width computes.
+            engine.set_bit_planes(m >= precision.data_width);
+            for (unsigned int r = 0; r < tk; ++r) {
+                const int8_t* src = weights + static_cast<size_t>(k0 + r) * n + n0;
+                std::copy(src, src + tn, reinterpret_cast<int8_t*>(engine.weights() + static_cast<size_t>(r) * tn));
+            }
+
+            tile_outputs.resize(m * tn);
+            engine.gemm(mode, tile_inputs.data(), m, tile_outputs.data());
+            for (size_t i = 0; i < m; ++i) {
+                int32_t* dst = outputs + i * n + n0;
+                for (unsigned int c = 0; c < tn; ++c) {
+                    // 32-bit digital accumulation across K tiles
+                    dst[c] = static_cast<int32_t>(static_cast<uint32_t>(dst[c]) +
+                                                  static_cast<uint32_t>(tile_outputs[i * tn + c]));
+                }
+            }
+        }
+    }
+}
+
+} // namespace cim
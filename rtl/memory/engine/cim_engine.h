@@ -0,0 +1,212 @@
+#ifndef CIM_ENGINE_H
+#define CIM_ENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Compute semantics of the generated cell_array, with no SystemC
+// dependency. MemoryWrapper (../systemc/memory_wrapper.h) is a TLM adapter
+// over Engine. Offline tools can use Engine or tiled_gemm() directly.
+//
+// Each cell holds a DATA_WIDTH-bit weight code. A compute applies the cell
+// operation between the weight and the row's input, sums the enabled rows
+// of every enabled column, and wraps the sum to COMPUTE_WIDTH bits like
+// the RTL col_sum:
+//
+//   MAC   w * x   signed
+//   ADD   w + x   signed
+//   SHIFT w * x   unsigned, bit-serial shift-and-add
+//   XOR   w ^ x   unsigned
+//
+// Disabled columns produce 0.
+//
+// With bit planes enabled, XOR and SHIFT also keep the weights transposed:
+// one bit vector over the rows per column and weight bit. A column sum
+// is then a popcount over 64 rows at a time. XOR decomposes per bit:
+//   sum (w ^ x) = sum_b 2^b popcount(W_b ^ X_b)
+// SHIFT decomposes per pair of weight and input bits, and uses the
+// planes only up to 4-bit data:
+//   sum w * x = sum_{b,k} 2^(b+k) popcount(W_b & X_k)
+// Incremental mode keeps the raw column sums of the last few distinct
+// input vectors, along with a reference copy of the weights they were
+// computed against. A repeated input is answered from its sums. Rows
+// written since then are first folded in as sum += op(w_new, x) -
+// op(w_old, x), so a small weight update costs dirty rows x cols rather
+// than rows x cols. When the delta would cost more than recomputing, the
+// cached sums are dropped instead.
+//
+// The result memo is a bounded LRU of finished outputs, found by a hash
+// of the weight version, mode, enables and input. Every weights_changed()
+// starts a new version, so entries from older weights are never hit and
+// age out. A hit costs one pass over the input instead of a compute.
+//
+// All three derive state from the weights. Writers through weights() must
+// call weights_changed(), with the byte range written when known.
+namespace cim {
+
+struct ComputeStats {
+    uint64_t full = 0;          // computed over the whole array
+    uint64_t cached = 0;        // answered from cached column sums
+    uint64_t delta_rows = 0;    // dirty rows folded into cached sums
+    uint64_t memo_hits = 0;
+    uint64_t memo_misses = 0;
+    uint64_t memo_evictions = 0;
+};
+
+enum class Mode {
+    MAC = 0,
+    ADD = 1,
+    SHIFT = 2,
+    XOR = 3
+};
+
+struct Precision {
+    unsigned int data_width = 8;        // 1..8 bits per weight and input
+    unsigned int compute_width = 16;    // 1..32 bits per column sum
+};
+
+class Engine {
+public:
+    // Throws std::invalid_argument for an empty array or an unsupported
+    // precision.
+    Engine(unsigned int rows, unsigned int cols, Precision precision = Precision());
+
+    unsigned int rows() const { return num_rows; }
+    unsigned int cols() const { return num_cols; }
+    const Precision& precision() const { return prec; }
+
+    // rows x cols weight codes, row major; one byte per cell, low
+    // DATA_WIDTH bits significant.
+    uint8_t* weights() { return weight_codes.data(); }
+    const uint8_t* weights() const { return weight_codes.data(); }
+    size_t weight_bytes() const { return weight_codes.size(); }
+
+    // Exchanges the weights with `bank`, which must hold weight_bytes().
+    // Pointers from weights() then refer to `bank`'s storage.
+    void swap_weights(std::vector<uint8_t>& bank);
+
+    // Enable bitmaps, bit i of byte i / 8; all set after construction.
+    uint8_t* row_enable() { return row_mask.data(); }
+    uint8_t* col_enable() { return col_mask.data(); }
+    const uint8_t* row_enable() const { return row_mask.data(); }
+    const uint8_t* col_enable() const { return col_mask.data(); }
+    size_t row_enable_bytes() const { return row_mask.size(); }
+    size_t col_enable_bytes() const { return col_mask.size(); }
+
+    // One compute: `input` holds rows codes, `output` receives cols sums.
+    void gemv(Mode mode, const uint8_t* input, int32_t* output) const;
+
+    // `count` computes back to back: inputs are count x rows, outputs
+    // count x cols, both row major.
+    void gemm(Mode mode, const uint8_t* inputs, size_t count, int32_t* outputs) const;
+
+    void set_bit_planes(bool enable);
+    bool bit_planes() const { return use_planes; }
+
+    // Caches the sums of up to `vectors` inputs; 0 turns it off.
+    void set_incremental(size_t vectors);
+    size_t incremental() const { return cache_limit; }
+
+    // Memoises the outputs of up to `entries` computes; 0 turns it off.
+    void set_memo(size_t entries);
+    size_t memo() const { return memo_limit; }
+
+    // True when weight writes must be reported through weights_changed().
+    bool tracks_writes() const { return use_planes || cache_limit > 0 || memo_limit > 0; }
+    void weights_changed();
+    void weights_changed(size_t offset, size_t len);
+
+    const ComputeStats& stats() const { return counters; }
+
+    int32_t sign_extend(uint8_t code) const;
+    int32_t wrap(int64_t sum) const;
+
+private:
+    struct CachedSums {
+        Mode mode;
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> row_mask;
+        std::vector<uint8_t> col_mask;
+        std::vector<int64_t> sums;
+    };
+
+    // Slots of the memo, linked in LRU order by index so that copies of
+    // the engine stay valid.
+    struct MemoEntry {
+        uint64_t key;
+        uint64_t version;
+        Mode mode;
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> row_mask;
+        std::vector<uint8_t> col_mask;
+        std::vector<int32_t> output;
+        size_t prev;
+        size_t next;
+    };
+
+    void compute(Mode mode, const uint8_t* input, int32_t* output, int64_t* sums) const;
+    bool planes_for(Mode mode) const;
+    void build_planes() const;
+    void compute_planes(Mode mode, const uint8_t* input, int32_t* output, int64_t* sums,
+                        uint64_t* scratch) const;
+    int64_t cell(Mode mode, uint8_t weight, uint8_t input) const;
+    void sync_cache() const;
+    bool cached_result(Mode mode, const uint8_t* input, int32_t* output) const;
+    void remember(Mode mode, const uint8_t* input, const int64_t* sums) const;
+    uint64_t memo_key(Mode mode, const uint8_t* input) const;
+    bool memo_lookup(uint64_t key, Mode mode, const uint8_t* input, int32_t* output) const;
+    void memo_insert(uint64_t key, Mode mode, const uint8_t* input, const int32_t* output) const;
+    void memo_unlink(size_t slot) const;
+    void memo_push_front(size_t slot) const;
+
+    unsigned int num_rows;
+    unsigned int num_cols;
+    Precision prec;
+    std::vector<uint8_t> weight_codes;
+    std::vector<uint8_t> row_mask;
+    std::vector<uint8_t> col_mask;
+
+    // [col][weight bit][row word]; derived from weight_codes on demand.
+    bool use_planes;
+    mutable bool planes_stale;
+    mutable std::vector<uint64_t> planes;
+
+    // Incremental mode; cached[0] is the most recently used.
+    size_t cache_limit;
+    mutable std::vector<CachedSums> cached;
+    mutable std::vector<uint8_t> reference;
+    mutable std::vector<uint8_t> row_dirty;
+    mutable std::vector<unsigned int> dirty_rows;
+    mutable bool all_dirty;
+
+    // Result memo; memo_head is the most recently used slot.
+    uint64_t weight_version;
+    size_t memo_limit;
+    mutable std::vector<MemoEntry> memo_slots;
+    mutable std::unordered_map<uint64_t, size_t> memo_index;
+    mutable size_t memo_head;
+    mutable size_t memo_tail;
+
+    mutable ComputeStats counters;
+};
+
+// Geometry of the physical array a large matrix is mapped onto.
+struct TileGeometry {
+    unsigned int rows = 256;
+    unsigned int cols = 256;
+};
+
+// out[m][n] = sum_k op(weights[k][n], inputs[m][k]), for a K x N weight
+// matrix, split into tile.rows x tile.cols tiles. Each tile's column sums
+// wrap to COMPUTE_WIDTH the way the array would. The partial sums of the
+// tiles along K then accumulate in 32-bit digital adders. Weights and
+// inputs are signed codes, one byte each.
+void tiled_gemm(Mode mode, Precision precision, TileGeometry tile,
+                const int8_t* weights, unsigned int k, unsigned int n,
+                const int8_t* inputs, size_t m, int32_t* outputs);
+
+} // namespace cim
+
+#endif
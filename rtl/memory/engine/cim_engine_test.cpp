@@ -0,0 +1,331 @@
+// cim::Engine's derived state, and cim::FixedEngine, against a plain
+// scalar model of the semantics in cim_engine.h: whatever is switched on,
+// every compute must give the same column sums, wrapped to COMPUTE_WIDTH.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "rtl/memory/engine/cim_engine.h"
+#include "rtl/memory/engine/cim_fixed_engine.h"
+
+namespace {
+
+int failures = 0;
+
+void expect(bool ok, const char* what) {
+    if (!ok) {
+        std::printf("[Test] FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+const cim::Mode MODES[] = {cim::Mode::MAC, cim::Mode::ADD, cim::Mode::SHIFT, cim::Mode::XOR};
+
+bool enabled(const uint8_t* mask, unsigned int i) {
+    return (mask[i / 8] >> (i % 8)) & 1;
+}
+
+// One cell per step, straight from the header.
+std::vector<int32_t> reference(const cim::Engine& engine, cim::Mode mode, const uint8_t* input) {
+    unsigned int width = engine.precision().data_width;
+    uint32_t mask = (1u << width) - 1;
+    std::vector<int32_t> output(engine.cols(), 0);
+    for (unsigned int c = 0; c < engine.cols(); c++) {
+        if (!enabled(engine.col_enable(), c)) {
+            continue;
+        }
+        int64_t sum = 0;
+        for (unsigned int r = 0; r < engine.rows(); r++) {
+            if (!enabled(engine.row_enable(), r)) {
+                continue;
+            }
+            uint8_t w = engine.weights()[static_cast<size_t>(r) * engine.cols() + c];
+            uint8_t x = input[r];
+            switch (mode) {
+                case cim::Mode::MAC:
+                    sum += static_cast<int64_t>(engine.sign_extend(w)) * engine.sign_extend(x);
+                    break;
+                case cim::Mode::ADD:
+                    sum += engine.sign_extend(w) + engine.sign_extend(x);
+                    break;
+                case cim::Mode::SHIFT:
+                    sum += static_cast<int64_t>(w & mask) * (x & mask);
+                    break;
+                case cim::Mode::XOR:
+                    sum += (w ^ x) & mask;
+                    break;
+            }
+        }
+        output[c] = engine.wrap(sum);
+    }
+    return output;
+}
+
+void randomise(std::vector<uint8_t>& bytes, std::mt19937& rng) {
+    for (uint8_t& b : bytes) {
+        b = static_cast<uint8_t>(rng());
+    }
+}
+
+// Random weights, enables and inputs with the high bits of every code
+// set at random too, which the engine must ignore.
+void fill(cim::Engine& engine, std::mt19937& rng, bool all_enabled) {
+    for (size_t i = 0; i < engine.weight_bytes(); i++) {
+        engine.weights()[i] = static_cast<uint8_t>(rng());
+    }
+    for (size_t i = 0; i < engine.row_enable_bytes(); i++) {
+        engine.row_enable()[i] = all_enabled ? 0xff : static_cast<uint8_t>(rng() | rng());
+    }
+    for (size_t i = 0; i < engine.col_enable_bytes(); i++) {
+        engine.col_enable()[i] = all_enabled ? 0xff : static_cast<uint8_t>(rng() | rng());
+    }
+    engine.weights_changed();
+}
+
+// Bit planes against the scalar model, over sizes that leave partial
+// 64-row words, every mode, data widths on both sides of SHIFT's 4-bit
+// limit, and compute widths narrow enough to wrap.
+void bit_planes(std::mt19937& rng) {
+    const unsigned int sizes[][2] = {{8, 8}, {64, 16}, {70, 9}, {130, 33}};
+    const unsigned int data_widths[] = {1, 2, 3, 4, 5, 8};
+    const unsigned int compute_widths[] = {4, 9, 16, 32};
+    const size_t batch = 5;
+    for (const auto& size : sizes) {
+        for (unsigned int data_width : data_widths) {
+            for (unsigned int compute_width : compute_widths) {
+                cim::Precision precision;
+                precision.data_width = data_width;
+                precision.compute_width = compute_width;
+                cim::Engine engine(size[0], size[1], precision);
+                engine.set_bit_planes(true);
+                std::vector<uint8_t> inputs(batch * size[0]);
+                std::vector<int32_t> outputs(batch * size[1]);
+                for (int round = 0; round < 2; round++) {
+                    // The second round rewrites the weights, so stale planes show.
+                    fill(engine, rng, round == 0);
+                    randomise(inputs, rng);
+                    for (cim::Mode mode : MODES) {
+                        engine.gemm(mode, inputs.data(), batch, outputs.data());
+                        bool same = true;
+                        for (size_t i = 0; i < batch; i++) {
+                            std::vector<int32_t> expected = reference(engine, mode, &inputs[i * size[0]]);
+                            same = same && std::equal(expected.begin(), expected.end(), &outputs[i * size[1]]);
+                        }
+                        if (!same) {
+                            std::printf("[Test] %ux%u data %u compute %u mode %d round %d\n", size[0], size[1],
+                                        data_width, compute_width, static_cast<int>(mode), round);
+                        }
+                        expect(same, "bit planes match the scalar model");
+                    }
+                }
+            }
+        }
+    }
+
+    // 70 rows of 15 ^ 0 sum to 1050, which wraps to 26 in 6 bits.
+    cim::Precision precision;
+    precision.data_width = 4;
+    precision.compute_width = 6;
+    cim::Engine engine(70, 2, precision);
+    engine.set_bit_planes(true);
+    std::fill(engine.weights(), engine.weights() + engine.weight_bytes(), 0x0f);
+    engine.weights_changed();
+    std::vector<uint8_t> input(70, 0);
+    int32_t output[2];
+    engine.gemv(cim::Mode::XOR, input.data(), output);
+    expect(output[0] == 26 && output[1] == 26, "XOR planes wrap to COMPUTE_WIDTH");
+}
+
+// Random writes, each reported with its byte range, between computes
+// that mostly repeat a few inputs, so the cached sums are patched row by
+// row. Every result must equal a full recompute.
+void incremental_sums(std::mt19937& rng) {
+    const unsigned int rows = 96;
+    const unsigned int cols = 20;
+    cim::Precision precision;
+    precision.compute_width = 12;
+    cim::Engine engine(rows, cols, precision);
+    engine.set_incremental(4);
+    fill(engine, rng, true);
+
+    // Five inputs against four cache slots, so some also fall out.
+    std::vector<std::vector<uint8_t>> inputs(5, std::vector<uint8_t>(rows));
+    for (std::vector<uint8_t>& input : inputs) {
+        randomise(input, rng);
+    }
+    std::vector<int32_t> output(cols);
+    for (int i = 0; i < 400; i++) {
+        if (i % 3 == 0) {
+            size_t offset = rng() % engine.weight_bytes();
+            size_t len = 1 + rng() % (i % 30 == 0 ? engine.weight_bytes() - offset : 2 * cols);
+            len = std::min(len, engine.weight_bytes() - offset);
+            for (size_t b = offset; b < offset + len; b++) {
+                engine.weights()[b] = static_cast<uint8_t>(rng());
+            }
+            engine.weights_changed(offset, len);
+        }
+        if (i % 50 == 49) {
+            engine.row_enable()[rng() % engine.row_enable_bytes()] ^= static_cast<uint8_t>(1u << (rng() % 8));
+            engine.col_enable()[rng() % engine.col_enable_bytes()] ^= static_cast<uint8_t>(1u << (rng() % 8));
+        }
+        cim::Mode mode = MODES[rng() % 4];
+        const std::vector<uint8_t>& input = inputs[i % 7 < 5 ? i % 7 % 2 : rng() % 5];
+        engine.gemv(mode, input.data(), output.data());
+        expect(output == reference(engine, mode, input.data()), "incremental sums match a full recompute");
+    }
+
+    const cim::ComputeStats& stats = engine.stats();
+    expect(stats.cached > 0 && stats.delta_rows > 0, "repeated inputs take the dirty-row path");
+    expect(stats.full > 0, "new inputs and large writes recompute");
+    std::printf("[Test] incremental: %llu full, %llu cached, %llu delta rows\n",
+                static_cast<unsigned long long>(stats.full), static_cast<unsigned long long>(stats.cached),
+                static_cast<unsigned long long>(stats.delta_rows));
+}
+
+struct MemoCounts {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+};
+
+bool counts_are(const cim::Engine& engine, MemoCounts counts) {
+    const cim::ComputeStats& stats = engine.stats();
+    return stats.memo_hits == counts.hits && stats.memo_misses == counts.misses &&
+           stats.memo_evictions == counts.evictions;
+}
+
+// The memo's LRU order, what drops its entries, and its hit rate on
+// repeating workloads. Every output is also checked for correctness.
+void memo(std::mt19937& rng) {
+    const unsigned int rows = 32;
+    const unsigned int cols = 16;
+    cim::Engine engine(rows, cols);
+    engine.set_memo(4);
+    fill(engine, rng, true);
+
+    std::vector<std::vector<uint8_t>> inputs(8, std::vector<uint8_t>(rows));
+    for (std::vector<uint8_t>& input : inputs) {
+        randomise(input, rng);
+    }
+    std::vector<int32_t> output(cols);
+    auto run = [&](size_t i) {
+        engine.gemv(cim::Mode::MAC, inputs[i].data(), output.data());
+        expect(output == reference(engine, cim::Mode::MAC, inputs[i].data()), "memo output matches the model");
+    };
+
+    // LRU: 0 1 2 3 fill it; 0 is then touched, so 4 evicts 1, not 0.
+    for (size_t i = 0; i < 4; i++) {
+        run(i);
+    }
+    run(0);
+    expect(counts_are(engine, {1, 4, 0}), "memo fills, then hits");
+    run(4);
+    expect(counts_are(engine, {1, 5, 1}), "a fifth input evicts one entry");
+    run(0);
+    run(3);
+    expect(counts_are(engine, {3, 5, 1}), "recently used entries survive");
+    run(1);
+    expect(counts_are(engine, {3, 6, 2}), "the least recently used entry was evicted");
+
+    // A new weight version, a swapped bank or new enables never hit.
+    engine.weights()[5] ^= 0x21;
+    engine.weights_changed(5, 1);
+    run(0);
+    expect(counts_are(engine, {3, 7, 3}), "a weight write drops the memo");
+    run(0);
+    expect(counts_are(engine, {4, 7, 3}), "and it refills on the new weights");
+
+    std::vector<uint8_t> bank(engine.weight_bytes());
+    randomise(bank, rng);
+    std::vector<uint8_t> old_bank(engine.weights(), engine.weights() + engine.weight_bytes());
+    engine.swap_weights(bank);
+    run(0);
+    expect(counts_are(engine, {4, 8, 4}), "a swap drops the memo");
+    engine.swap_weights(bank);
+    expect(std::equal(old_bank.begin(), old_bank.end(), engine.weights()), "swapping back restores the bank");
+    run(0);
+    expect(counts_are(engine, {4, 9, 5}), "swapping back does not revive old entries");
+
+    engine.row_enable()[1] ^= 0x04;
+    run(0);
+    expect(counts_are(engine, {4, 10, 6}), "new enables miss");
+
+    // Hit rate: a working set that fits hits on every repeat; one entry
+    // more than the memo holds, cycled in order, never hits under LRU.
+    engine.set_memo(8);
+    for (size_t i = 0; i < 200; i++) {
+        run(i % 8);
+    }
+    expect(engine.stats().memo_hits == 4 + 192, "working set that fits: all repeats hit");
+    engine.set_memo(7);
+    uint64_t hits = engine.stats().memo_hits;
+    for (size_t i = 0; i < 200; i++) {
+        run(i % 8);
+    }
+    expect(engine.stats().memo_hits == hits, "cyclic working set one larger than the memo never hits");
+}
+
+// FixedEngine against Engine and the scalar model, given the same weights,
+// enables and inputs.
+template <unsigned int ROWS, unsigned int COLS, unsigned int DATA_WIDTH, unsigned int COMPUTE_WIDTH>
+void fixed_engine(std::mt19937& rng) {
+    typedef cim::FixedEngine<ROWS, COLS, DATA_WIDTH, COMPUTE_WIDTH> Fixed;
+    Fixed fixed;
+    cim::Engine engine(ROWS, COLS, Fixed::precision());
+    const size_t batch = 4;
+    std::vector<uint8_t> inputs(batch * ROWS);
+    std::vector<int32_t> expected(batch * COLS);
+    std::vector<int32_t> outputs(batch * COLS);
+    for (int round = 0; round < 2; round++) {
+        fill(engine, rng, round == 0);
+        std::copy(engine.weights(), engine.weights() + Fixed::weight_bytes(), fixed.weights());
+        std::copy(engine.row_enable(), engine.row_enable() + Fixed::row_enable_bytes(), fixed.row_enable());
+        std::copy(engine.col_enable(), engine.col_enable() + Fixed::col_enable_bytes(), fixed.col_enable());
+        randomise(inputs, rng);
+        // Zero inputs take FixedEngine's skip for MAC and SHIFT.
+        for (size_t i = 0; i < inputs.size(); i += 3) {
+            inputs[i] &= static_cast<uint8_t>(~((1u << DATA_WIDTH) - 1));
+        }
+        for (cim::Mode mode : MODES) {
+            engine.gemm(mode, inputs.data(), batch, expected.data());
+            fixed.gemm(mode, inputs.data(), batch, outputs.data());
+            bool same = expected == outputs;
+            for (size_t i = 0; i < batch; i++) {
+                std::vector<int32_t> scalar = reference(engine, mode, &inputs[i * ROWS]);
+                same = same && std::equal(scalar.begin(), scalar.end(), &outputs[i * COLS]);
+            }
+            if (!same) {
+                std::printf("[Test] fixed %ux%u data %u compute %u mode %d round %d\n", ROWS, COLS, DATA_WIDTH,
+                            COMPUTE_WIDTH, static_cast<int>(mode), round);
+            }
+            expect(same, "FixedEngine matches Engine");
+        }
+    }
+}
+
+// Sizes with partial enable bytes, data widths on both sides of SHIFT's
+// 4-bit limit, and compute widths narrow enough to wrap.
+void fixed_engines(std::mt19937& rng) {
+    fixed_engine<8, 8, 8, 16>(rng);
+    fixed_engine<16, 16, 1, 32>(rng);
+    fixed_engine<64, 64, 4, 16>(rng);
+    fixed_engine<70, 9, 3, 6>(rng);
+    fixed_engine<33, 130, 5, 9>(rng);
+    fixed_engine<130, 33, 8, 4>(rng);
+    fixed_engine<9, 70, 2, 32>(rng);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(7);
+    bit_planes(rng);
+    incremental_sums(rng);
+    memo(rng);
+    fixed_engines(rng);
+
+    std::printf("[Test] cim_engine: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+#ifndef CIM_FIXED_ENGINE_H
+#define CIM_FIXED_ENGINE_H
+
+#include "rtl/memory/engine/cim_engine.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// cim::Engine with the geometry and precision fixed at compile time. The
+// instantiations for generated arrays come from cell_array.h.jinja2, with
+// the same parameters as the matching cell_array Verilog, so the two
+// cannot drift apart.
+//
+// Semantics are identical to Engine. Column sums accumulate in 32-bit
+// modular arithmetic. COMPUTE_WIDTH is at most 32, so the wrap to it gives
+// the same result as a 64-bit sum would. That keeps the inner loops
+// uniform-width, so they vectorise, and every trip count is a constant.
+namespace cim {
+
+template <unsigned int ROWS, unsigned int COLS, unsigned int DATA_WIDTH = 8,
+          unsigned int COMPUTE_WIDTH = 16>
+class FixedEngine {
+    static_assert(ROWS > 0 && COLS > 0, "cim::FixedEngine: empty array");
+    static_assert(DATA_WIDTH >= 1 && DATA_WIDTH <= 8 && COMPUTE_WIDTH >= 1 && COMPUTE_WIDTH <= 32,
+                  "cim::FixedEngine: unsupported precision");
+
+public:
+    static constexpr unsigned int rows() { return ROWS; }
+    static constexpr unsigned int cols() { return COLS; }
+    static constexpr Precision precision() { return Precision{DATA_WIDTH, COMPUTE_WIDTH}; }
+    static constexpr size_t weight_bytes() { return static_cast<size_t>(ROWS) * COLS; }
+    static constexpr size_t row_enable_bytes() { return (ROWS + 7) / 8; }
+    static constexpr size_t col_enable_bytes() { return (COLS + 7) / 8; }
+
+    // Weights live on the heap; a 1024x1024 array is too large for a stack.
+    FixedEngine() : weight_codes(weight_bytes(), 0) {
+        row_mask.fill(0xFF);
+        col_mask.fill(0xFF);
+    }
+
+    // Same layouts as Engine.
+    uint8_t* weights() { return weight_codes.data(); }
+    const uint8_t* weights() const { return weight_codes.data(); }
+    uint8_t* row_enable() { return row_mask.data(); }
+    uint8_t* col_enable() { return col_mask.data(); }
+
+    void gemv(Mode mode, const uint8_t* input, int32_t* output) const {
+        switch (mode) {
+            case Mode::MAC:
+                compute<Mode::MAC>(input, output);
+                break;
+            case Mode::ADD:
+                compute<Mode::ADD>(input, output);
+                break;
+            case Mode::SHIFT:
+                compute<Mode::SHIFT>(input, output);
+                break;
+            case Mode::XOR:
+            default:
+                compute<Mode::XOR>(input, output);
+                break;
+        }
+    }
+
+    void gemm(Mode mode, const uint8_t* inputs, size_t count, int32_t* outputs) const {
+        for (size_t i = 0; i < count; ++i) {
+            gemv(mode, inputs + i * ROWS, outputs + i * COLS);
+        }
+    }
+
+    static constexpr int32_t sign_extend(uint8_t code) {
+        return static_cast<int32_t>(static_cast<uint32_t>(code) << (32 - DATA_WIDTH)) >> (32 - DATA_WIDTH);
+    }
+
+    static constexpr int32_t wrap(int64_t sum) {
+        return static_cast<int32_t>(static_cast<uint32_t>(sum) << (32 - COMPUTE_WIDTH)) >> (32 - COMPUTE_WIDTH);
+    }
+
+private:
+    static constexpr uint32_t DATA_MASK = (1u << DATA_WIDTH) - 1;
+
+    // M is a template argument, so the switch folds away.
+    template <Mode M>
+    static uint32_t cell(uint8_t w, uint8_t x) {
+        switch (M) {
+            case Mode::MAC:
+                return static_cast<uint32_t>(sign_extend(w) * sign_extend(x));
+            case Mode::ADD:
+                return static_cast<uint32_t>(sign_extend(w) + sign_extend(x));
+            case Mode::SHIFT:
+                return (w & DATA_MASK) * (x & DATA_MASK);
+            case Mode::XOR:
+            default:
+                return (w ^ x) & DATA_MASK;
+        }
+    }
+
+    template <Mode M>
+    void compute(const uint8_t* input, int32_t* output) const {
+        std::array<uint32_t, COLS> sums{};
+
+        for (unsigned int r = 0; r < ROWS; r++) {
+            if (!(row_mask[r / 8] & (1u << (r % 8)))) {
+                continue;
+            }
+            uint8_t x = input[r];
+            // A zero input contributes nothing to a product.
+            if ((M == Mode::MAC || M == Mode::SHIFT) && (x & DATA_MASK) == 0) {
+                continue;
+            }
+            const uint8_t* w = &weight_codes[static_cast<size_t>(r) * COLS];
+            for (unsigned int c = 0; c < COLS; c++) {
+                sums[c] += cell<M>(w[c], x);
+            }
+        }
+
+        for (unsigned int c = 0; c < COLS; c++) {
+            output[c] = (col_mask[c / 8] & (1u << (c % 8))) ? wrap(sums[c]) : 0;
+        }
+    }
+
+    std::vector<uint8_t> weight_codes;
+    std::array<uint8_t, (ROWS + 7) / 8> row_mask;
+    std::array<uint8_t, (COLS + 7) / 8> col_mask;
+};
+
+template <unsigned int ROWS, unsigned int COLS, unsigned int DATA_WIDTH, unsigned int COMPUTE_WIDTH>
+constexpr uint32_t FixedEngine<ROWS, COLS, DATA_WIDTH, COMPUTE_WIDTH>::DATA_MASK;
+
+} // namespace cim
+
+#endif
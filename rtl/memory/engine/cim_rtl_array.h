@@ -0,0 +1,32 @@
+#ifndef CIM_RTL_ARRAY_H
+#define CIM_RTL_ARRAY_H
+
+#include <cstdint>
+#include "rtl/memory/engine/cim_engine.h"
+
+// A cycle-accurate implementation of the array, such as the Verilated
+// cell_array (verilated_array.h), that MemoryWrapper can hand computes to
+// for a window of interest. Engine stays the owner of the cell contents.
+// load() copies them in whenever the RTL is stale, and each compute's
+// column sums come back through gemv().
+namespace cim {
+
+class RtlArray {
+public:
+    virtual ~RtlArray() {}
+
+    // Transfers the weights and enable bitmaps of `state` into the RTL and
+    // resets its accumulators.
+    virtual void load(const Engine& state) = 0;
+
+    // One compute with the semantics of Engine::gemv(). Returns false,
+    // without touching `output`, for a mode the RTL cannot run.
+    virtual bool gemv(Mode mode, const uint8_t* input, int32_t* output) = 0;
+
+    // Clock cycles simulated so far.
+    virtual uint64_t cycles() const = 0;
+};
+
+} // namespace cim
+
+#endif
@@ -0,0 +1,195 @@
+#ifndef VERILATED_ARRAY_H
+#define VERILATED_ARRAY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "verilated.h"
+#include "rtl/memory/engine/cim_rtl_array.h"
+
+// RtlArray over a Verilated cell_array_RxC (rtl_verilate in
+// tools/rtl/rtl_rules.bzl), e.g. VerilatedArray<Vcell_array_64x64>.
+//
+// The RTL has no input-vector port: a row's word line is either on or
+// off. Inputs are therefore applied bit-serially. Plane b drives
+// row_enable with bit b of every input, and the column results of the
+// planes are shifted and added in the digital periphery. The top plane
+// of a MAC is subtracted, because its inputs are two's complement. With
+// its word line on, a MAC cell contributes its signed weight and a SHIFT
+// cell its unsigned weight (cells/imc_cell_base.v), so only MAC and SHIFT
+// map onto the array. Each plane costs two cycles, one to accumulate and
+// one for compute_valid.
+//
+// Accumulator state: every compute overwrites the col_sum registers, and
+// the plane sums live here only for the duration of one gemv(). load()
+// pulses rst_n before writing the cells, so col_sum and compute_valid
+// start from zero rather than from whatever an earlier window left.
+namespace cim {
+
+namespace verilated_port {
+
+template <typename T>
+void set_bit(T& port, size_t bit, bool value) {
+    T mask = static_cast<T>(T(1) << bit);
+    port = value ? static_cast<T>(port | mask) : static_cast<T>(port & ~mask);
+}
+
+template <std::size_t N>
+void set_bit(VlWide<N>& port, size_t bit, bool value) {
+    EData mask = EData(1) << (bit % VL_EDATASIZE);
+    EData& word = port[bit / VL_EDATASIZE];
+    word = value ? (word | mask) : (word & ~mask);
+}
+
+template <typename T>
+bool get_bit(const T& port, size_t bit) {
+    return (port >> bit) & 1;
+}
+
+template <std::size_t N>
+bool get_bit(const VlWide<N>& port, size_t bit) {
+    return (port[bit / VL_EDATASIZE] >> (bit % VL_EDATASIZE)) & 1;
+}
+
+} // namespace verilated_port
+
+template <class V>
+class VerilatedArray : public RtlArray {
+public:
+    // rows, cols and precision must match the Verilated module; throws
+    // std::invalid_argument if its ports are too narrow for them.
+    VerilatedArray(unsigned int rows, unsigned int cols, Precision precision = Precision())
+        : top(new V), num_rows(rows), num_cols(cols), prec(precision), cycle_count(0),
+          row_mask((rows + 7) / 8, 0xFF), col_mask((cols + 7) / 8, 0xFF), sums(cols, 0) {
+        if (sizeof(top->row_enable) * 8 < rows || sizeof(top->col_enable) * 8 < cols ||
+            sizeof(top->write_data) * 8 < static_cast<size_t>(rows) * cols * precision.data_width ||
+            sizeof(top->compute_results) * 8 < static_cast<size_t>(cols) * precision.compute_width) {
+            throw std::invalid_argument("cim::VerilatedArray: geometry does not match the RTL");
+        }
+
+        top->clk = 0;
+        top->rst_n = 0;
+        top->write_enable = 0;
+        top->compute_enable = 0;
+        top->compute_mode = 0;
+        top->power_gate_enable = 0;
+        top->power_domain = 0;
+        tick();
+        top->rst_n = 1;
+        tick();
+    }
+
+    ~VerilatedArray() {
+        top->final();
+    }
+
+    // The Verilated model itself, for tracing and probing internal signals.
+    V& model() { return *top; }
+
+    void load(const Engine& state) override {
+        if (state.rows() != num_rows || state.cols() != num_cols ||
+            state.precision().data_width != prec.data_width ||
+            state.precision().compute_width != prec.compute_width) {
+            throw std::invalid_argument("cim::VerilatedArray: state does not match the RTL");
+        }
+
+        // Clears col_sum and compute_valid; the cells are rewritten below.
+        top->rst_n = 0;
+        tick();
+        top->rst_n = 1;
+        tick();
+
+        const uint8_t* weights = state.weights();
+        for (size_t cell = 0; cell < state.weight_bytes(); cell++) {
+            for (unsigned int i = 0; i < prec.data_width; i++) {
+                verilated_port::set_bit(top->write_data, cell * prec.data_width + i, (weights[cell] >> i) & 1);
+            }
+        }
+        // Every cell takes its write, whatever the enables hold afterwards.
+        drive_enables(nullptr, 0);
+        top->write_enable = 1;
+        tick();
+        top->write_enable = 0;
+
+        std::copy(state.row_enable(), state.row_enable() + row_mask.size(), row_mask.begin());
+        std::copy(state.col_enable(), state.col_enable() + col_mask.size(), col_mask.begin());
+    }
+
+    bool gemv(Mode mode, const uint8_t* input, int32_t* output) override {
+        if (mode != Mode::MAC && mode != Mode::SHIFT) {
+            return false;
+        }
+
+        std::fill(sums.begin(), sums.end(), 0);
+        top->compute_mode = static_cast<uint8_t>(mode);
+        for (unsigned int b = 0; b < prec.data_width; b++) {
+            drive_enables(input, b);
+            top->compute_enable = 1;
+            tick();
+            top->compute_enable = 0;
+            tick();
+
+            bool negative = mode == Mode::MAC && b == prec.data_width - 1;
+            for (unsigned int c = 0; c < num_cols; c++) {
+                uint32_t plane = column_result(c) << b;
+                sums[c] += negative ? 0u - plane : plane;
+            }
+        }
+
+        unsigned int shift = 32 - prec.compute_width;
+        for (unsigned int c = 0; c < num_cols; c++) {
+            output[c] = enabled(col_mask, c) ? static_cast<int32_t>(sums[c] << shift) >> shift : 0;
+        }
+        return true;
+    }
+
+    uint64_t cycles() const override { return cycle_count; }
+
+private:
+    static bool enabled(const std::vector<uint8_t>& mask, unsigned int i) {
+        return mask[i / 8] & (1u << (i % 8));
+    }
+
+    void tick() {
+        top->clk = 0;
+        top->eval();
+        top->clk = 1;
+        top->eval();
+        cycle_count++;
+    }
+
+    // Word lines for bit `bit` of `input`, or all lines on without one.
+    void drive_enables(const uint8_t* input, unsigned int bit) {
+        for (unsigned int r = 0; r < num_rows; r++) {
+            bool on = !input || (enabled(row_mask, r) && ((input[r] >> bit) & 1));
+            verilated_port::set_bit(top->row_enable, r, on);
+        }
+        for (unsigned int c = 0; c < num_cols; c++) {
+            verilated_port::set_bit(top->col_enable, c, !input || enabled(col_mask, c));
+        }
+    }
+
+    uint32_t column_result(unsigned int c) const {
+        uint32_t value = 0;
+        for (unsigned int i = 0; i < prec.compute_width; i++) {
+            value |= uint32_t(verilated_port::get_bit(top->compute_results, c * prec.compute_width + i)) << i;
+        }
+        return value;
+    }
+
+    std::unique_ptr<V> top;
+    unsigned int num_rows;
+    unsigned int num_cols;
+    Precision prec;
+    uint64_t cycle_count;
+    std::vector<uint8_t> row_mask;
+    std::vector<uint8_t> col_mask;
+    std::vector<uint32_t> sums;
+};
+
+} // namespace cim
+
+#endif
@@ -0,0 +1,120 @@
+#include "rust_bindings/memory_interface.h"
+#include "rtl/memory/systemc/memory_wrapper.h"
+#include <tlm_utils/simple_initiator_socket.h>
+
+namespace {
+
+const unsigned int BRIDGE_BUSWIDTH = 128;
+
+uint8_t to_status(tlm::tlm_response_status status) {
+    switch (status) {
+        case tlm::TLM_OK_RESPONSE:
+            return MEMIF_OK;
+        case tlm::TLM_INCOMPLETE_RESPONSE:
+            return MEMIF_INCOMPLETE;
+        case tlm::TLM_ADDRESS_ERROR_RESPONSE:
+            return MEMIF_ADDRESS_ERROR;
+        case tlm::TLM_COMMAND_ERROR_RESPONSE:
+            return MEMIF_COMMAND_ERROR;
+        case tlm::TLM_BURST_ERROR_RESPONSE:
+            return MEMIF_BURST_ERROR;
+        default:
+            return MEMIF_GENERIC_ERROR;
+    }
+}
+
+bool system_created = false;
+
+} // namespace
+
+// Initiator side of the bridge. One payload is reused for every request;
+// only the fields a request sets are rewritten.
+struct MemIfSystem : public sc_core::sc_module {
+    tlm_utils::simple_initiator_socket<MemIfSystem, BRIDGE_BUSWIDTH> socket;
+    MemoryWrapper<BRIDGE_BUSWIDTH> array;
+    tlm::tlm_generic_payload trans;
+    sc_core::sc_time local_time;
+    uint64_t transactions;
+
+    SC_HAS_PROCESS(MemIfSystem);
+    MemIfSystem(sc_core::sc_module_name name, uint32_t rows, uint32_t cols, uint32_t data_width,
+                uint32_t compute_width)
+        : sc_core::sc_module(name), socket("socket"),
+          array("array", rows, cols, data_width, compute_width), local_time(sc_core::SC_ZERO_TIME),
+          transactions(0) {
+        socket.bind(array.socket);
+        // Requests never use DMI, so the planes cost nothing extra here.
+        array.use_bit_planes(true);
+        trans.set_byte_enable_ptr(nullptr);
+        trans.set_byte_enable_length(0);
+    }
+
+    size_t submit(MemIfRequest* requests, size_t count) {
+        size_t done = 0;
+        for (; done < count; ++done) {
+            MemIfRequest& request = requests[done];
+            trans.set_command(request.is_write ? tlm::TLM_WRITE_COMMAND : tlm::TLM_READ_COMMAND);
+            trans.set_address(request.addr);
+            trans.set_data_ptr(request.data);
+            trans.set_data_length(request.len);
+            trans.set_streaming_width(request.len);
+            trans.set_dmi_allowed(false);
+            trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+            socket->b_transport(trans, local_time);
+            request.status = to_status(trans.get_response_status());
+            if (request.status != MEMIF_OK) {
+                break;
+            }
+            transactions++;
+        }
+
+        if (local_time > sc_core::SC_ZERO_TIME) {
+            sc_core::sc_start(local_time);
+            local_time = sc_core::SC_ZERO_TIME;
+        }
+        return done;
+    }
+};
+
+extern "C" MemIfSystem* memif_create(uint32_t rows, uint32_t cols, uint32_t data_width,
+                                     uint32_t compute_width) {
+    // Everything the wrapper would otherwise assert or cim::Engine throw.
+    if (system_created || data_width < 1 || data_width > 8 || compute_width < 1 || compute_width > 32 ||
+        !MemoryWrapper<BRIDGE_BUSWIDTH>::fits(rows, cols)) {
+        return nullptr;
+    }
+    system_created = true;
+
+    MemIfSystem* system = new MemIfSystem("memif", rows, cols, data_width, compute_width);
+    sc_core::sc_start(sc_core::SC_ZERO_TIME);
+    return system;
+}
+
+extern "C" void memif_destroy(MemIfSystem* system) {
+    if (!system) {
+        return;
+    }
+    if (sc_core::sc_get_status() != sc_core::SC_STOPPED) {
+        sc_core::sc_stop();
+    }
+    // SystemC modules cannot be destroyed once elaborated, so `system` is
+    // reclaimed at process exit.
+}
+
+extern "C" size_t memif_submit(MemIfSystem* system, MemIfRequest* requests, size_t count) {
+    return system->submit(requests, count);
+}
+
+extern "C" uint64_t memif_region_size(const MemIfSystem* system) {
+    return system->array.region_size();
+}
+
+extern "C" uint64_t memif_sim_time_ps(const MemIfSystem* system) {
+    sc_core::sc_time now = sc_core::sc_time_stamp() + system->local_time;
+    return static_cast<uint64_t>(now / sc_core::sc_time(1, sc_core::SC_PS));
+}
+
+extern "C" uint64_t memif_transactions(const MemIfSystem* system) {
+    return system->transactions;
+}
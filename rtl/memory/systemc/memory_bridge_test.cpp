@@ -0,0 +1,56 @@
+// memif_create must refuse every geometry or precision the wrapper cannot
+// hold, returning NULL rather than asserting or overrunning a window,
+// and then create exactly one system.
+
+#include <cstdint>
+#include <cstdio>
+#include "rust_bindings/memory_interface.h"
+
+namespace {
+
+int failures = 0;
+
+void expect(bool ok, const char* what) {
+    if (!ok) {
+        std::printf("[Test] FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+} // namespace
+
+int main() {
+    struct Bad {
+        uint32_t rows, cols, data_width, compute_width;
+        const char* what;
+    };
+    const Bad bad[] = {
+        {0, 16, 8, 16, "no rows"},
+        {16, 0, 8, 16, "no columns"},
+        {16, 16, 0, 16, "data width 0"},
+        {16, 16, 9, 16, "data width 9"},
+        {16, 16, 8, 0, "compute width 0"},
+        {16, 16, 8, 33, "compute width 33"},
+        {0x8001, 1, 8, 16, "row enables past their window"},
+        {0x10000, 1, 8, 16, "rows at the old input limit"},
+        {0x10001, 1, 8, 16, "inputs past their window"},
+        {1, 0x38001, 8, 16, "results past their window"},
+        {1, 0x40000000, 8, 16, "cols * 4 wraps to 0 in 32 bits"},
+        {1, 0xC0000000, 8, 16, "cols * 4 wraps below the limit"},
+        {0x8000, 0x38000, 8, 16, "weights past 32-bit addresses"},
+    };
+    for (const Bad& b : bad) {
+        expect(memif_create(b.rows, b.cols, b.data_width, b.compute_width) == nullptr, b.what);
+    }
+
+    MemIfSystem* system = memif_create(16, 16, 8, 16);
+    expect(system != nullptr, "a valid geometry after refused ones");
+    expect(memif_create(16, 16, 8, 16) == nullptr, "only one system per process");
+    if (system) {
+        expect(memif_region_size(system) > 0x100000, "region covers the weights");
+        memif_destroy(system);
+    }
+
+    std::printf("[Test] memory_bridge: %d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,419 @@
+#include "rtl/memory/systemc/memory_wrapper.h"
+#include "systemc/tlm_data_path.h"
+#include <algorithm>
+#include <cstring>
+
+template <unsigned int BUSWIDTH>
+MemoryWrapper<BUSWIDTH>::MemoryWrapper(sc_core::sc_module_name name, unsigned int rows,
+                                       unsigned int cols, unsigned int data_width,
+                                       unsigned int compute_width, sc_core::sc_time clock_period)
+    : sc_core::sc_module(name), socket("socket"),
+      engine(rows, cols, cim::Precision{data_width, compute_width}), clock_period(clock_period),
+      control_register(0), status_register(0), compute_count(0), compute_cycles(1), rtl(nullptr), checker(nullptr),
+      active_backend(BACKEND_MODEL), rtl_stale(true), rtl_fallback_reported(false),
+      shadow_ready(sc_core::SC_ZERO_TIME), swap_count(0), swap_stall_cycles(0), inputs(rows, 0),
+      results(cols * 4, 0), column_sums(cols, 0) {
+    sc_assert(fits(rows, cols));
+
+    socket.register_b_transport(this, &MemoryWrapper::b_transport);
+    socket.register_get_direct_mem_ptr(this, &MemoryWrapper::get_direct_mem_ptr);
+    socket.register_transport_dbg(this, &MemoryWrapper::transport_dbg);
+}
+
+template <unsigned int BUSWIDTH>
+bool MemoryWrapper<BUSWIDTH>::fits(uint64_t rows, uint64_t cols) {
+    if (rows == 0 || cols == 0 || (rows + 7) / 8 > COL_ENABLE_BASE - ROW_ENABLE_BASE ||
+        (cols + 7) / 8 > INPUT_BASE - COL_ENABLE_BASE || rows > RESULT_BASE - INPUT_BASE ||
+        cols * 4 > WEIGHT_BASE - RESULT_BASE) {
+        return false;
+    }
+    // The shadow bank sits at shadow_base(), and both banks must stay
+    // within the 32-bit window bases.
+    uint64_t bytes = rows * cols;
+    uint64_t span = 1;
+    while (span < bytes) {
+        span <<= 1;
+    }
+    return WEIGHT_BASE + span + bytes <= (uint64_t(1) << 32);
+}
+
+template <unsigned int BUSWIDTH>
+void MemoryWrapper<BUSWIDTH>::b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+    sc_dt::uint64 addr = trans.get_address();
+    unsigned int len = trans.get_data_length();
+    unsigned int beat_bytes = BUSWIDTH / 8;
+
+    if (addr < ROW_ENABLE_BASE) {
+        if (!access_register(trans, addr, delay)) {
+            return;
+        }
+        // A compute completes one cycle after it is issued, as compute_valid,
+        // or after however many cycles the RTL took.
+        if (trans.is_write() && (control_register & CTRL_COMPUTE)) {
+            control_register &= ~CTRL_COMPUTE;
+            delay += clock_period * compute_cycles;
+        }
+        trans.set_response_status(tlm::TLM_OK_RESPONSE);
+        delay += clock_period;
+        return;
+    }
+
+    Window window;
+    if (!find_window(addr, len, window)) {
+        trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+        return;
+    }
+    if (trans.is_write() && !window.writable) {
+        trans.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
+        return;
+    }
+
+    unsigned char* mem = window.data + (addr - window.base);
+    unsigned char* ptr = trans.get_data_ptr();
+    const unsigned char* be = trans.get_byte_enable_ptr();
+    unsigned int be_len = trans.get_byte_enable_length();
+
+    if (trans.is_read() || trans.is_write()) {
+        unsigned char* dst = trans.is_read() ? ptr : mem;
+        const unsigned char* src = trans.is_read() ? mem : ptr;
+        if (be && be_len) {
+            for (unsigned int i = 0; i < len; i++) {
+                if (be[i % be_len] == tlm::TLM_BYTE_ENABLED) {
+                    dst[i] = src[i];
+                }
+            }
+        } else {
+            std::memcpy(dst, src, len);
+        }
+    }
+    if (trans.is_write() && holds_cells(window)) {
+        rtl_stale = true;
+        if (window.base == WEIGHT_BASE) {
+            engine.weights_changed(addr - window.base, len);
+        }
+    }
+    if (trans.is_write() && window.base == shadow_base()) {
+        // One row per clock into the shadow bank, behind any load in progress
+        sc_dt::uint64 offset = addr - window.base;
+        sc_dt::uint64 rows_touched = (offset + len - 1) / engine.cols() - offset / engine.cols() + 1;
+        shadow_ready = std::max(shadow_ready, sc_core::sc_time_stamp() + delay) +
+                       clock_period * static_cast<double>(rows_touched);
+    }
+
+    // A tracked weight write would only be offered a read-only pointer.
+    bool tracked_write = trans.is_write() && window.base == WEIGHT_BASE && engine.tracks_writes();
+    trans.set_dmi_allowed(!(active_backend == BACKEND_RTL && holds_cells(window)) && !tracked_write);
+    trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    delay += clock_period * ((len + beat_bytes - 1) / beat_bytes);
+}
+
+template <unsigned int BUSWIDTH>
+bool MemoryWrapper<BUSWIDTH>::access_register(tlm::tlm_generic_payload& trans, uint32_t offset,
+                                              sc_core::sc_time& delay) {
+    unsigned char* ptr = trans.get_data_ptr();
+
+    if (trans.get_data_length() != 4 || (offset & 0x3)) {
+        trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
+        return false;
+    }
+
+    if (trans.is_read()) {
+        uint32_t value;
+        switch (offset) {
+            case CTRL_REG_OFFSET:
+                value = control_register;
+                break;
+            case STATUS_REG_OFFSET:
+                value = status_register;
+                if (shadow_ready > sc_core::sc_time_stamp() + delay) {
+                    value |= STATUS_SHADOW_BUSY;
+                }
+                break;
+            case ROWS_REG_OFFSET:
+                value = engine.rows();
+                break;
+            case COLS_REG_OFFSET:
+                value = engine.cols();
+                break;
+            case DATA_WIDTH_REG_OFFSET:
+                value = engine.precision().data_width;
+                break;
+            case COMPUTE_WIDTH_REG_OFFSET:
+                value = engine.precision().compute_width;
+                break;
+            case COMPUTE_COUNT_REG_OFFSET:
+                value = compute_count;
+                break;
+            case BACKEND_REG_OFFSET:
+                value = active_backend;
+                break;
+            case SWAP_COUNT_REG_OFFSET:
+                value = swap_count;
+                break;
+            case SWAP_STALL_REG_OFFSET:
+                value = swap_stall_cycles;
+                break;
+            case SHADOW_BASE_REG_OFFSET:
+                value = static_cast<uint32_t>(shadow_base());
+                break;
+            case MEMO_ENTRIES_REG_OFFSET:
+                value = static_cast<uint32_t>(engine.memo());
+                break;
+            case MEMO_HITS_REG_OFFSET:
+                value = static_cast<uint32_t>(engine.stats().memo_hits);
+                break;
+            case MEMO_MISSES_REG_OFFSET:
+                value = static_cast<uint32_t>(engine.stats().memo_misses);
+                break;
+            default:
+                trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+                return false;
+        }
+        tlm_data_path::store_le<uint32_t>(ptr, value);
+    } else if (trans.is_write()) {
+        uint32_t value = tlm_data_path::load_le<uint32_t>(ptr);
+        switch (offset) {
+            case CTRL_REG_OFFSET:
+                control_register = value;
+                compute_cycles = 1;
+                if (control_register & CTRL_SWAP) {
+                    control_register &= ~CTRL_SWAP;
+                    delay += swap_banks(delay);
+                }
+                if ((control_register & CTRL_COMPUTE) && !(control_register & CTRL_POWER_GATE)) {
+                    compute(static_cast<ComputeMode>((control_register & CTRL_MODE_MASK) >> CTRL_MODE_SHIFT));
+                    status_register |= STATUS_VALID;
+                    compute_count++;
+                }
+                break;
+            case BACKEND_REG_OFFSET:
+                if (value > BACKEND_RTL || !select_backend(static_cast<Backend>(value))) {
+                    trans.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
+                    return false;
+                }
+                break;
+            case MEMO_ENTRIES_REG_OFFSET:
+                use_memo(value);
+                break;
+            default:
+                trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+                return false;
+        }
+    }
+    return true;
+}
+
+template <unsigned int BUSWIDTH>
+bool MemoryWrapper<BUSWIDTH>::find_window(sc_dt::uint64 addr, unsigned int len, Window& window) {
+    // The shadow bank is allocated on first use.
+    sc_dt::uint64 shadow = shadow_base();
+    if (addr >= shadow && shadow_weights.empty()) {
+        shadow_weights.assign(engine.weight_bytes(), 0);
+    }
+
+    const Window windows[] = {
+        {ROW_ENABLE_BASE, engine.row_enable(), engine.row_enable_bytes(), true},
+        {COL_ENABLE_BASE, engine.col_enable(), engine.col_enable_bytes(), true},
+        {INPUT_BASE, inputs.data(), inputs.size(), true},
+        {RESULT_BASE, results.data(), results.size(), false},
+        {WEIGHT_BASE, engine.weights(), engine.weight_bytes(), true},
+        {static_cast<uint32_t>(shadow), shadow_weights.data(), shadow_weights.size(), true},
+    };
+
+    for (const Window& w : windows) {
+        if (addr >= w.base && addr - w.base < w.size && len <= w.size - (addr - w.base)) {
+            window = w;
+            if (w.base == shadow) {
+                finish_shadow_load();
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+template <unsigned int BUSWIDTH>
+sc_dt::uint64 MemoryWrapper<BUSWIDTH>::shadow_base() const {
+    sc_dt::uint64 span = 1;
+    while (span < engine.weight_bytes()) {
+        span <<= 1;
+    }
+    return WEIGHT_BASE + span;
+}
+
+template <unsigned int BUSWIDTH>
+void MemoryWrapper<BUSWIDTH>::load_shadow_async(const uint8_t* weights) {
+    finish_shadow_load();
+    size_t bytes = engine.weight_bytes();
+    if (shadow_weights.empty()) {
+        shadow_weights.assign(bytes, 0);
+    }
+    // No DMI writer may race the helper.
+    socket->invalidate_direct_mem_ptr(shadow_base(), shadow_base() + bytes - 1);
+
+    uint8_t* bank = shadow_weights.data();
+    shadow_load = std::async(std::launch::async, [bank, weights, bytes] { std::memcpy(bank, weights, bytes); });
+    shadow_ready = std::max(shadow_ready, sc_core::sc_time_stamp()) + clock_period * static_cast<double>(engine.rows());
+}
+
+template <unsigned int BUSWIDTH>
+void MemoryWrapper<BUSWIDTH>::finish_shadow_load() {
+    if (shadow_load.valid()) {
+        shadow_load.get();
+    }
+}
+
+template <unsigned int BUSWIDTH>
+sc_core::sc_time MemoryWrapper<BUSWIDTH>::swap_banks(const sc_core::sc_time& delay) {
+    finish_shadow_load();
+    size_t bytes = engine.weight_bytes();
+    if (shadow_weights.empty()) {
+        shadow_weights.assign(bytes, 0);
+    }
+
+    sc_core::sc_time taken = clock_period;
+    sc_core::sc_time now = sc_core::sc_time_stamp() + delay;
+    if (shadow_ready > now) {
+        sc_core::sc_time stall = shadow_ready - now;
+        swap_stall_cycles += static_cast<uint32_t>(stall / clock_period);
+        taken += stall;
+    }
+
+    engine.swap_weights(shadow_weights);
+    swap_count++;
+    rtl_stale = true;
+    // Both windows now sit on the other buffer.
+    socket->invalidate_direct_mem_ptr(WEIGHT_BASE, WEIGHT_BASE + bytes - 1);
+    socket->invalidate_direct_mem_ptr(shadow_base(), shadow_base() + bytes - 1);
+    return taken;
+}
+
+template <unsigned int BUSWIDTH>
+void MemoryWrapper<BUSWIDTH>::use_bit_planes(bool enable) {
+    if (enable && !engine.tracks_writes()) {
+        socket->invalidate_direct_mem_ptr(WEIGHT_BASE, WEIGHT_BASE + engine.weight_bytes() - 1);
+    }
+    engine.set_bit_planes(enable);
+}
+
+template <unsigned int BUSWIDTH>
+void MemoryWrapper<BUSWIDTH>::use_incremental(size_t vectors) {
+    if (vectors && !engine.tracks_writes()) {
+        socket->invalidate_direct_mem_ptr(WEIGHT_BASE, WEIGHT_BASE + engine.weight_bytes() - 1);
+    }
+    engine.set_incremental(vectors);
+}
+
+template <unsigned int BUSWIDTH>
+void MemoryWrapper<BUSWIDTH>::use_memo(size_t entries) {
+    if (entries && !engine.tracks_writes()) {
+        socket->invalidate_direct_mem_ptr(WEIGHT_BASE, WEIGHT_BASE + engine.weight_bytes() - 1);
+    }
+    engine.set_memo(entries);
+}
+
+template <unsigned int BUSWIDTH>
+void MemoryWrapper<BUSWIDTH>::attach_rtl(cim::RtlArray* rtl_array) {
+    if (active_backend == BACKEND_RTL) {
+        select_backend(BACKEND_MODEL);
+    }
+    rtl = rtl_array;
+    rtl_stale = true;
+}
+
+// Entering the RTL revokes DMI to the cell state; the load itself waits
+// for the next compute, so back-to-back switches cost nothing.
+template <unsigned int BUSWIDTH>
+bool MemoryWrapper<BUSWIDTH>::select_backend(Backend backend) {
+    if (backend == BACKEND_RTL && !rtl) {
+        return false;
+    }
+    if (backend == BACKEND_RTL && active_backend != BACKEND_RTL) {
+        rtl_stale = true;
+        socket->invalidate_direct_mem_ptr(ROW_ENABLE_BASE, COL_ENABLE_BASE + engine.col_enable_bytes() - 1);
+        socket->invalidate_direct_mem_ptr(WEIGHT_BASE, WEIGHT_BASE + engine.weight_bytes() - 1);
+    }
+    active_backend = backend;
+    return true;
+}
+
+template <unsigned int BUSWIDTH>
+void MemoryWrapper<BUSWIDTH>::compute(ComputeMode mode) {
+    bool done = false;
+    if (active_backend == BACKEND_RTL) {
+        if (rtl_stale) {
+            rtl->load(engine);
+            rtl_stale = false;
+        }
+        uint64_t start = rtl->cycles();
+        done = rtl->gemv(static_cast<cim::Mode>(mode), inputs.data(), column_sums.data());
+        if (done) {
+            compute_cycles = static_cast<unsigned int>(rtl->cycles() - start);
+        } else if (!rtl_fallback_reported) {
+            SC_REPORT_WARNING("MemoryWrapper", "compute mode not supported by the RTL, running it on the model");
+            rtl_fallback_reported = true;
+        }
+    }
+    if (!done) {
+        engine.gemv(static_cast<cim::Mode>(mode), inputs.data(), column_sums.data());
+        if (checker) {
+            checker->observe(engine, static_cast<cim::Mode>(mode), inputs.data(), column_sums.data());
+        }
+    }
+    for (unsigned int c = 0; c < engine.cols(); c++) {
+        tlm_data_path::store_le<uint32_t>(&results[c * 4], static_cast<uint32_t>(column_sums[c]));
+    }
+}
+
+template <unsigned int BUSWIDTH>
+bool MemoryWrapper<BUSWIDTH>::get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data) {
+    Window window;
+    if (trans.get_address() < ROW_ENABLE_BASE || !find_window(trans.get_address(), 1, window)) {
+        return false;
+    }
+    if (active_backend == BACKEND_RTL && holds_cells(window)) {
+        dmi_data.set_start_address(window.base);
+        dmi_data.set_end_address(window.base + window.size - 1);
+        return false;
+    }
+
+    if (window.writable && !(window.base == WEIGHT_BASE && engine.tracks_writes())) {
+        dmi_data.allow_read_write();
+    } else {
+        dmi_data.allow_read();
+    }
+    dmi_data.set_dmi_ptr(window.data);
+    dmi_data.set_start_address(window.base);
+    dmi_data.set_end_address(window.base + window.size - 1);
+    dmi_data.set_read_latency(clock_period);
+    dmi_data.set_write_latency(clock_period);
+    return true;
+}
+
+template <unsigned int BUSWIDTH>
+unsigned int MemoryWrapper<BUSWIDTH>::transport_dbg(tlm::tlm_generic_payload& trans) {
+    Window window;
+    sc_dt::uint64 addr = trans.get_address();
+    unsigned int len = trans.get_data_length();
+    if (addr < ROW_ENABLE_BASE || !find_window(addr, len, window)) {
+        return 0;
+    }
+
+    unsigned char* mem = window.data + (addr - window.base);
+    if (trans.is_read()) {
+        std::memcpy(trans.get_data_ptr(), mem, len);
+    } else if (trans.is_write() && window.writable) {
+        std::memcpy(mem, trans.get_data_ptr(), len);
+        rtl_stale = rtl_stale || holds_cells(window);
+        if (window.base == WEIGHT_BASE) {
+            engine.weights_changed(addr - window.base, len);
+        }
+    }
+    return len;
+}
+
+template class MemoryWrapper<32>;
+template class MemoryWrapper<64>;
+template class MemoryWrapper<128>;
+template class MemoryWrapper<256>;
+template class MemoryWrapper<512>;
@@ -0,0 +1,201 @@
+#ifndef MEMORY_WRAPPER_H
+#define MEMORY_WRAPPER_H
+
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_target_socket.h>
+#include <cstdint>
+#include <future>
+#include <vector>
+#include "rtl/memory/engine/cim_engine.h"
+#include "rtl/memory/engine/cim_checker.h"
+#include "rtl/memory/engine/cim_rtl_array.h"
+
+// Transaction-level model of the generated cell_array (see
+// tools/rtl/templates/cell_array.v.jinja2): a TLM adapter over
+// cim::Engine, which defines the compute semantics. The mode field selects
+// MAC (00), ADD (01), SHIFT (10) or XOR (11). With every input set to 1,
+// MAC reduces to the RTL behaviour, where the row enables act as binary
+// word-line inputs.
+//
+// Register map (offsets from the socket base):
+//   0x0000  CTRL           [0] COMPUTE (self clearing), [2:1] mode,
+//                          [3] POWER_GATE (computes are dropped),
+//                          [4] SWAP (self clearing, before a COMPUTE)
+//   0x0004  STATUS         [0] compute valid, [1] shadow bank loading
+//   0x0008  ROWS, 0x000C COLS, 0x0010 DATA_WIDTH, 0x0014 COMPUTE_WIDTH (ro)
+//   0x0018  COMPUTE_COUNT  (ro)
+//   0x001C  BACKEND        0 model, 1 RTL (command error without attach_rtl)
+//   0x0020  SWAP_COUNT     (ro)
+//   0x0024  SWAP_STALL     cycles SWAPs waited for the shadow bank (ro)
+//   0x0028  SHADOW_BASE    (ro) see below
+//   0x002C  MEMO_ENTRIES   result memo capacity, 0 off (see cim_engine.h)
+//   0x0030  MEMO_HITS, 0x0034 MEMO_MISSES (ro)
+//   0x1000  row enable bitmap     (rows / 8 bytes, reset all ones)
+//   0x2000  column enable bitmap  (cols / 8 bytes, reset all ones)
+//   0x10000 input vector          (rows bytes, signed)
+//   0x20000 results               (cols x 32-bit, sign extended, ro)
+//   0x100000 weights              (rows x cols bytes, row major)
+//   SHADOW_BASE shadow weights     (same layout; WEIGHT_BASE plus the
+//                                   weight size rounded up to a power of 2)
+//
+// The input and weight windows grant read/write DMI, the result window
+// read-only DMI.
+//
+// Computes normally run on cim::Engine. With an RtlArray attached, they
+// can switch to it for a window of interest and back, from C++ or through
+// BACKEND. Engine keeps the cell contents either way. The RTL is loaded
+// from it on the first compute after a switch or after any weight or
+// enable write. Column sums land in the result window from whichever
+// backend ran. While the RTL is active, DMI to the weight and enable
+// windows is revoked, so every write to them is seen. A compute then takes
+// as many clock periods as the RTL simulated.
+//
+// Double buffering: the shadow bank loads while the active bank computes,
+// and SWAP exchanges the two. The array writes one row per clock, so a
+// shadow write is busy for one clock per row it touches, on the shadow
+// bank's own timeline. A write to the active bank costs bus time only, as
+// before. SWAP waits for any shadow load still in progress, and
+// SWAP_STALL counts those cycles. load_shadow_async() fills the shadow bank
+// from a host helper thread instead of the bus.
+//
+// Separately, a cim::SampledChecker can be attached to compare a sample of
+// model computes against its own RTL instance on a worker thread.
+template <unsigned int BUSWIDTH = 32>
+class MemoryWrapper : public sc_core::sc_module {
+public:
+    tlm_utils::simple_target_socket<MemoryWrapper, BUSWIDTH> socket;
+
+    enum ComputeMode {
+        MODE_MAC = 0,
+        MODE_ADD = 1,
+        MODE_SHIFT = 2,
+        MODE_XOR = 3
+    };
+
+    enum Backend {
+        BACKEND_MODEL = 0,
+        BACKEND_RTL = 1
+    };
+
+    SC_HAS_PROCESS(MemoryWrapper);
+    MemoryWrapper(sc_core::sc_module_name name, unsigned int rows, unsigned int cols,
+                  unsigned int data_width = 8, unsigned int compute_width = 16,
+                  sc_core::sc_time clock_period = sc_core::sc_time(1, sc_core::SC_NS));
+
+    // True if every window of a rows x cols array fits the register map,
+    // which the constructor asserts. cim::Engine checks the precision.
+    static bool fits(uint64_t rows, uint64_t cols);
+
+    virtual void b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
+    virtual bool get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data);
+    virtual unsigned int transport_dbg(tlm::tlm_generic_payload& trans);
+
+    unsigned int rows() const { return engine.rows(); }
+    unsigned int cols() const { return engine.cols(); }
+
+    // Bytes of address space the model decodes, for Router::map().
+    sc_dt::uint64 region_size() const { return shadow_base() + engine.weight_bytes(); }
+
+    sc_dt::uint64 shadow_base() const;
+
+    // The array contents, for preloading and checking without transactions.
+    cim::Engine& array() { return engine; }
+
+    // Copies rows x cols weights into the shadow bank on a helper thread.
+    // `weights` must stay valid until the next swap or shadow access.
+    void load_shadow_async(const uint8_t* weights);
+    // SWAP from C++ at local time `delay`; returns the time it took.
+    sc_core::sc_time swap_banks(const sc_core::sc_time& delay = sc_core::SC_ZERO_TIME);
+
+    // Bit-plane weights for XOR and SHIFT (see cim_engine.h). Weight DMI is
+    // read-only while they are on, so every weight write is seen.
+    void use_bit_planes(bool enable);
+    // Incremental column sums for up to `vectors` inputs (see
+    // cim_engine.h); 0 turns them off. Weight DMI is read-only likewise.
+    void use_incremental(size_t vectors);
+    // Result memo of up to `entries` computes, also set through
+    // MEMO_ENTRIES; weight DMI is read-only while it is on.
+    void use_memo(size_t entries);
+
+    // `rtl` is not owned and must outlive the wrapper.
+    void attach_rtl(cim::RtlArray* rtl);
+    // Returns false for BACKEND_RTL without an attached RtlArray.
+    bool select_backend(Backend backend);
+    Backend backend() const { return active_backend; }
+
+    // Sees every compute the model runs; not owned.
+    void attach_checker(cim::SampledChecker* sampled_checker) { checker = sampled_checker; }
+
+    static const uint32_t CTRL_REG_OFFSET = 0x0000;
+    static const uint32_t STATUS_REG_OFFSET = 0x0004;
+    static const uint32_t ROWS_REG_OFFSET = 0x0008;
+    static const uint32_t COLS_REG_OFFSET = 0x000C;
+    static const uint32_t DATA_WIDTH_REG_OFFSET = 0x0010;
+    static const uint32_t COMPUTE_WIDTH_REG_OFFSET = 0x0014;
+    static const uint32_t COMPUTE_COUNT_REG_OFFSET = 0x0018;
+    static const uint32_t BACKEND_REG_OFFSET = 0x001C;
+    static const uint32_t SWAP_COUNT_REG_OFFSET = 0x0020;
+    static const uint32_t SWAP_STALL_REG_OFFSET = 0x0024;
+    static const uint32_t SHADOW_BASE_REG_OFFSET = 0x0028;
+    static const uint32_t MEMO_ENTRIES_REG_OFFSET = 0x002C;
+    static const uint32_t MEMO_HITS_REG_OFFSET = 0x0030;
+    static const uint32_t MEMO_MISSES_REG_OFFSET = 0x0034;
+    static const uint32_t ROW_ENABLE_BASE = 0x1000;
+    static const uint32_t COL_ENABLE_BASE = 0x2000;
+    static const uint32_t INPUT_BASE = 0x10000;
+    static const uint32_t RESULT_BASE = 0x20000;
+    static const uint32_t WEIGHT_BASE = 0x100000;
+
+    static const uint32_t CTRL_COMPUTE = 1u << 0;
+    static const uint32_t CTRL_MODE_SHIFT = 1;
+    static const uint32_t CTRL_MODE_MASK = 0x3u << CTRL_MODE_SHIFT;
+    static const uint32_t CTRL_POWER_GATE = 1u << 3;
+    static const uint32_t CTRL_SWAP = 1u << 4;
+    static const uint32_t STATUS_VALID = 1u << 0;
+    static const uint32_t STATUS_SHADOW_BUSY = 1u << 1;
+
+private:
+    // A byte-addressed window backed by a host array.
+    struct Window {
+        uint32_t base;
+        unsigned char* data;
+        sc_dt::uint64 size;
+        bool writable;
+    };
+
+    static bool holds_cells(const Window& window) {
+        return window.base == ROW_ENABLE_BASE || window.base == COL_ENABLE_BASE || window.base == WEIGHT_BASE;
+    }
+
+    bool find_window(sc_dt::uint64 addr, unsigned int len, Window& window);
+    bool access_register(tlm::tlm_generic_payload& trans, uint32_t offset, sc_core::sc_time& delay);
+    void finish_shadow_load();
+    void compute(ComputeMode mode);
+
+    cim::Engine engine;
+    sc_core::sc_time clock_period;
+
+    uint32_t control_register;
+    uint32_t status_register;
+    uint32_t compute_count;
+    unsigned int compute_cycles;
+
+    cim::RtlArray* rtl;
+    cim::SampledChecker* checker;
+    Backend active_backend;
+    bool rtl_stale;
+    bool rtl_fallback_reported;
+
+    std::vector<uint8_t> shadow_weights;
+    sc_core::sc_time shadow_ready;
+    std::future<void> shadow_load;
+    uint32_t swap_count;
+    uint32_t swap_stall_cycles;
+
+    std::vector<uint8_t> inputs;
+    std::vector<uint8_t> results;  // cols x 32-bit little endian
+    std::vector<int32_t> column_sums;
+};
+
+#endif
@@ -0,0 +1,248 @@
+// MemoryWrapper over the bus: weights written through DMI, bus writes and
+// debug transport must all reach the computes, whichever derived engine
+// state is on, and weight DMI must turn read-only once writes are tracked.
+// Shadow bank writes must stay invisible until a SWAP. Every result is
+// checked against a plain cim::Engine.
+
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "rtl/memory/engine/cim_engine.h"
+#include "rtl/memory/systemc/memory_wrapper.h"
+#include "systemc/tlm_data_path.h"
+
+namespace {
+
+const unsigned int ROWS = 16;
+const unsigned int COLS = 16;
+
+typedef MemoryWrapper<32> CimArray;
+
+class TestHost : public sc_core::sc_module {
+public:
+    tlm_utils::simple_initiator_socket<TestHost> socket;
+
+    SC_HAS_PROCESS(TestHost);
+    TestHost(sc_core::sc_module_name name, CimArray& cim)
+        : sc_core::sc_module(name), socket("socket"), cim(cim), weights(ROWS * COLS, 0), input(ROWS, 0) {
+        socket.register_invalidate_direct_mem_ptr(this, &TestHost::invalidate_direct_mem_ptr);
+        SC_THREAD(run);
+    }
+
+    int failures = 0;
+
+private:
+    void run() {
+        dmi_and_bus_writes();
+        tracked_writes();
+        swaps();
+        sc_core::sc_stop();
+    }
+
+    // Untracked, weight DMI is read/write and its writes need no report.
+    void dmi_and_bus_writes() {
+        tlm::tlm_dmi dmi;
+        expect(request_dmi(CimArray::WEIGHT_BASE, dmi) && dmi.is_read_write_allowed(), "weight DMI read/write");
+        for (unsigned int i = 0; i < ROWS * COLS; i++) {
+            weights[i] = static_cast<uint8_t>(std::rand());
+        }
+        std::memcpy(dmi.get_dmi_ptr(), weights.data(), weights.size());
+        check_compute(CimArray::MODE_MAC, "compute after DMI weight writes");
+
+        write_weights(2 * COLS, COLS);
+        check_compute(CimArray::MODE_MAC, "compute after a bus row write");
+    }
+
+    // Once the memo, planes and cache are on, every weight write must be
+    // seen: DMI is revoked and offered read-only, bus writes carry no DMI
+    // hint, and each write path invalidates the derived state.
+    void tracked_writes() {
+        invalidated = false;
+        cim.use_memo(8);
+        expect(invalidated, "tracking revokes weight DMI");
+
+        tlm::tlm_dmi dmi;
+        expect(request_dmi(CimArray::WEIGHT_BASE, dmi) && dmi.is_read_allowed() && !dmi.is_write_allowed(),
+               "tracked weight DMI read-only");
+        expect(!write_weights(0, 4), "no DMI hint on a tracked weight write");
+        std::vector<unsigned char> row(COLS);
+        expect(transport(tlm::TLM_READ_COMMAND, CimArray::WEIGHT_BASE, row.data(), COLS),
+               "DMI hint on a weight read");
+        expect(std::memcmp(dmi.get_dmi_ptr(), weights.data(), weights.size()) == 0, "read-only DMI sees the weights");
+
+        check_compute(CimArray::MODE_MAC, "memo miss");
+        check_compute(CimArray::MODE_MAC, "memo hit", false);
+        expect(read_register(CimArray::MEMO_HITS_REG_OFFSET) == 1, "repeated input hits the memo");
+        write_weights(5 * COLS + 3, 7);
+        check_compute(CimArray::MODE_MAC, "bus write drops the memo", false);
+        expect(read_register(CimArray::MEMO_HITS_REG_OFFSET) == 1, "no hit on stale weights");
+
+        cim.use_bit_planes(true);
+        cim.use_incremental(4);
+        const CimArray::ComputeMode modes[] = {CimArray::MODE_MAC, CimArray::MODE_SHIFT, CimArray::MODE_XOR};
+        for (int i = 0; i < 24; i++) {
+            unsigned int offset = static_cast<unsigned int>(std::rand()) % (ROWS * COLS);
+            unsigned int len = 1 + static_cast<unsigned int>(std::rand()) % (ROWS * COLS - offset);
+            if (i % 2) {
+                write_weights(offset, len);
+            } else {
+                write_weights_dbg(offset, len);
+            }
+            // Mostly repeated inputs, so the cache applies row deltas.
+            check_compute(modes[i % 3], "random writes with every derived state on", i % 4 == 0);
+        }
+    }
+
+    // A compute issued before a SWAP runs on the active weights, however
+    // the shadow bank was filled; one issued after, on the shadow's. The
+    // memo is still on, so the repeated input also shows stale results.
+    void swaps() {
+        sc_dt::uint64 shadow_base = cim.shadow_base();
+        expect(read_register(CimArray::SHADOW_BASE_REG_OFFSET) == shadow_base, "SHADOW_BASE register");
+        expect(shadow_base >= CimArray::WEIGHT_BASE + ROWS * COLS, "shadow bank past the weights");
+
+        // Over the bus, then SWAP and COMPUTE as separate CTRL writes.
+        std::vector<uint8_t> shadow(ROWS * COLS);
+        for (uint8_t& w : shadow) {
+            w = static_cast<uint8_t>(std::rand());
+        }
+        transport(tlm::TLM_WRITE_COMMAND, shadow_base, shadow.data(), ROWS * COLS);
+        check_compute(CimArray::MODE_MAC, "compute before the swap uses the old weights");
+        write_register(CimArray::CTRL_REG_OFFSET, CimArray::CTRL_SWAP);
+        std::vector<uint8_t> old = weights;
+        weights = shadow;
+        check_compute(CimArray::MODE_MAC, "compute after the swap uses the new weights", false);
+        expect(read_register(CimArray::SWAP_COUNT_REG_OFFSET) == 1, "one swap counted");
+
+        std::vector<uint8_t> readback(ROWS * COLS);
+        transport(tlm::TLM_READ_COMMAND, shadow_base, readback.data(), ROWS * COLS);
+        expect(readback == old, "the old weights move to the shadow bank");
+
+        // From the host thread, then SWAP in the same CTRL write as COMPUTE.
+        for (uint8_t& w : shadow) {
+            w = static_cast<uint8_t>(std::rand());
+        }
+        cim.load_shadow_async(shadow.data());
+        check_compute(CimArray::MODE_XOR, "compute during a shadow load uses the old weights", false);
+        weights = shadow;
+        check_compute(CimArray::MODE_XOR, "SWAP with COMPUTE swaps first", false, CimArray::CTRL_SWAP);
+        expect(read_register(CimArray::SWAP_COUNT_REG_OFFSET) == 2, "two swaps counted");
+    }
+
+    // Writes fresh random weights to [offset, offset + len) over the bus;
+    // returns the DMI hint of the write.
+    bool write_weights(unsigned int offset, unsigned int len) {
+        for (unsigned int i = offset; i < offset + len; i++) {
+            weights[i] = static_cast<uint8_t>(std::rand());
+        }
+        return transport(tlm::TLM_WRITE_COMMAND, CimArray::WEIGHT_BASE + offset, &weights[offset], len);
+    }
+
+    void write_weights_dbg(unsigned int offset, unsigned int len) {
+        for (unsigned int i = offset; i < offset + len; i++) {
+            weights[i] = static_cast<uint8_t>(std::rand());
+        }
+        tlm::tlm_generic_payload trans;
+        trans.set_command(tlm::TLM_WRITE_COMMAND);
+        trans.set_address(CimArray::WEIGHT_BASE + offset);
+        trans.set_data_ptr(&weights[offset]);
+        trans.set_data_length(len);
+        expect(socket->transport_dbg(trans) == len, "debug weight write");
+    }
+
+    // A compute over the bus, of a fresh random input or the last one,
+    // against a plain engine holding `weights`. `ctrl` adds CTRL bits.
+    void check_compute(CimArray::ComputeMode mode, const char* what, bool fresh_input = true, uint32_t ctrl = 0) {
+        if (fresh_input) {
+            for (uint8_t& x : input) {
+                x = static_cast<uint8_t>(std::rand() % 16 - 8);
+            }
+        }
+        transport(tlm::TLM_WRITE_COMMAND, CimArray::INPUT_BASE, input.data(), ROWS);
+        write_register(CimArray::CTRL_REG_OFFSET, ctrl | CimArray::CTRL_COMPUTE | (mode << CimArray::CTRL_MODE_SHIFT));
+
+        std::vector<unsigned char> raw(COLS * 4);
+        transport(tlm::TLM_READ_COMMAND, CimArray::RESULT_BASE, raw.data(), COLS * 4);
+
+        cim::Engine reference(ROWS, COLS);
+        std::memcpy(reference.weights(), weights.data(), weights.size());
+        std::vector<int32_t> expected(COLS);
+        reference.gemv(static_cast<cim::Mode>(mode), input.data(), expected.data());
+        bool same = true;
+        for (unsigned int c = 0; c < COLS; c++) {
+            same = same && static_cast<int32_t>(tlm_data_path::load_le<uint32_t>(&raw[c * 4])) == expected[c];
+        }
+        expect(same, what);
+    }
+
+    bool request_dmi(uint32_t addr, tlm::tlm_dmi& dmi) {
+        tlm::tlm_generic_payload trans;
+        trans.set_command(tlm::TLM_READ_COMMAND);
+        trans.set_address(addr);
+        return socket->get_direct_mem_ptr(trans, dmi);
+    }
+
+    void write_register(uint32_t offset, uint32_t value) {
+        unsigned char buffer[4];
+        tlm_data_path::store_le<uint32_t>(buffer, value);
+        transport(tlm::TLM_WRITE_COMMAND, offset, buffer, 4);
+    }
+
+    uint32_t read_register(uint32_t offset) {
+        unsigned char buffer[4] = {0, 0, 0, 0};
+        transport(tlm::TLM_READ_COMMAND, offset, buffer, 4);
+        return tlm_data_path::load_le<uint32_t>(buffer);
+    }
+
+    // Returns the DMI hint.
+    bool transport(tlm::tlm_command cmd, sc_dt::uint64 addr, unsigned char* data, unsigned int len) {
+        tlm::tlm_generic_payload trans;
+        sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+        trans.set_command(cmd);
+        trans.set_address(addr);
+        trans.set_data_ptr(data);
+        trans.set_data_length(len);
+        trans.set_streaming_width(len);
+        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+        socket->b_transport(trans, delay);
+        sc_core::wait(delay);
+        expect(trans.is_response_ok(), "transaction");
+        return trans.is_dmi_allowed();
+    }
+
+    void invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end) {
+        invalidated = invalidated || (start <= CimArray::WEIGHT_BASE && end >= CimArray::WEIGHT_BASE);
+    }
+
+    void expect(bool ok, const char* what) {
+        if (!ok) {
+            std::cout << "[Test] FAIL: " << what << std::endl;
+            failures++;
+        }
+    }
+
+    CimArray& cim;
+    std::vector<uint8_t> weights;
+    std::vector<uint8_t> input;
+    bool invalidated = false;
+};
+
+} // namespace
+
+int sc_main(int argc, char* argv[]) {
+    std::srand(1);
+    CimArray cim("cim", ROWS, COLS);
+    TestHost host("host", cim);
+    host.socket.bind(cim.socket);
+
+    sc_core::sc_start();
+
+    std::cout << "[Test] memory_wrapper: " << host.failures << " failures" << std::endl;
+    return host.failures ? 1 : 0;
+}
@@ -0,0 +1,65 @@
+#ifndef MEMORY_INTERFACE_H
+#define MEMORY_INTERFACE_H
+
+// C ABI between the Rust memory controller (src/memory_controller.rs) and
+// the SystemC CIM array model (rtl/memory/systemc/memory_wrapper.h),
+// implemented in rtl/memory/systemc/memory_bridge.cpp.
+//
+// Requests are submitted in batches. Each request's buffer is used as
+// the TLM payload data pointer as-is, so the model reads and writes
+// caller memory directly. No marshaling or intermediate copies happen.
+// Buffers must stay valid until memif_submit() returns. A write only
+// reads its buffer.
+//
+// SystemC elaborates once per process, so only one system can exist.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct MemIfSystem MemIfSystem;
+
+enum {
+    MEMIF_OK = 0,
+    MEMIF_INCOMPLETE = 1,
+    MEMIF_ADDRESS_ERROR = 2,
+    MEMIF_COMMAND_ERROR = 3,
+    MEMIF_BURST_ERROR = 4,
+    MEMIF_GENERIC_ERROR = 5,
+};
+
+typedef struct {
+    uint64_t addr;      // offset in the array's register map
+    uint8_t *data;      // borrowed, len bytes
+    uint32_t len;
+    uint8_t is_write;
+    uint8_t status;     // out: MEMIF_*
+    uint16_t reserved;
+} MemIfRequest;
+
+// Elaborates a rows x cols array. Returns NULL if a system already exists
+// or the geometry is out of range.
+MemIfSystem *memif_create(uint32_t rows, uint32_t cols, uint32_t data_width,
+                          uint32_t compute_width);
+// Ends the simulation. The system cannot be re-created in this process.
+void memif_destroy(MemIfSystem *system);
+
+// Runs requests[0..count) in order as b_transport calls. Simulated time
+// is synchronised once at the end of the batch. Stops at the first
+// failing request. Returns the number of requests that completed OK.
+size_t memif_submit(MemIfSystem *system, MemIfRequest *requests, size_t count);
+
+// Size of the decoded address space (the weight window ends it).
+uint64_t memif_region_size(const MemIfSystem *system);
+// Simulated time consumed so far, in picoseconds.
+uint64_t memif_sim_time_ps(const MemIfSystem *system);
+uint64_t memif_transactions(const MemIfSystem *system);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+//! Drives the CIM array model from Rust: loads a weight matrix, then
+//! streams input vectors through batched zero-copy GEMVs and reports
+//! throughput. `--rtl-netlist` is recorded in the results; the run always
+//! uses the TLM model.
+
+use memory_controller::{ComputeMode, MemoryController, COMPUTE_COUNT_REG_OFFSET};
+use std::fs::File;
+use std::io::Write;
+use std::process::ExitCode;
+use std::time::Instant;
+
+struct Options {
+    rows: usize,
+    cols: usize,
+    vectors: usize,
+    batch: usize,
+    netlist: Option<String>,
+    output: Option<String>,
+}
+
+fn parse_options() -> Option<Options> {
+    let mut opts = Options {
+        rows: 1024,
+        cols: 1024,
+        vectors: 256,
+        batch: 32,
+        netlist: None,
+        output: None,
+    };
+    for arg in std::env::args().skip(1) {
+        let (key, value) = arg.split_once('=')?;
+        match key {
+            "--rows" => opts.rows = value.parse().ok()?,
+            "--cols" => opts.cols = value.parse().ok()?,
+            "--vectors" => opts.vectors = value.parse().ok()?,
+            "--batch" => opts.batch = value.parse().ok()?,
+            "--rtl-netlist" => opts.netlist = Some(value.to_string()),
+            "--output" => opts.output = Some(value.to_string()),
+            _ => return None,
+        }
+    }
+    if opts.batch == 0 {
+        return None;
+    }
+    Some(opts)
+}
+
+// Deterministic test data without pulling in a crate.
+fn fill(data: &mut [i8], mut seed: u32) {
+    for value in data.iter_mut() {
+        seed = seed.wrapping_mul(1_664_525).wrapping_add(1_013_904_223);
+        *value = (seed >> 24) as i8;
+    }
+}
+
+fn main() -> ExitCode {
+    let Some(opts) = parse_options() else {
+        eprintln!("Usage: memory_system_sim [--rows=N] [--cols=N] [--vectors=N] [--batch=N] [--rtl-netlist=path] [--output=path]");
+        return ExitCode::from(2);
+    };
+
+    let Some(mut array) = MemoryController::new(opts.rows, opts.cols, 8, 16) else {
+        eprintln!("[MemSim] Unsupported geometry {}x{}", opts.rows, opts.cols);
+        return ExitCode::FAILURE;
+    };
+
+    let mut weights = vec![0i8; opts.rows * opts.cols];
+    fill(&mut weights, 1);
+    let mut inputs = vec![0i8; opts.rows * opts.batch];
+    let mut outputs = vec![0i32; opts.cols * opts.batch];
+    let mut checksum: i64 = 0;
+
+    let start = Instant::now();
+    if let Err(e) = array.load_weights(&weights) {
+        eprintln!("[MemSim] Weight load failed: {}", e);
+        return ExitCode::FAILURE;
+    }
+
+    let mut remaining = opts.vectors;
+    let mut seed = 2;
+    while remaining > 0 {
+        let n = remaining.min(opts.batch);
+        fill(&mut inputs[..n * opts.rows], seed);
+        if let Err(e) = array.gemm(&inputs[..n * opts.rows], ComputeMode::Mac, &mut outputs[..n * opts.cols]) {
+            eprintln!("[MemSim] GEMV failed: {}", e);
+            return ExitCode::FAILURE;
+        }
+        checksum = outputs[..n * opts.cols].iter().fold(checksum, |acc, &v| acc.wrapping_add(v as i64));
+        remaining -= n;
+        seed += 1;
+    }
+    let host_s = start.elapsed().as_secs_f64();
+
+    let computes = array.read_register(COMPUTE_COUNT_REG_OFFSET).unwrap_or(0);
+    let macs = opts.vectors as f64 * opts.rows as f64 * opts.cols as f64;
+    let report = format!(
+        "array: {}x{}\nnetlist: {}\nvectors: {}\ncomputes: {}\ntransactions: {}\nsim_time_us: {:.3}\nhost_s: {:.6}\nhost_gmacs: {:.3}\nchecksum: {}\n",
+        opts.rows,
+        opts.cols,
+        opts.netlist.as_deref().unwrap_or("-"),
+        opts.vectors,
+        computes,
+        array.transactions(),
+        array.sim_time_ps() as f64 / 1e6,
+        host_s,
+        if host_s > 0.0 { macs / host_s / 1e9 } else { 0.0 },
+        checksum
+    );
+    print!("{}", report);
+
+    if let Some(path) = &opts.output {
+        if let Err(e) = File::create(path).and_then(|mut f| f.write_all(report.as_bytes())) {
+            eprintln!("[MemSim] Cannot write {}: {}", path, e);
+            return ExitCode::FAILURE;
+        }
+    }
+    ExitCode::SUCCESS
+}
@@ -0,0 +1,332 @@
+//! Rust driver for the SystemC CIM array model, over the C ABI in
+//! `rust_bindings/memory_interface.h`.
+//!
+//! Transfers are zero-copy. A [`Batch`] records borrowed slices, and the
+//! C++ side uses each slice's pointer as the TLM payload data pointer. The
+//! borrow checker keeps every slice alive and unaliased until
+//! [`Batch::submit`] returns. A whole batch costs one FFI call and one
+//! SystemC time synchronisation.
+
+use std::fmt;
+use std::marker::PhantomData;
+use std::ptr::NonNull;
+
+mod ffi {
+    #[repr(C)]
+    pub struct MemIfSystem {
+        _private: [u8; 0],
+    }
+
+    #[repr(C)]
+    pub struct MemIfRequest {
+        pub addr: u64,
+        pub data: *mut u8,
+        pub len: u32,
+        pub is_write: u8,
+        pub status: u8,
+        pub reserved: u16,
+    }
+
+    extern "C" {
+        pub fn memif_create(rows: u32, cols: u32, data_width: u32, compute_width: u32) -> *mut MemIfSystem;
+        pub fn memif_destroy(system: *mut MemIfSystem);
+        pub fn memif_submit(system: *mut MemIfSystem, requests: *mut MemIfRequest, count: usize) -> usize;
+        pub fn memif_region_size(system: *const MemIfSystem) -> u64;
+        pub fn memif_sim_time_ps(system: *const MemIfSystem) -> u64;
+        pub fn memif_transactions(system: *const MemIfSystem) -> u64;
+    }
+}
+
+// Register map of MemoryWrapper (rtl/memory/systemc/memory_wrapper.h).
+pub const CTRL_REG_OFFSET: u64 = 0x0000;
+pub const STATUS_REG_OFFSET: u64 = 0x0004;
+pub const COMPUTE_COUNT_REG_OFFSET: u64 = 0x0018;
+pub const BACKEND_REG_OFFSET: u64 = 0x001C;
+pub const SWAP_COUNT_REG_OFFSET: u64 = 0x0020;
+pub const SWAP_STALL_REG_OFFSET: u64 = 0x0024;
+pub const SHADOW_BASE_REG_OFFSET: u64 = 0x0028;
+pub const MEMO_ENTRIES_REG_OFFSET: u64 = 0x002C;
+pub const MEMO_HITS_REG_OFFSET: u64 = 0x0030;
+pub const MEMO_MISSES_REG_OFFSET: u64 = 0x0034;
+pub const ROW_ENABLE_BASE: u64 = 0x1000;
+pub const COL_ENABLE_BASE: u64 = 0x2000;
+pub const INPUT_BASE: u64 = 0x10000;
+pub const RESULT_BASE: u64 = 0x20000;
+pub const WEIGHT_BASE: u64 = 0x100000;
+
+const CTRL_COMPUTE: u32 = 1 << 0;
+const CTRL_MODE_SHIFT: u32 = 1;
+const CTRL_SWAP: u32 = 1 << 4;
+
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum ComputeMode {
+    Mac = 0,
+    Add = 1,
+    Shift = 2,
+    Xor = 3,
+}
+
+/// A TLM error response, with the index of the failing request.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct TransferError {
+    pub index: usize,
+    pub status: u8,
+}
+
+impl fmt::Display for TransferError {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        let reason = match self.status {
+            1 => "incomplete",
+            2 => "address error",
+            3 => "command error",
+            4 => "burst error",
+            _ => "generic error",
+        };
+        write!(f, "request {} failed: {}", self.index, reason)
+    }
+}
+
+impl std::error::Error for TransferError {}
+
+pub struct MemoryController {
+    system: NonNull<ffi::MemIfSystem>,
+    rows: usize,
+    cols: usize,
+}
+
+impl MemoryController {
+    /// Elaborates the array model. SystemC allows this once per process.
+    /// Returns `None` on a second call or an unsupported geometry,
+    /// including rows or cols that do not fit in a u32.
+    pub fn new(rows: usize, cols: usize, data_width: u32, compute_width: u32) -> Option<Self> {
+        let ffi_rows = u32::try_from(rows).ok()?;
+        let ffi_cols = u32::try_from(cols).ok()?;
+        let system = unsafe { ffi::memif_create(ffi_rows, ffi_cols, data_width, compute_width) };
+        NonNull::new(system).map(|system| Self { system, rows, cols })
+    }
+
+    pub fn rows(&self) -> usize {
+        self.rows
+    }
+
+    pub fn cols(&self) -> usize {
+        self.cols
+    }
+
+    pub fn region_size(&self) -> u64 {
+        unsafe { ffi::memif_region_size(self.system.as_ptr()) }
+    }
+
+    pub fn sim_time_ps(&self) -> u64 {
+        unsafe { ffi::memif_sim_time_ps(self.system.as_ptr()) }
+    }
+
+    pub fn transactions(&self) -> u64 {
+        unsafe { ffi::memif_transactions(self.system.as_ptr()) }
+    }
+
+    pub fn batch(&mut self) -> Batch<'_> {
+        Batch {
+            system: self.system,
+            requests: Vec::new(),
+            _borrows: PhantomData,
+        }
+    }
+
+    /// Writes the full rows x cols weight matrix, row major, in one transfer.
+    pub fn load_weights(&mut self, weights: &[i8]) -> Result<(), TransferError> {
+        assert_eq!(weights.len(), self.rows * self.cols);
+        let mut batch = self.batch();
+        batch.write(WEIGHT_BASE, as_bytes(weights));
+        batch.submit()
+    }
+
+    /// Writes the next weight matrix into the shadow bank. Computes keep
+    /// using the active bank until [`swap_weights`](Self::swap_weights).
+    pub fn load_shadow_weights(&mut self, weights: &[i8]) -> Result<(), TransferError> {
+        assert_eq!(weights.len(), self.rows * self.cols);
+        let base = u64::from(self.read_register(SHADOW_BASE_REG_OFFSET)?);
+        let mut batch = self.batch();
+        batch.write(base, as_bytes(weights));
+        batch.submit()
+    }
+
+    /// Makes the shadow bank active, waiting in simulated time for its load.
+    pub fn swap_weights(&mut self) -> Result<(), TransferError> {
+        let ctrl = CTRL_SWAP.to_le_bytes();
+        let mut batch = self.batch();
+        batch.write(CTRL_REG_OFFSET, &ctrl);
+        batch.submit()
+    }
+
+    /// One compute: writes `input`, starts `mode` and reads the column
+    /// results into `output`, all in one batch.
+    pub fn gemv(&mut self, input: &[i8], mode: ComputeMode, output: &mut [i32]) -> Result<(), TransferError> {
+        assert_eq!(input.len(), self.rows);
+        assert_eq!(output.len(), self.cols);
+        let ctrl = (CTRL_COMPUTE | (mode as u32) << CTRL_MODE_SHIFT).to_le_bytes();
+
+        let mut batch = self.batch();
+        batch.write(INPUT_BASE, as_bytes(input));
+        batch.write(CTRL_REG_OFFSET, &ctrl);
+        batch.read(RESULT_BASE, as_bytes_mut(output));
+        batch.submit()?;
+
+        // Results are little endian in the model.
+        if cfg!(target_endian = "big") {
+            for value in output.iter_mut() {
+                *value = i32::from_le(*value);
+            }
+        }
+        Ok(())
+    }
+
+    /// Runs `inputs.len() / rows` GEMVs back to back in a single batch;
+    /// `outputs` receives `cols` results per input vector.
+    pub fn gemm(&mut self, inputs: &[i8], mode: ComputeMode, outputs: &mut [i32]) -> Result<(), TransferError> {
+        assert_eq!(inputs.len() % self.rows, 0);
+        let vectors = inputs.len() / self.rows;
+        assert_eq!(outputs.len(), vectors * self.cols);
+        let ctrl = (CTRL_COMPUTE | (mode as u32) << CTRL_MODE_SHIFT).to_le_bytes();
+
+        let rows = self.rows;
+        let cols = self.cols;
+        let mut batch = self.batch();
+        for (input, output) in inputs.chunks(rows).zip(outputs.chunks_mut(cols)) {
+            batch.write(INPUT_BASE, as_bytes(input));
+            batch.write(CTRL_REG_OFFSET, &ctrl);
+            batch.read(RESULT_BASE, as_bytes_mut(output));
+        }
+        batch.submit()?;
+
+        if cfg!(target_endian = "big") {
+            for value in outputs.iter_mut() {
+                *value = i32::from_le(*value);
+            }
+        }
+        Ok(())
+    }
+
+    /// Memoises the results of up to `entries` computes, so repeated
+    /// inputs against unchanged weights skip the array; 0 turns it off.
+    pub fn set_memo_entries(&mut self, entries: u32) -> Result<(), TransferError> {
+        let value = entries.to_le_bytes();
+        let mut batch = self.batch();
+        batch.write(MEMO_ENTRIES_REG_OFFSET, &value);
+        batch.submit()
+    }
+
+    /// Memo hits and misses so far, as (hits, misses).
+    pub fn memo_stats(&mut self) -> Result<(u32, u32), TransferError> {
+        Ok((self.read_register(MEMO_HITS_REG_OFFSET)?, self.read_register(MEMO_MISSES_REG_OFFSET)?))
+    }
+
+    pub fn read_register(&mut self, offset: u64) -> Result<u32, TransferError> {
+        let mut value = [0u8; 4];
+        let mut batch = self.batch();
+        batch.read(offset, &mut value);
+        batch.submit()?;
+        Ok(u32::from_le_bytes(value))
+    }
+}
+
+impl Drop for MemoryController {
+    fn drop(&mut self) {
+        unsafe { ffi::memif_destroy(self.system.as_ptr()) };
+    }
+}
+
+/// Requests queued for one submission. `'a` ties every buffer to the
+/// batch, so none can be dropped or touched before the model is done.
+pub struct Batch<'a> {
+    system: NonNull<ffi::MemIfSystem>,
+    requests: Vec<ffi::MemIfRequest>,
+    _borrows: PhantomData<&'a mut [u8]>,
+}
+
+impl<'a> Batch<'a> {
+    pub fn read(&mut self, addr: u64, buffer: &'a mut [u8]) {
+        self.push(addr, buffer.as_mut_ptr(), buffer.len(), false);
+    }
+
+    pub fn write(&mut self, addr: u64, buffer: &'a [u8]) {
+        // The model only reads the buffer of a write.
+        self.push(addr, buffer.as_ptr() as *mut u8, buffer.len(), true);
+    }
+
+    pub fn len(&self) -> usize {
+        self.requests.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.requests.is_empty()
+    }
+
+    pub fn submit(mut self) -> Result<(), TransferError> {
+        let count = self.requests.len();
+        let done = unsafe { ffi::memif_submit(self.system.as_ptr(), self.requests.as_mut_ptr(), count) };
+        if done < count {
+            return Err(TransferError {
+                index: done,
+                status: self.requests[done].status,
+            });
+        }
+        Ok(())
+    }
+
+    fn push(&mut self, addr: u64, data: *mut u8, len: usize, is_write: bool) {
+        self.requests.push(ffi::MemIfRequest {
+            addr,
+            data,
+            len: u32::try_from(len).expect("transfer larger than 4 GiB"),
+            is_write: is_write as u8,
+            status: 0,
+            reserved: 0,
+        });
+    }
+}
+
+fn as_bytes<T: Copy>(values: &[T]) -> &[u8] {
+    unsafe { std::slice::from_raw_parts(values.as_ptr() as *const u8, std::mem::size_of_val(values)) }
+}
+
+fn as_bytes_mut<T: Copy>(values: &mut [T]) -> &mut [u8] {
+    unsafe { std::slice::from_raw_parts_mut(values.as_mut_ptr() as *mut u8, std::mem::size_of_val(values)) }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::MemoryController;
+
+    // None of these elaborate, so they leave the process's one system free.
+    #[test]
+    fn new_rejects_unsupported_geometry() {
+        let bad = [
+            (0, 16, 8, 16),
+            (16, 0, 8, 16),
+            (16, 16, 9, 16),
+            (16, 16, 8, 33),
+            (0x8001, 1, 8, 16),
+            (1, 0x4000_0000, 8, 16),
+            (1, 0xC000_0000, 8, 16),
+            (0x8000, 0x38000, 8, 16),
+        ];
+        for &(rows, cols, data_width, compute_width) in &bad {
+            assert!(
+                MemoryController::new(rows, cols, data_width, compute_width).is_none(),
+                "{}x{} int{}/{} accepted",
+                rows,
+                cols,
+                data_width,
+                compute_width
+            );
+        }
+    }
+
+    #[test]
+    #[cfg(target_pointer_width = "64")]
+    fn new_rejects_sizes_past_u32() {
+        assert!(MemoryController::new(1 << 32, 16, 8, 16).is_none());
+        assert!(MemoryController::new(16, (1 << 32) + 16, 8, 16).is_none());
+    }
+}
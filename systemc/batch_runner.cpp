@@ -0,0 +1,285 @@
+// Batch runner: elaborates the testbench once, then forks one child per
+// scenario. Children share the elaborated design copy-on-write, run the
+// simulation with their own scenario parameters and report back through
+// a pipe, so each scenario costs a fork() instead of a process start and
+// a full elaboration.
+
+#include <systemc>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "peripheral_model.h"
+#include "testbench.h"
+
+namespace {
+
+struct Options {
+    unsigned int jobs = 0;
+    unsigned int timeout_s = 60;
+    std::string scenario_file;
+    std::string output_file;
+    std::string log_dir;
+};
+
+struct Worker {
+    size_t scenario;
+    int result_fd;
+};
+
+// Written by the child in a single write(); well below PIPE_BUF.
+struct WireResult {
+    ScenarioResult result;
+    int completed;
+};
+
+struct Outcome {
+    WireResult wire;
+    int exit_status;
+};
+
+void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [-j jobs] [--timeout seconds] [--output results.csv]"
+              << " [--log-dir dir] scenarios.txt" << std::endl;
+    std::cerr << "Scenario file: one '<name> <seed> <control> <wait_us>' per line, '#' comments"
+              << std::endl;
+}
+
+bool parse_options(int argc, char* argv[], Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "-j" && has_value) {
+            opts.jobs = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--timeout" && has_value) {
+            opts.timeout_s = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--output" && has_value) {
+            opts.output_file = argv[++i];
+        } else if (arg == "--log-dir" && has_value) {
+            opts.log_dir = argv[++i];
+        } else if (!arg.empty() && arg[0] != '-' && opts.scenario_file.empty()) {
+            opts.scenario_file = arg;
+        } else {
+            return false;
+        }
+    }
+    return !opts.scenario_file.empty();
+}
+
+bool load_scenarios(const std::string& path, std::vector<Scenario>& scenarios) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "[Batch] Cannot open scenario file " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    unsigned int line_no = 0;
+    while (std::getline(in, line)) {
+        ++line_no;
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        Scenario s;
+        std::string control;
+        if (!(fields >> s.name >> s.seed >> control >> s.wait_us)) {
+            std::cerr << "[Batch] " << path << ":" << line_no << ": malformed scenario" << std::endl;
+            return false;
+        }
+        s.control = std::strtoul(control.c_str(), nullptr, 0);
+        scenarios.push_back(s);
+    }
+    return true;
+}
+
+// Scenario names come from the scenario file; anything but letters,
+// digits, '.', '_' and '-' becomes '_' so a name cannot leave the log
+// directory.
+std::string log_name(const std::string& name) {
+    std::string safe = name;
+    for (char& c : safe) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '_' && c != '-') {
+            c = '_';
+        }
+    }
+    return safe + ".log";
+}
+
+// Runs in the forked child. Never returns.
+void run_child(TestBench& tb, const Scenario& scenario, unsigned int timeout_s,
+               const std::string& log_dir, int result_fd) {
+    int log_fd = log_dir.empty()
+        ? open("/dev/null", O_WRONLY)
+        : open((log_dir + "/" + log_name(scenario.name)).c_str(),
+               O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (log_fd >= 0) {
+        dup2(log_fd, STDOUT_FILENO);
+        dup2(log_fd, STDERR_FILENO);
+        close(log_fd);
+    }
+
+    alarm(timeout_s);
+
+    tb.scenario = scenario;
+    std::srand(scenario.seed);
+
+    WireResult wire;
+    std::memset(&wire, 0, sizeof(wire));
+    try {
+        sc_core::sc_start();
+        wire.completed = 1;
+    } catch (const std::exception& e) {
+        std::cerr << "[Batch] " << scenario.name << ": " << e.what() << std::endl;
+    }
+    wire.result = tb.result;
+    std::cout.flush();
+
+    ssize_t written = write(result_fd, &wire, sizeof(wire));
+    _exit(written == sizeof(wire) && wire.completed && tb.result.transaction_errors == 0 ? 0 : 1);
+}
+
+bool passed(const Outcome& o) {
+    return WIFEXITED(o.exit_status) && WEXITSTATUS(o.exit_status) == 0 && o.wire.completed;
+}
+
+std::string describe_failure(const Outcome& o) {
+    if (WIFSIGNALED(o.exit_status)) {
+        return WTERMSIG(o.exit_status) == SIGALRM ? "timeout" : strsignal(WTERMSIG(o.exit_status));
+    }
+    if (!o.wire.completed) {
+        return "aborted";
+    }
+    return "transaction errors";
+}
+
+void write_report(const std::string& path, const std::vector<Scenario>& scenarios,
+                  const std::vector<Outcome>& outcomes) {
+    std::ofstream out(path);
+    out << "name,seed,control,wait_us,result,status,data,errors,sim_time_us\n";
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        const Scenario& s = scenarios[i];
+        const Outcome& o = outcomes[i];
+        out << s.name << "," << s.seed << ",0x" << std::hex << s.control << std::dec << ","
+            << s.wait_us << "," << (passed(o) ? "pass" : describe_failure(o)) << ",0x"
+            << std::hex << o.wire.result.status << ",0x" << o.wire.result.data << std::dec << ","
+            << o.wire.result.transaction_errors << "," << o.wire.result.sim_time_us << "\n";
+    }
+}
+
+} // namespace
+
+int sc_main(int argc, char* argv[]) {
+    Options opts;
+    if (!parse_options(argc, argv, opts)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<Scenario> scenarios;
+    if (!load_scenarios(opts.scenario_file, scenarios)) {
+        return 2;
+    }
+    if (opts.jobs == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        opts.jobs = cpus > 0 ? static_cast<unsigned int>(cpus) : 1;
+    }
+
+    // Elaborate once; every child inherits this hierarchy.
+    TestBench tb("testbench");
+    PeripheralModel<> peripheral("peripheral");
+    sc_core::sc_signal<bool> irq("irq");
+    tb.socket.bind(peripheral.socket);
+    peripheral.irq(irq);
+    // Completes elaboration and the initialisation delta here rather than
+    // in every child. The testbench reads its scenario only after its
+    // first wait, so the children's parameters still apply.
+    sc_core::sc_start(sc_core::SC_ZERO_TIME);
+
+    std::vector<Outcome> outcomes(scenarios.size());
+    std::map<pid_t, Worker> running;
+    size_t next = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    while (next < scenarios.size() || !running.empty()) {
+        while (next < scenarios.size() && running.size() < opts.jobs) {
+            int fds[2];
+            if (pipe(fds) != 0) {
+                perror("pipe");
+                return 1;
+            }
+
+            std::cout.flush();
+            std::cerr.flush();
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("fork");
+                return 1;
+            }
+            if (pid == 0) {
+                // The other workers' read ends are the parent's.
+                close(fds[0]);
+                for (const auto& worker : running) {
+                    close(worker.second.result_fd);
+                }
+                run_child(tb, scenarios[next], opts.timeout_s, opts.log_dir, fds[1]);
+            }
+
+            close(fds[1]);
+            running[pid] = Worker{next, fds[0]};
+            ++next;
+        }
+
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            perror("waitpid");
+            return 1;
+        }
+        auto it = running.find(pid);
+        if (it == running.end()) {
+            continue;
+        }
+
+        Outcome& outcome = outcomes[it->second.scenario];
+        outcome.exit_status = status;
+        if (read(it->second.result_fd, &outcome.wire, sizeof(outcome.wire)) != sizeof(outcome.wire)) {
+            std::memset(&outcome.wire, 0, sizeof(outcome.wire));
+        }
+        close(it->second.result_fd);
+
+        const Scenario& s = scenarios[it->second.scenario];
+        std::cout << "[Batch] " << s.name << ": "
+                  << (passed(outcome) ? "pass" : describe_failure(outcome)) << std::endl;
+        running.erase(it);
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t pass_count = std::count_if(outcomes.begin(), outcomes.end(), passed);
+
+    std::cout << "[Batch] " << pass_count << "/" << scenarios.size() << " scenarios passed in "
+              << elapsed << " s (" << (elapsed > 0 ? scenarios.size() * 60.0 / elapsed : 0.0)
+              << " scenarios/min, " << opts.jobs << " workers)" << std::endl;
+
+    if (!opts.output_file.empty()) {
+        write_report(opts.output_file, scenarios, outcomes);
+    }
+
+    return pass_count == scenarios.size() ? 0 : 1;
+}
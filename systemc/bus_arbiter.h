@@ -0,0 +1,322 @@
+#ifndef BUS_ARBITER_H
+#define BUS_ARBITER_H
+
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <tlm_utils/simple_target_socket.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "payload_extensions.h"
+
+// Shared-bus arbiter between N_INITIATORS blocking initiators and one
+// downstream socket (typically a Router). Each b_transport call is queued,
+// granted according to the policy and then occupies the bus for the
+// target's annotated delay, so contention shows up as simulated waiting
+// time. Callers must be SC_THREADs.
+//
+// Policies: round-robin, fixed priority (static priority or the payload's
+// QoS, whichever is higher) and weighted round-robin. Any initiator can
+// additionally be rate limited by a token bucket. Per-initiator bandwidth
+// and latency are collected in Stats.
+//
+// DMI is refused so that all traffic is arbitrated.
+template <unsigned int N_INITIATORS, unsigned int BUSWIDTH = 32>
+class BusArbiter : public sc_core::sc_module {
+public:
+    enum Policy {
+        ROUND_ROBIN,
+        FIXED_PRIORITY,
+        WEIGHTED
+    };
+
+    struct Stats {
+        sc_dt::uint64 transactions;
+        sc_dt::uint64 bytes;
+        sc_core::sc_time total_wait;
+        sc_core::sc_time max_wait;
+        sc_core::sc_time throttled;
+        sc_core::sc_time busy;
+    };
+
+    tlm_utils::simple_target_socket_tagged<BusArbiter, BUSWIDTH>* target_socket[N_INITIATORS];
+    tlm_utils::simple_initiator_socket<BusArbiter, BUSWIDTH> initiator_socket;
+
+    SC_CTOR(BusArbiter)
+        : initiator_socket("initiator_socket"), policy(ROUND_ROBIN), granted(-1),
+          last_grant(N_INITIATORS - 1) {
+        for (unsigned int i = 0; i < N_INITIATORS; i++) {
+            std::ostringstream name;
+            name << "target_socket_" << i;
+            target_socket[i] = new tlm_utils::simple_target_socket_tagged<BusArbiter, BUSWIDTH>(
+                name.str().c_str());
+            target_socket[i]->register_b_transport(this, &BusArbiter::b_transport, i);
+            target_socket[i]->register_get_direct_mem_ptr(this, &BusArbiter::get_direct_mem_ptr, i);
+            target_socket[i]->register_transport_dbg(this, &BusArbiter::transport_dbg, i);
+
+            Port& p = ports[i];
+            p.pending = false;
+            p.bytes = 0;
+            p.qos = 0;
+            p.priority = 0;
+            p.weight = 1;
+            p.credits = 1;
+            p.rate = 0.0;
+            p.burst = 0.0;
+            p.tokens = 0.0;
+            p.throttled = false;
+            p.stats = Stats();
+        }
+        initiator_socket.register_invalidate_direct_mem_ptr(this, &BusArbiter::invalidate_direct_mem_ptr);
+
+        SC_THREAD(arbitrate);
+    }
+
+    ~BusArbiter() {
+        for (unsigned int i = 0; i < N_INITIATORS; i++) {
+            delete target_socket[i];
+        }
+    }
+
+    void set_policy(Policy p) { policy = p; }
+
+    // FIXED_PRIORITY: higher wins.
+    void set_priority(unsigned int initiator, unsigned int priority) {
+        sc_assert(initiator < N_INITIATORS);
+        ports[initiator].priority = priority;
+    }
+
+    // WEIGHTED: grants per round.
+    void set_weight(unsigned int initiator, unsigned int weight) {
+        sc_assert(initiator < N_INITIATORS && weight > 0);
+        ports[initiator].weight = weight;
+        ports[initiator].credits = weight;
+    }
+
+    // Token bucket refilled at `bytes_per_us`, holding at most
+    // `burst_bytes`. A rate of zero removes the limit.
+    void set_rate_limit(unsigned int initiator, double bytes_per_us, unsigned int burst_bytes) {
+        sc_assert(initiator < N_INITIATORS);
+        Port& p = ports[initiator];
+        p.rate = bytes_per_us;
+        p.burst = burst_bytes;
+        p.tokens = burst_bytes;
+        p.refilled_at = sc_core::sc_time_stamp();
+    }
+
+    const Stats& stats(unsigned int initiator) const {
+        sc_assert(initiator < N_INITIATORS);
+        return ports[initiator].stats;
+    }
+
+    void report(std::ostream& out = std::cout) const {
+        double elapsed_us = sc_core::sc_time_stamp().to_seconds() * 1e6;
+        out << "[Arbiter] " << name() << " after " << elapsed_us << " us" << std::endl;
+        for (unsigned int i = 0; i < N_INITIATORS; i++) {
+            const Stats& s = ports[i].stats;
+            double avg_wait_ns = s.transactions
+                ? s.total_wait.to_seconds() * 1e9 / s.transactions : 0.0;
+            out << "  initiator " << i << ": " << std::dec << s.transactions << " txns, "
+                << s.bytes << " bytes, " << std::fixed << std::setprecision(2)
+                << (elapsed_us > 0 ? s.bytes / elapsed_us : 0.0) << " MB/s, avg wait "
+                << avg_wait_ns << " ns, max wait " << s.max_wait.to_seconds() * 1e9
+                << " ns, throttled " << s.throttled.to_seconds() * 1e9 << " ns" << std::endl;
+            out.unsetf(std::ios::floatfield);
+        }
+    }
+
+private:
+    struct Port {
+        bool pending;
+        unsigned int bytes;
+        unsigned int qos;
+        sc_core::sc_time requested_at;
+        unsigned int priority;
+        unsigned int weight;
+        unsigned int credits;
+        double rate;    // bytes per us
+        double burst;
+        double tokens;
+        sc_core::sc_time refilled_at;
+        bool throttled;
+        sc_core::sc_time throttled_since;
+        Stats stats;
+    };
+
+    void b_transport(int id, tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+        // Resolve contention in simulated-time order.
+        sc_core::wait(delay);
+        delay = sc_core::SC_ZERO_TIME;
+
+        Port& p = ports[id];
+        p.pending = true;
+        p.bytes = trans.get_data_length();
+        p.qos = sideband::qos(trans);
+        p.requested_at = sc_core::sc_time_stamp();
+        arbitrate_event.notify(sc_core::SC_ZERO_TIME);
+
+        while (granted != id) {
+            sc_core::wait(grant_event);
+        }
+
+        sc_core::sc_time waited = sc_core::sc_time_stamp() - p.requested_at;
+        sc_core::sc_time start = sc_core::sc_time_stamp();
+
+        initiator_socket->b_transport(trans, delay);
+        sc_core::wait(delay);
+        delay = sc_core::SC_ZERO_TIME;
+
+        Stats& s = p.stats;
+        s.transactions++;
+        s.bytes += p.bytes;
+        s.total_wait += waited;
+        s.max_wait = std::max(s.max_wait, waited);
+        s.busy += sc_core::sc_time_stamp() - start;
+        if (p.rate > 0.0) {
+            p.tokens -= p.bytes;
+        }
+
+        granted = -1;
+        arbitrate_event.notify(sc_core::SC_ZERO_TIME);
+    }
+
+    bool get_direct_mem_ptr(int id, tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data) {
+        return false;
+    }
+
+    unsigned int transport_dbg(int id, tlm::tlm_generic_payload& trans) {
+        return initiator_socket->transport_dbg(trans);
+    }
+
+    void invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end) {
+        for (unsigned int i = 0; i < N_INITIATORS; i++) {
+            (*target_socket[i])->invalidate_direct_mem_ptr(start, end);
+        }
+    }
+
+    void refill(Port& p) {
+        sc_core::sc_time now = sc_core::sc_time_stamp();
+        double elapsed_us = (now - p.refilled_at).to_seconds() * 1e6;
+        p.tokens = std::min(p.burst, p.tokens + elapsed_us * p.rate);
+        p.refilled_at = now;
+    }
+
+    // Time until the bucket holds enough tokens for the pending request.
+    sc_core::sc_time throttle_time(const Port& p) const {
+        double needed = std::min<double>(p.bytes, p.burst) - p.tokens;
+        if (p.rate <= 0.0 || needed <= 0.0) {
+            return sc_core::SC_ZERO_TIME;
+        }
+        return sc_core::sc_time(needed / p.rate, sc_core::SC_US);
+    }
+
+    int select(const bool* eligible) {
+        int winner = -1;
+        unsigned int best = 0;
+
+        if (policy == WEIGHTED) {
+            bool any_credit = false;
+            for (unsigned int i = 0; i < N_INITIATORS; i++) {
+                any_credit |= eligible[i] && ports[i].credits > 0;
+            }
+            if (!any_credit) {
+                for (unsigned int i = 0; i < N_INITIATORS; i++) {
+                    ports[i].credits = ports[i].weight;
+                }
+            }
+        }
+
+        // Scan in round-robin order from the port after the last grant;
+        // ties under FIXED_PRIORITY go to the first port scanned.
+        for (unsigned int n = 1; n <= N_INITIATORS; n++) {
+            unsigned int i = (last_grant + n) % N_INITIATORS;
+            if (!eligible[i]) {
+                continue;
+            }
+            if (policy == ROUND_ROBIN) {
+                return i;
+            }
+            if (policy == WEIGHTED) {
+                if (ports[i].credits > 0) {
+                    ports[i].credits--;
+                    return i;
+                }
+                continue;
+            }
+            unsigned int level = std::max(ports[i].priority, ports[i].qos) + 1;
+            if (level > best) {
+                best = level;
+                winner = i;
+            }
+        }
+        return winner;
+    }
+
+    void arbitrate() {
+        while (true) {
+            sc_core::wait(arbitrate_event);
+            if (granted >= 0) {
+                continue;
+            }
+
+            bool eligible[N_INITIATORS];
+            bool any_pending = false;
+            sc_core::sc_time next_refill;
+            bool throttled = false;
+            for (unsigned int i = 0; i < N_INITIATORS; i++) {
+                Port& p = ports[i];
+                eligible[i] = false;
+                if (!p.pending) {
+                    continue;
+                }
+                any_pending = true;
+                if (p.rate > 0.0) {
+                    refill(p);
+                    sc_core::sc_time t = throttle_time(p);
+                    if (t > sc_core::SC_ZERO_TIME) {
+                        if (!throttled || t < next_refill) {
+                            next_refill = t;
+                        }
+                        throttled = true;
+                        if (!p.throttled) {
+                            p.throttled = true;
+                            p.throttled_since = sc_core::sc_time_stamp();
+                        }
+                        continue;
+                    }
+                }
+                if (p.throttled) {
+                    p.stats.throttled += sc_core::sc_time_stamp() - p.throttled_since;
+                    p.throttled = false;
+                }
+                eligible[i] = true;
+            }
+            if (!any_pending) {
+                continue;
+            }
+
+            int winner = select(eligible);
+            if (winner < 0) {
+                // Everyone pending is out of tokens; retry at the earliest refill.
+                arbitrate_event.notify(next_refill);
+                continue;
+            }
+
+            granted = winner;
+            last_grant = winner;
+            ports[winner].pending = false;
+            grant_event.notify();
+        }
+    }
+
+    Port ports[N_INITIATORS];
+    Policy policy;
+    int granted;
+    unsigned int last_grant;
+    sc_core::sc_event arbitrate_event;
+    sc_core::sc_event grant_event;
+};
+
+#endif
@@ -0,0 +1,173 @@
+#include "cosim_bridge.h"
+#include "tlm_data_path.h"
+#include <iostream>
+#include <sched.h>
+
+namespace {
+
+// Idle back-off: spin, then yield the core, then sleep.
+const unsigned int SPIN_ITERATIONS = 2000;
+const unsigned int YIELD_ITERATIONS = 20000;
+const useconds_t IDLE_SLEEP_US = 20;
+
+} // namespace
+
+CosimBridge::CosimBridge(sc_core::sc_module_name name, CosimChannel* channel, int ready_fd)
+    : sc_core::sc_module(name), socket("socket"), channel(channel), ready_fd(ready_fd),
+      next_ticket(0), served(0), error_count(0) {
+    SC_THREAD(serve);
+}
+
+void CosimBridge::serve() {
+    // Elaboration is complete once the first process runs.
+    cosim_store(&channel->server_ready, 1);
+    if (ready_fd >= 0) {
+        ssize_t written = write(ready_fd, "ready\n", 6);
+        (void)written;
+        close(ready_fd);
+        ready_fd = -1;
+    }
+
+    CosimRequest request;
+    sc_core::sc_time guest_time;
+    for (Wake wake; (wake = wait_for_request(request, guest_time)) != WAKE_SHUTDOWN; ) {
+        sc_core::sc_time qemu_time = guest_time;
+        if (wake == WAKE_REQUEST) {
+            qemu_time = sc_core::sc_time(static_cast<double>(request.time_ns), sc_core::SC_NS);
+        }
+        if (qemu_time > sc_core::sc_time_stamp()) {
+            sc_core::wait(qemu_time - sc_core::sc_time_stamp());
+        }
+        if (wake == WAKE_REQUEST) {
+            handle_request(request);
+        }
+    }
+
+    std::cout << "[Cosim] Shutdown after " << served << " transactions at "
+              << sc_core::sc_time_stamp() << std::endl;
+    sc_core::sc_stop();
+}
+
+CosimBridge::Wake CosimBridge::wait_for_request(CosimRequest& request, sc_core::sc_time& guest_time) {
+    for (unsigned int i = 0; ; i++) {
+        if (cosim_take(channel, next_ticket, &request)) {
+            return WAKE_REQUEST;
+        }
+        if (cosim_load(&channel->shutdown)) {
+            return WAKE_SHUTDOWN;
+        }
+        // Only worth a context switch when some model has work scheduled.
+        uint64_t guest_ns = __atomic_load_n(&channel->guest_time_ns, __ATOMIC_RELAXED);
+        guest_time = sc_core::sc_time(static_cast<double>(guest_ns), sc_core::SC_NS);
+        if (guest_time > sc_core::sc_time_stamp() && sc_core::sc_pending_activity_at_future_time()) {
+            return WAKE_TIME;
+        }
+
+        if (i < SPIN_ITERATIONS) {
+            cosim_cpu_relax();
+        } else if (i < YIELD_ITERATIONS) {
+            sched_yield();
+        } else {
+            usleep(IDLE_SLEEP_US);
+        }
+    }
+}
+
+void CosimBridge::handle_request(const CosimRequest& request) {
+    uint32_t ticket = next_ticket++;
+    bool is_write = request.cmd == COSIM_CMD_WRITE;
+    unsigned char buffer[8];
+    sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+
+    if (request.vcpu >= COSIM_MAX_VCPUS) {
+        error_count++;
+        return;
+    }
+    if (request.size == 0 || request.size > sizeof(buffer)) {
+        error_count++;
+        cosim_respond(channel, request.vcpu, ticket, COSIM_STATUS_ERROR, 0);
+        return;
+    }
+
+    tlm::tlm_generic_payload* trans = pool.allocate();
+    trans->acquire();
+    trans->get_extension<sideband::InitiatorExtension>()->master_id = request.vcpu;
+
+    tlm_data_path::store_le<uint64_t>(buffer, is_write ? request.data : 0);
+    trans->set_command(is_write ? tlm::TLM_WRITE_COMMAND : tlm::TLM_READ_COMMAND);
+    trans->set_address(request.addr);
+    trans->set_data_ptr(buffer);
+    trans->set_data_length(request.size);
+    trans->set_streaming_width(request.size);
+
+    socket->b_transport(*trans, delay);
+
+    if (trans->is_response_error()) {
+        error_count++;
+        cosim_respond(channel, request.vcpu, ticket, COSIM_STATUS_ERROR, 0);
+    } else {
+        // Bytes past `size` are still zero from the store above.
+        uint64_t data = is_write ? 0 : tlm_data_path::load_le<uint64_t>(buffer);
+        cosim_respond(channel, request.vcpu, ticket, COSIM_STATUS_OK, data);
+    }
+    trans->release();
+
+    served++;
+    __atomic_store_n(&channel->transactions, served, __ATOMIC_RELAXED);
+
+    // Charge the access latency after releasing the vCPU.
+    if (delay > sc_core::SC_ZERO_TIME) {
+        sc_core::wait(delay);
+    }
+}
+
+CosimIrqBridge::CosimIrqBridge(sc_core::sc_module_name name, CosimChannel* channel, sc_core::sc_time window)
+    : sc_core::sc_module(name), irq_in("irq_in"), channel(channel), window(window), level(), pulse(),
+      edge_count(0), batch_count(0) {
+    SC_METHOD(sample);
+    sensitive << irq_in;
+    dont_initialize();
+
+    SC_METHOD(publish);
+    sensitive << publish_event;
+    dont_initialize();
+}
+
+void CosimIrqBridge::connect(sc_core::sc_signal<bool>& signal, unsigned int line) {
+    if (line >= COSIM_IRQ_LINES) {
+        SC_REPORT_ERROR("CosimIrqBridge", "NVIC line out of range");
+        return;
+    }
+    irq_in.bind(signal);
+    lines.push_back(line);
+}
+
+void CosimIrqBridge::sample() {
+    bool changed = false;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        uint32_t bit = 1u << (lines[i] % 32);
+        uint32_t& word = level[lines[i] / 32];
+        bool high = irq_in[i]->read();
+        if (high == ((word & bit) != 0)) {
+            continue;
+        }
+        if (high) {
+            pulse[lines[i] / 32] |= bit;
+            edge_count++;
+        }
+        word ^= bit;
+        changed = true;
+    }
+    if (changed) {
+        // An earlier pending notification wins, which bounds the batch.
+        publish_event.notify(window);
+    }
+}
+
+void CosimIrqBridge::publish() {
+    cosim_publish_irqs(channel, level, pulse);
+    for (uint32_t& word : pulse) {
+        word = 0;
+    }
+    batch_count++;
+}
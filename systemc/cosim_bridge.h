@@ -0,0 +1,77 @@
+#ifndef COSIM_BRIDGE_H
+#define COSIM_BRIDGE_H
+
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <vector>
+#include "cosim_channel.h"
+#include "payload_extensions.h"
+
+// Replays MMIO accesses that QEMU posts on a CosimChannel as b_transport
+// calls on `socket`. Accesses from several vCPU threads are served in
+// ring order, each tagged with its vCPU index as master ID. Before each
+// access, simulated time is advanced to QEMU's virtual time. Time-driven
+// peripheral behaviour (the interrupt generator) therefore follows the
+// firmware without a free-running clock.
+//
+// While idle the serving thread spins on the channel, then yields, then
+// sleeps. Simulated time follows the guest time QEMU publishes, so models
+// keep running while firmware sleeps in WFI. The simulation stops once the
+// orchestrator sets channel->shutdown.
+class CosimBridge : public sc_core::sc_module {
+public:
+    tlm_utils::simple_initiator_socket<CosimBridge> socket;
+
+    SC_HAS_PROCESS(CosimBridge);
+    CosimBridge(sc_core::sc_module_name name, CosimChannel* channel, int ready_fd = -1);
+
+    uint64_t transactions() const { return served; }
+    unsigned int errors() const { return error_count; }
+
+private:
+    void serve();
+    enum Wake { WAKE_REQUEST, WAKE_TIME, WAKE_SHUTDOWN };
+    Wake wait_for_request(CosimRequest& request, sc_core::sc_time& guest_time);
+    void handle_request(const CosimRequest& request);
+
+    CosimChannel* channel;
+    int ready_fd;
+    uint32_t next_ticket;
+    uint64_t served;
+    unsigned int error_count;
+    sideband::PayloadPool pool;
+};
+
+// Forwards model interrupt outputs to NVIC lines in QEMU. Changes within
+// `window` of simulated time after the first one are published as one
+// batch. With the default of zero, that covers every change in the same
+// time step.
+class CosimIrqBridge : public sc_core::sc_module {
+public:
+    SC_HAS_PROCESS(CosimIrqBridge);
+    CosimIrqBridge(sc_core::sc_module_name name, CosimChannel* channel,
+                   sc_core::sc_time window = sc_core::SC_ZERO_TIME);
+
+    // Routes `signal` to NVIC line `line`; call before sc_start().
+    void connect(sc_core::sc_signal<bool>& signal, unsigned int line);
+
+    uint64_t edges() const { return edge_count; }
+    uint64_t batches() const { return batch_count; }
+
+private:
+    void sample();
+    void publish();
+
+    sc_core::sc_port<sc_core::sc_signal_in_if<bool>, 0, sc_core::SC_ZERO_OR_MORE_BOUND> irq_in;
+    std::vector<unsigned int> lines;
+    CosimChannel* channel;
+    sc_core::sc_time window;
+    sc_core::sc_event publish_event;
+    uint32_t level[COSIM_IRQ_WORDS];
+    uint32_t pulse[COSIM_IRQ_WORDS];
+    uint64_t edge_count;
+    uint64_t batch_count;
+};
+
+#endif
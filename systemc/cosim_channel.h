@@ -0,0 +1,249 @@
+#ifndef COSIM_CHANNEL_H
+#define COSIM_CHANNEL_H
+
+// Shared-memory channel between one QEMU instance and one SystemC server.
+// Plain C so QEMU's device code and the C++ side share the layout.
+//
+// The orchestrator creates the segment. Requests travel through a
+// bounded multi-producer, single-consumer ring, so vCPU threads post MMIO
+// accesses without a lock.
+//
+// - A producer claims a ticket with an atomic increment of req_head.
+// - It waits until its slot's seq equals the ticket, fills the slot, and
+//   publishes seq = ticket + 1.
+// - The server consumes tickets in order. It hands the slot back with
+//   seq = ticket + COSIM_RING_SIZE.
+// - The answer goes to the posting vCPU's own response slot, published
+//   as seq = ticket + 1.
+//
+// Each vCPU has at most one access in flight. A ring of at least
+// COSIM_MAX_VCPUS slots is therefore never full. Every slot has its own
+// cache line.
+//
+// Interrupts flow the other way as bitmaps indexed by NVIC line. The
+// server publishes a batch by storing irq_level, OR-ing rising edges into
+// irq_pulse and then bumping irq_seq. QEMU polls irq_seq and applies every
+// change since its last poll at once, so a burst of edges costs one
+// synchronisation. A pulse keeps an edge visible even if the line has
+// already dropped again. QEMU also publishes its virtual time there. An
+// idle server can then run time-driven models without waiting for the
+// next access.
+
+#include <fcntl.h>
+#include <sched.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define COSIM_MAGIC 0x4353484Du     /* "CSHM" */
+#define COSIM_VERSION 3
+#define COSIM_CACHE_LINE 64
+#define COSIM_MAX_VCPUS 16
+#define COSIM_RING_SIZE 16          /* power of two, >= COSIM_MAX_VCPUS */
+#define COSIM_SPIN_LIMIT 1000       /* spins before waiters start yielding */
+#define COSIM_IRQ_LINES 96          /* matches the armv7m num-irq */
+#define COSIM_IRQ_WORDS (COSIM_IRQ_LINES / 32)
+
+enum {
+    COSIM_CMD_READ = 0,
+    COSIM_CMD_WRITE = 1,
+};
+
+enum {
+    COSIM_STATUS_OK = 0,
+    COSIM_STATUS_ERROR = 1,
+    COSIM_STATUS_SHUTDOWN = 2,
+};
+
+typedef struct {
+    uint32_t seq;
+    uint32_t cmd;
+    uint32_t size;              // 1, 2, 4 or 8 bytes
+    uint32_t vcpu;              // posting vCPU, the TLM master ID
+    uint64_t addr;              // offset into the bridged window
+    uint64_t data;
+    uint64_t time_ns;           // QEMU virtual time of the access
+    char pad[COSIM_CACHE_LINE - 40];
+} CosimRequest;
+
+typedef struct {
+    uint32_t seq;
+    uint32_t status;
+    uint64_t data;
+    char pad[COSIM_CACHE_LINE - 16];
+} CosimResponse;
+
+typedef struct {
+    // Control, written once per run.
+    uint32_t magic;
+    uint32_t version;
+    uint32_t server_ready;      // set by the server after elaboration
+    uint32_t shutdown;          // set by the orchestrator when QEMU exits
+    uint64_t transactions;      // completed by the server
+    char pad0[COSIM_CACHE_LINE - 24];
+
+    uint32_t req_head;          // next ticket, claimed by producers
+    char pad1[COSIM_CACHE_LINE - 4];
+
+    // Interrupts, written by the server and drained by QEMU.
+    uint32_t irq_seq;           // bumped once per published batch
+    uint32_t irq_level[COSIM_IRQ_WORDS];
+    uint32_t irq_pulse[COSIM_IRQ_WORDS]; // rising edges since the last drain
+    char pad2[COSIM_CACHE_LINE - 4 - 8 * COSIM_IRQ_WORDS];
+
+    uint64_t guest_time_ns;     // QEMU virtual time, refreshed on each poll
+    char pad3[COSIM_CACHE_LINE - 8];
+
+    CosimRequest ring[COSIM_RING_SIZE];
+    CosimResponse responses[COSIM_MAX_VCPUS];
+} CosimChannel;
+
+static inline uint32_t cosim_load(const uint32_t *p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void cosim_store(uint32_t *p, uint32_t value)
+{
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+static inline void cosim_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Spins briefly, then yields so an oversubscribed host still makes
+// progress when the other side is descheduled.
+static inline void cosim_backoff(unsigned int *spins)
+{
+    if (*spins < COSIM_SPIN_LIMIT) {
+        (*spins)++;
+        cosim_cpu_relax();
+    } else {
+        sched_yield();
+    }
+}
+
+// Producer side: posts one access and returns its ticket.
+static inline uint32_t cosim_post(CosimChannel *channel, uint32_t vcpu, uint32_t cmd, uint32_t size,
+                                  uint64_t addr, uint64_t data, uint64_t time_ns)
+{
+    uint32_t ticket = __atomic_fetch_add(&channel->req_head, 1, __ATOMIC_RELAXED);
+    CosimRequest *slot = &channel->ring[ticket & (COSIM_RING_SIZE - 1)];
+    unsigned int spins = 0;
+
+    while (cosim_load(&slot->seq) != ticket) {
+        cosim_backoff(&spins);
+    }
+    slot->cmd = cmd;
+    slot->size = size;
+    slot->vcpu = vcpu;
+    slot->addr = addr;
+    slot->data = data;
+    slot->time_ns = time_ns;
+    cosim_store(&slot->seq, ticket + 1);
+    return ticket;
+}
+
+// Producer side: waits for the answer to `ticket`. Returns
+// COSIM_STATUS_SHUTDOWN if the run ends first.
+static inline uint32_t cosim_wait_response(CosimChannel *channel, uint32_t vcpu, uint32_t ticket,
+                                           uint64_t *data)
+{
+    CosimResponse *response = &channel->responses[vcpu];
+    unsigned int spins = 0;
+
+    while (cosim_load(&response->seq) != ticket + 1) {
+        if (cosim_load(&channel->shutdown)) {
+            return COSIM_STATUS_SHUTDOWN;
+        }
+        cosim_backoff(&spins);
+    }
+    *data = response->data;
+    return response->status;
+}
+
+// Consumer side: copies out request `ticket` if it has been published.
+static inline int cosim_take(CosimChannel *channel, uint32_t ticket, CosimRequest *request)
+{
+    CosimRequest *slot = &channel->ring[ticket & (COSIM_RING_SIZE - 1)];
+
+    if (cosim_load(&slot->seq) != ticket + 1) {
+        return 0;
+    }
+    *request = *slot;
+    cosim_store(&slot->seq, ticket + COSIM_RING_SIZE);
+    return 1;
+}
+
+// Server side: publishes one batch of line levels and rising edges.
+static inline void cosim_publish_irqs(CosimChannel *channel, const uint32_t *level,
+                                      const uint32_t *pulse)
+{
+    for (int i = 0; i < COSIM_IRQ_WORDS; i++) {
+        __atomic_store_n(&channel->irq_level[i], level[i], __ATOMIC_RELAXED);
+        if (pulse[i]) {
+            __atomic_fetch_or(&channel->irq_pulse[i], pulse[i], __ATOMIC_RELAXED);
+        }
+    }
+    __atomic_fetch_add(&channel->irq_seq, 1, __ATOMIC_RELEASE);
+}
+
+static inline void cosim_respond(CosimChannel *channel, uint32_t vcpu, uint32_t ticket,
+                                 uint32_t status, uint64_t data)
+{
+    CosimResponse *response = &channel->responses[vcpu];
+
+    response->status = status;
+    response->data = data;
+    cosim_store(&response->seq, ticket + 1);
+}
+
+// Maps the segment `name` (a POSIX shm name, "/cosim-..."). With create
+// set it is created exclusively, sized and initialised. Returns NULL on
+// failure.
+static inline CosimChannel *cosim_channel_open(const char *name, int create)
+{
+    int fd = shm_open(name, create ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR, 0600);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (create && ftruncate(fd, sizeof(CosimChannel)) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+
+    void *mem = mmap(NULL, sizeof(CosimChannel), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        return NULL;
+    }
+
+    CosimChannel *channel = (CosimChannel *)mem;
+    if (create) {
+        for (uint32_t i = 0; i < COSIM_RING_SIZE; i++) {
+            channel->ring[i].seq = i;
+        }
+        channel->magic = COSIM_MAGIC;
+        channel->version = COSIM_VERSION;
+    } else if (channel->magic != COSIM_MAGIC || channel->version != COSIM_VERSION) {
+        munmap(mem, sizeof(CosimChannel));
+        return NULL;
+    }
+    return channel;
+}
+
+static inline void cosim_channel_close(CosimChannel *channel)
+{
+    munmap(channel, sizeof(CosimChannel));
+}
+
+#endif
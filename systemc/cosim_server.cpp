@@ -0,0 +1,113 @@
+// SystemC side of one co-simulation pair: serves the peripheral model to
+// a QEMU instance over a shared-memory channel created by the
+// orchestrator (tools/cosim). Readiness is reported on --ready-fd once
+// the design is elaborated. The peripheral interrupt drives NVIC line
+// --irq-line (default 0). Edges within --irq-window-ns of each other are
+// delivered to QEMU as one batch.
+//
+// With --map firmware the window instead holds the timer, UART and GPIO
+// models that firmware/src/peripheral.rs drives, at the offsets of their
+// addresses from 0x40000000 (the same map as host_bridge.cpp).
+
+#include <systemc>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "cosim_bridge.h"
+#include "cosim_channel.h"
+#include "firmware_peripherals.h"
+#include "peripheral_model.h"
+#include "router.h"
+
+namespace {
+
+const sc_dt::uint64 TIMER_OFFSET = 0x0;
+const sc_dt::uint64 UART_OFFSET = 0x4400;
+const sc_dt::uint64 GPIO_OFFSET = 0x20000;
+const sc_dt::uint64 REGION_SIZE = 0x400;
+
+class FirmwareMap : public sc_core::sc_module {
+public:
+    Router<3> router;
+    TimerModel timer;
+    UartModel uart;
+    GpioModel gpio;
+
+    SC_CTOR(FirmwareMap) : router("router"), timer("timer"), uart("uart"), gpio("gpio") {
+        router.map(0, TIMER_OFFSET, REGION_SIZE);
+        router.map(1, UART_OFFSET, REGION_SIZE);
+        router.map(2, GPIO_OFFSET, REGION_SIZE);
+        router.initiator_socket[0]->bind(timer.socket);
+        router.initiator_socket[1]->bind(uart.socket);
+        router.initiator_socket[2]->bind(gpio.socket);
+    }
+};
+
+} // namespace
+
+int sc_main(int argc, char* argv[]) {
+    std::string shm_name;
+    int ready_fd = -1;
+    unsigned int irq_line = 0;
+    unsigned int irq_window_ns = 0;
+    std::string map = "peripheral";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--shm" && i + 1 < argc) {
+            shm_name = argv[++i];
+        } else if (arg == "--ready-fd" && i + 1 < argc) {
+            ready_fd = std::atoi(argv[++i]);
+        } else if (arg == "--irq-line" && i + 1 < argc) {
+            irq_line = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--irq-window-ns" && i + 1 < argc) {
+            irq_window_ns = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--map" && i + 1 < argc) {
+            map = argv[++i];
+        } else {
+            shm_name.clear();
+            break;
+        }
+    }
+    if (shm_name.empty() || irq_line >= COSIM_IRQ_LINES || (map != "peripheral" && map != "firmware")) {
+        std::cerr << "Usage: " << argv[0] << " --shm /name [--ready-fd fd] [--irq-line n]"
+                  << " [--irq-window-ns ns] [--map peripheral|firmware]" << std::endl;
+        return 2;
+    }
+
+    CosimChannel* channel = cosim_channel_open(shm_name.c_str(), 0);
+    if (!channel) {
+        std::cerr << "[Cosim] Cannot map channel " << shm_name << std::endl;
+        return 1;
+    }
+
+    CosimBridge bridge("bridge", channel, ready_fd);
+    CosimIrqBridge irq_bridge("irq_bridge", channel, sc_core::sc_time(irq_window_ns, sc_core::SC_NS));
+    sc_core::sc_signal<bool> peripheral_irq("peripheral_irq");
+    std::unique_ptr<PeripheralModel<>> peripheral;
+    std::unique_ptr<FirmwareMap> firmware;
+    if (map == "firmware") {
+        firmware.reset(new FirmwareMap("firmware"));
+        bridge.socket.bind(firmware->router.target_socket);
+    } else {
+        peripheral.reset(new PeripheralModel<>("peripheral"));
+        bridge.socket.bind(peripheral->socket);
+        peripheral->irq(peripheral_irq);
+        irq_bridge.connect(peripheral_irq, irq_line);
+    }
+
+    sc_core::sc_start();
+
+    std::cout << "[Cosim] " << bridge.transactions() << " transactions, " << bridge.errors()
+              << " errors, " << irq_bridge.edges() << " interrupts in " << irq_bridge.batches()
+              << " batches, " << sc_core::sc_time_stamp().to_seconds() * 1e6 << " us simulated"
+              << std::endl;
+    if (firmware) {
+        std::cout << "[Cosim] UART: " << firmware->uart.tx_bytes() << " bytes sent, GPIO: "
+                  << firmware->gpio.toggles() << " pin changes" << std::endl;
+    }
+    cosim_channel_close(channel);
+    return bridge.errors() == 0 ? 0 : 1;
+}
@@ -0,0 +1,278 @@
+#include "dma_controller.h"
+#include "tlm_data_path.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+template <unsigned int BUSWIDTH>
+DmaController<BUSWIDTH>::DmaController(sc_core::sc_module_name name, unsigned int burst_bytes,
+                                       sc_core::sc_time quantum)
+    : sc_core::sc_module(name), cfg_socket("cfg_socket"), bus_socket("bus_socket"), irq("irq"),
+      control_register(0), status_register(0), desc_addr_register(0), bytes_done(0),
+      descriptors_done(0), burst_bytes(burst_bytes), dmi_enabled(true), quantum(quantum),
+      buffer(burst_bytes) {
+    sc_assert(burst_bytes > 0);
+    cfg_socket.register_b_transport(this, &DmaController::b_transport);
+    bus_socket.register_invalidate_direct_mem_ptr(this, &DmaController::invalidate_direct_mem_ptr);
+
+    SC_THREAD(run);
+    SC_METHOD(update_irq);
+    this->sensitive << irq_update_event;
+}
+
+template <unsigned int BUSWIDTH>
+void DmaController<BUSWIDTH>::b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+    sc_dt::uint64 addr = trans.get_address();
+    unsigned char* ptr = trans.get_data_ptr();
+
+    if (trans.get_data_length() != 4 || (addr & 0x3)) {
+        trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
+        return;
+    }
+
+    uint32_t offset = addr & 0xFF;
+    if (trans.is_read()) {
+        uint32_t value;
+        switch (offset) {
+            case CTRL_REG_OFFSET:
+                value = control_register;
+                break;
+            case STATUS_REG_OFFSET:
+                value = status_register;
+                break;
+            case DESC_ADDR_REG_OFFSET:
+                value = desc_addr_register;
+                break;
+            case BYTES_DONE_REG_OFFSET:
+                value = static_cast<uint32_t>(bytes_done);
+                break;
+            case DESC_DONE_REG_OFFSET:
+                value = descriptors_done;
+                break;
+            default:
+                trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+                return;
+        }
+        tlm_data_path::store_le<uint32_t>(ptr, value);
+    } else if (trans.is_write()) {
+        uint32_t value = tlm_data_path::load_le<uint32_t>(ptr);
+        switch (offset) {
+            case CTRL_REG_OFFSET:
+                control_register = value & (CTRL_IRQ_ENABLE | CTRL_ABORT);
+                if ((value & CTRL_START) && !(status_register & STATUS_BUSY)) {
+                    status_register = STATUS_BUSY;
+                    start_event.notify(delay);
+                }
+                break;
+            case STATUS_REG_OFFSET:
+                status_register &= ~(value & (STATUS_DONE | STATUS_ERROR | STATUS_ABORTED));  // write 1 to clear
+                break;
+            case DESC_ADDR_REG_OFFSET:
+                desc_addr_register = value;
+                break;
+            default:
+                trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+                return;
+        }
+        irq_update_event.notify(delay);
+    }
+
+    trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    delay += sc_core::sc_time(10, sc_core::SC_NS);
+}
+
+template <unsigned int BUSWIDTH>
+void DmaController<BUSWIDTH>::run() {
+    while (true) {
+        sc_core::wait(start_event);
+
+        uint32_t addr = desc_addr_register;
+        bool ok = true;
+        while (addr != 0 && !(control_register & CTRL_ABORT)) {
+            Descriptor desc;
+            ok = fetch_descriptor(addr, desc) && transfer(desc);
+            if (!ok) {
+                break;
+            }
+
+            descriptors_done++;
+            if (desc.control & DESC_IRQ) {
+                sync(true);
+                status_register |= STATUS_DONE;
+                irq_update_event.notify();
+            }
+            addr = desc.next;
+        }
+        sync(true);
+
+        uint32_t outcome = !ok ? STATUS_ERROR : (addr != 0 ? STATUS_ABORTED : STATUS_DONE);
+        control_register &= ~CTRL_ABORT;
+        status_register = (status_register & ~STATUS_BUSY) | outcome;
+        irq_update_event.notify();
+    }
+}
+
+template <unsigned int BUSWIDTH>
+bool DmaController<BUSWIDTH>::fetch_descriptor(uint32_t addr, Descriptor& desc) {
+    unsigned char raw[16];
+    if (!transport(tlm::TLM_READ_COMMAND, addr, raw, sizeof(raw))) {
+        return false;
+    }
+    desc.src = tlm_data_path::load_le<uint32_t>(raw + 0x0);
+    desc.dst = tlm_data_path::load_le<uint32_t>(raw + 0x4);
+    desc.control = tlm_data_path::load_le<uint32_t>(raw + 0x8);
+    desc.next = tlm_data_path::load_le<uint32_t>(raw + 0xC);
+    return true;
+}
+
+template <unsigned int BUSWIDTH>
+bool DmaController<BUSWIDTH>::transfer(const Descriptor& desc) {
+    bool fixed_src = desc.control & DESC_FIXED_SRC;
+    bool fixed_dst = desc.control & DESC_FIXED_DST;
+    uint32_t remaining = desc.control & DESC_LENGTH_MASK;
+    sc_dt::uint64 src = desc.src;
+    sc_dt::uint64 dst = desc.dst;
+
+    while (remaining > 0) {
+        sc_core::sc_time read_latency;
+        sc_core::sc_time write_latency;
+        unsigned int n = remaining;
+
+        // When DMI covers both ends, move the rest of the descriptor at once.
+        unsigned char* src_ptr = fixed_src ? nullptr : dmi_pointer(src, n, false, read_latency);
+        unsigned char* dst_ptr = fixed_dst ? nullptr : dmi_pointer(dst, n, true, write_latency);
+        if (src_ptr && dst_ptr) {
+            std::memmove(dst_ptr, src_ptr, n);
+            local_time += (read_latency + write_latency) * beats(n);
+        } else {
+            n = std::min(burst_bytes, remaining);
+            src_ptr = fixed_src ? nullptr : dmi_pointer(src, n, false, read_latency);
+            dst_ptr = fixed_dst ? nullptr : dmi_pointer(dst, n, true, write_latency);
+
+            if (src_ptr) {
+                std::memcpy(buffer.data(), src_ptr, n);
+                local_time += read_latency * beats(n);
+            } else if (!transport(tlm::TLM_READ_COMMAND, src, buffer.data(), n, fixed_src)) {
+                return false;
+            }
+
+            if (dst_ptr) {
+                std::memcpy(dst_ptr, buffer.data(), n);
+                local_time += write_latency * beats(n);
+            } else if (!transport(tlm::TLM_WRITE_COMMAND, dst, buffer.data(), n, fixed_dst)) {
+                return false;
+            }
+        }
+
+        if (!fixed_src) {
+            src += n;
+        }
+        if (!fixed_dst) {
+            dst += n;
+        }
+        remaining -= n;
+        bytes_done += n;
+        sync();
+    }
+    return true;
+}
+
+template <unsigned int BUSWIDTH>
+bool DmaController<BUSWIDTH>::transport(tlm::tlm_command cmd, sc_dt::uint64 addr,
+                                        unsigned char* data, unsigned int len, bool fixed) {
+    trans.set_command(cmd);
+    trans.set_address(addr);
+    trans.set_data_ptr(data);
+    trans.set_data_length(len);
+    // A fixed address streams: every beat goes to the same bus word.
+    trans.set_streaming_width(fixed ? std::min(len, BUSWIDTH / 8) : len);
+    trans.set_byte_enable_ptr(nullptr);
+    trans.set_byte_enable_length(0);
+    trans.set_dmi_allowed(false);
+    trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+    bus_socket->b_transport(trans, local_time);
+    sync();
+
+    if (trans.is_response_error()) {
+        std::cout << "[DMA] " << trans.get_response_string() << " at 0x" << std::hex << addr
+                  << std::dec << std::endl;
+        return false;
+    }
+
+    // Ask for DMI once the target has hinted that it would grant it, for
+    // the access of this transport (the command), unless it is cached.
+    bool write = cmd == tlm::TLM_WRITE_COMMAND;
+    if (dmi_enabled && trans.is_dmi_allowed() && !find_dmi(addr, len, write)) {
+        tlm::tlm_dmi dmi;
+        if (bus_socket->get_direct_mem_ptr(trans, dmi) &&
+            (write ? dmi.is_write_allowed() : dmi.is_read_allowed())) {
+            cache_dmi(dmi);
+        }
+    }
+    return true;
+}
+
+// A new grant replaces the cached regions it overlaps, so the cache holds
+// disjoint regions, at most one per target window.
+template <unsigned int BUSWIDTH>
+void DmaController<BUSWIDTH>::cache_dmi(const tlm::tlm_dmi& dmi) {
+    invalidate_direct_mem_ptr(dmi.get_start_address(), dmi.get_end_address());
+    dmi_regions.push_back(dmi);
+}
+
+template <unsigned int BUSWIDTH>
+const tlm::tlm_dmi* DmaController<BUSWIDTH>::find_dmi(sc_dt::uint64 addr, unsigned int len, bool write) const {
+    for (const tlm::tlm_dmi& dmi : dmi_regions) {
+        bool allowed = write ? dmi.is_write_allowed() : dmi.is_read_allowed();
+        if (allowed && addr >= dmi.get_start_address() &&
+            addr + len - 1 <= dmi.get_end_address()) {
+            return &dmi;
+        }
+    }
+    return nullptr;
+}
+
+// Returns the host pointer for [addr, addr + len) if a cached DMI region
+// with the required access covers it.
+template <unsigned int BUSWIDTH>
+unsigned char* DmaController<BUSWIDTH>::dmi_pointer(sc_dt::uint64 addr, unsigned int len, bool write,
+                                                    sc_core::sc_time& latency) {
+    const tlm::tlm_dmi* dmi = dmi_enabled ? find_dmi(addr, len, write) : nullptr;
+    if (!dmi) {
+        return nullptr;
+    }
+    latency = write ? dmi->get_write_latency() : dmi->get_read_latency();
+    return dmi->get_dmi_ptr() + (addr - dmi->get_start_address());
+}
+
+template <unsigned int BUSWIDTH>
+void DmaController<BUSWIDTH>::invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end) {
+    dmi_regions.erase(
+        std::remove_if(dmi_regions.begin(), dmi_regions.end(),
+                       [start, end](const tlm::tlm_dmi& dmi) {
+                           return dmi.get_start_address() <= end && dmi.get_end_address() >= start;
+                       }),
+        dmi_regions.end());
+}
+
+// Runs ahead of simulated time up to one quantum before yielding.
+template <unsigned int BUSWIDTH>
+void DmaController<BUSWIDTH>::sync(bool force) {
+    if (local_time >= quantum || (force && local_time > sc_core::SC_ZERO_TIME)) {
+        sc_core::wait(local_time);
+        local_time = sc_core::SC_ZERO_TIME;
+    }
+}
+
+template <unsigned int BUSWIDTH>
+void DmaController<BUSWIDTH>::update_irq() {
+    bool pending = status_register & (STATUS_DONE | STATUS_ERROR | STATUS_ABORTED);
+    irq.write(pending && (control_register & CTRL_IRQ_ENABLE));
+}
+
+template class DmaController<32>;
+template class DmaController<64>;
+template class DmaController<128>;
+template class DmaController<256>;
+template class DmaController<512>;
@@ -0,0 +1,107 @@
+#ifndef DMA_CONTROLLER_H
+#define DMA_CONTROLLER_H
+
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <tlm_utils/simple_target_socket.h>
+#include <vector>
+
+// Scatter-gather DMA engine.
+//
+// Software writes the address of the first descriptor to DESC_ADDR and
+// sets CTRL.START. Each descriptor is four little-endian words in memory:
+//
+//   +0x0  source address
+//   +0x4  destination address
+//   +0x8  [23:0] length in bytes, [24] IRQ on completion,
+//         [25] fixed source address, [26] fixed destination address
+//   +0xC  next descriptor address, 0 ends the chain
+//
+// Transfers use DMI whenever the target grants it for both ends and fall
+// back to bursts of `burst_bytes` over `bus_socket` otherwise. DMI is
+// requested for the access a transport made, and a grant replaces any
+// cached region it overlaps. Fixed addresses (peripheral FIFOs) never use
+// DMI; their bursts have a streaming width of one bus word. A chain ends
+// with STATUS.DONE, STATUS.ERROR on a failed access, or STATUS.ABORTED if
+// CTRL.ABORT stopped it early. `irq` is raised while any of the three is
+// set and CTRL.IRQ_ENABLE is 1. `burst_bytes` must be nonzero.
+template <unsigned int BUSWIDTH = 32>
+class DmaController : public sc_core::sc_module {
+public:
+    tlm_utils::simple_target_socket<DmaController, 32> cfg_socket;
+    tlm_utils::simple_initiator_socket<DmaController, BUSWIDTH> bus_socket;
+    sc_core::sc_out<bool> irq;
+
+    SC_HAS_PROCESS(DmaController);
+    DmaController(sc_core::sc_module_name name, unsigned int burst_bytes = 256,
+                  sc_core::sc_time quantum = sc_core::sc_time(1, sc_core::SC_US));
+
+    virtual void b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
+
+    // Disable DMI, e.g. to compare DMI against burst throughput.
+    void set_dmi_enabled(bool enabled) { dmi_enabled = enabled; }
+
+    sc_dt::uint64 bytes_transferred() const { return bytes_done; }
+    unsigned int descriptors_completed() const { return descriptors_done; }
+
+    static const uint32_t CTRL_REG_OFFSET = 0x00;
+    static const uint32_t STATUS_REG_OFFSET = 0x04;
+    static const uint32_t DESC_ADDR_REG_OFFSET = 0x08;
+    static const uint32_t BYTES_DONE_REG_OFFSET = 0x0C;
+    static const uint32_t DESC_DONE_REG_OFFSET = 0x10;
+
+    static const uint32_t CTRL_START = 1u << 0;
+    static const uint32_t CTRL_IRQ_ENABLE = 1u << 1;
+    static const uint32_t CTRL_ABORT = 1u << 2;
+
+    static const uint32_t STATUS_BUSY = 1u << 0;
+    static const uint32_t STATUS_DONE = 1u << 1;
+    static const uint32_t STATUS_ERROR = 1u << 2;
+    static const uint32_t STATUS_ABORTED = 1u << 3;
+
+    static const uint32_t DESC_LENGTH_MASK = 0x00FFFFFF;
+    static const uint32_t DESC_IRQ = 1u << 24;
+    static const uint32_t DESC_FIXED_SRC = 1u << 25;
+    static const uint32_t DESC_FIXED_DST = 1u << 26;
+
+private:
+    struct Descriptor {
+        uint32_t src;
+        uint32_t dst;
+        uint32_t control;
+        uint32_t next;
+    };
+
+    void run();
+    bool fetch_descriptor(uint32_t addr, Descriptor& desc);
+    bool transfer(const Descriptor& desc);
+    bool transport(tlm::tlm_command cmd, sc_dt::uint64 addr, unsigned char* data, unsigned int len,
+                   bool fixed = false);
+    unsigned char* dmi_pointer(sc_dt::uint64 addr, unsigned int len, bool write, sc_core::sc_time& latency);
+    const tlm::tlm_dmi* find_dmi(sc_dt::uint64 addr, unsigned int len, bool write) const;
+    void cache_dmi(const tlm::tlm_dmi& dmi);
+    void invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end);
+    void sync(bool force = false);
+    static unsigned int beats(unsigned int len) { return (len + BUSWIDTH / 8 - 1) / (BUSWIDTH / 8); }
+    void update_irq();
+
+    uint32_t control_register;
+    uint32_t status_register;
+    uint32_t desc_addr_register;
+    sc_dt::uint64 bytes_done;
+    unsigned int descriptors_done;
+
+    unsigned int burst_bytes;
+    bool dmi_enabled;
+    sc_core::sc_time quantum;
+    sc_core::sc_time local_time;
+    sc_core::sc_event start_event;
+    sc_core::sc_event irq_update_event;
+
+    std::vector<tlm::tlm_dmi> dmi_regions;
+    std::vector<unsigned char> buffer;
+    tlm::tlm_generic_payload trans;
+};
+
+#endif
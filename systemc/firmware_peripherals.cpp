@@ -0,0 +1,152 @@
+#include "firmware_peripherals.h"
+#include "tlm_data_path.h"
+#include <iostream>
+
+namespace {
+
+const sc_core::sc_time REGISTER_LATENCY(10, sc_core::SC_NS);
+
+// Accepts 1, 2 or 4 byte accesses starting at a register boundary.
+bool check_access(tlm::tlm_generic_payload& trans) {
+    unsigned int len = trans.get_data_length();
+    if (!tlm_data_path::is_supported_length(len, 4) || (trans.get_address() & 0x3) ||
+        tlm_data_path::has_byte_enables(trans)) {
+        trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
+        return false;
+    }
+    return true;
+}
+
+uint32_t write_value(const tlm::tlm_generic_payload& trans) {
+    return tlm_data_path::insert_lanes(trans.get_data_ptr(), 0, trans.get_data_length());
+}
+
+void read_value(tlm::tlm_generic_payload& trans, uint32_t value) {
+    unsigned int len = trans.get_data_length();
+    tlm_data_path::extract_lanes(trans.get_data_ptr(), value, 0, len, (1u << len) - 1);
+}
+
+} // namespace
+
+UartModel::UartModel(sc_core::sc_module_name name)
+    : sc_core::sc_module(name), socket("socket"), tx_count(0) {
+    socket.register_b_transport(this, &UartModel::b_transport);
+}
+
+void UartModel::b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+    if (!check_access(trans)) {
+        return;
+    }
+
+    uint32_t offset = trans.get_address();
+    if (offset == DATA_REG_OFFSET && trans.is_write()) {
+        char c = static_cast<char>(write_value(trans) & 0xFF);
+        tx_count++;
+        if (c == '\n') {
+            std::cout << "[UART] " << tx_line << std::endl;
+            tx_line.clear();
+        } else {
+            tx_line += c;
+        }
+    } else if (offset == DATA_REG_OFFSET && trans.is_read()) {
+        uint8_t byte = 0;
+        if (!rx_fifo.empty()) {
+            byte = rx_fifo.front();
+            rx_fifo.pop_front();
+        }
+        read_value(trans, byte);
+    } else if (offset == STATUS_REG_OFFSET && trans.is_read()) {
+        read_value(trans, (rx_fifo.empty() ? 0x0 : 0x1) | 0x2);
+    } else if (offset != STATUS_REG_OFFSET) {
+        trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+        return;
+    }
+
+    trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    delay += REGISTER_LATENCY;
+}
+
+GpioModel::GpioModel(sc_core::sc_module_name name)
+    : sc_core::sc_module(name), socket("socket"), mode_register(0), out_register(0), toggle_count(0) {
+    socket.register_b_transport(this, &GpioModel::b_transport);
+}
+
+void GpioModel::b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+    if (!check_access(trans)) {
+        return;
+    }
+
+    uint32_t* reg;
+    switch (trans.get_address()) {
+        case MODE_REG_OFFSET:
+            reg = &mode_register;
+            break;
+        case OUT_REG_OFFSET:
+            reg = &out_register;
+            break;
+        default:
+            trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+            return;
+    }
+
+    if (trans.is_read()) {
+        read_value(trans, *reg);
+    } else if (trans.is_write()) {
+        uint32_t value = write_value(trans);
+        if (reg == &out_register) {
+            uint32_t changed = value ^ out_register;
+            for (unsigned int pin = 0; changed; ++pin, changed >>= 1) {
+                if (changed & 1) {
+                    toggle_count++;
+                    std::cout << "[GPIO] Pin " << std::dec << pin << " -> " << ((value >> pin) & 1)
+                              << " at " << (sc_core::sc_time_stamp() + delay) << std::endl;
+                }
+            }
+        }
+        *reg = value;
+    }
+
+    trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    delay += REGISTER_LATENCY;
+}
+
+TimerModel::TimerModel(sc_core::sc_module_name name)
+    : sc_core::sc_module(name), socket("socket"), control_register(0) {
+    socket.register_b_transport(this, &TimerModel::b_transport);
+}
+
+void TimerModel::b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+    if (!check_access(trans)) {
+        return;
+    }
+
+    sc_core::sc_time now = sc_core::sc_time_stamp() + delay;
+    switch (trans.get_address()) {
+        case CTRL_REG_OFFSET:
+            if (trans.is_read()) {
+                read_value(trans, control_register);
+            } else if (trans.is_write()) {
+                uint32_t value = write_value(trans);
+                if ((value & 0x1) && !(control_register & 0x1)) {
+                    start_time = now;
+                }
+                control_register = value;
+            }
+            break;
+        case COUNT_REG_OFFSET:
+            if (trans.is_read()) {
+                uint32_t count = 0;
+                if (control_register & 0x1) {
+                    count = static_cast<uint32_t>((now - start_time) / sc_core::sc_time(1, sc_core::SC_MS));
+                }
+                read_value(trans, count);
+            }
+            break;
+        default:
+            trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+            return;
+    }
+
+    trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    delay += REGISTER_LATENCY;
+}
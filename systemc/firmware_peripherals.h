@@ -0,0 +1,86 @@
+#ifndef FIRMWARE_PERIPHERALS_H
+#define FIRMWARE_PERIPHERALS_H
+
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_target_socket.h>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+// TLM models of the peripherals firmware/src/peripheral.rs drives, with
+// the same register maps. Registers are 32 bits wide; byte and halfword
+// accesses reach the low lanes. None of them call wait(), so they can be
+// driven from outside a SystemC process (see host_bridge.h).
+
+// UART at 0x4000_4400.
+//   +0x0 DATA    write: transmit low byte; read: pop one RX byte
+//   +0x4 STATUS  [0] RX data ready, [1] TX empty (always set)
+class UartModel : public sc_core::sc_module {
+public:
+    tlm_utils::simple_target_socket<UartModel> socket;
+
+    SC_HAS_PROCESS(UartModel);
+    UartModel(sc_core::sc_module_name name);
+
+    void b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
+
+    void push_rx(uint8_t byte) { rx_fifo.push_back(byte); }
+    uint64_t tx_bytes() const { return tx_count; }
+
+    static const uint32_t DATA_REG_OFFSET = 0x0;
+    static const uint32_t STATUS_REG_OFFSET = 0x4;
+
+private:
+    std::deque<uint8_t> rx_fifo;
+    std::string tx_line;
+    uint64_t tx_count;
+};
+
+// GPIO port at 0x4002_0000.
+//   +0x0 MODE    pin configuration, stored only
+//   +0x4 OUT     output levels; changes are logged per pin
+class GpioModel : public sc_core::sc_module {
+public:
+    tlm_utils::simple_target_socket<GpioModel> socket;
+
+    SC_HAS_PROCESS(GpioModel);
+    GpioModel(sc_core::sc_module_name name);
+
+    void b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
+
+    uint32_t outputs() const { return out_register; }
+    uint64_t toggles() const { return toggle_count; }
+
+    static const uint32_t MODE_REG_OFFSET = 0x0;
+    static const uint32_t OUT_REG_OFFSET = 0x4;
+
+private:
+    uint32_t mode_register;
+    uint32_t out_register;
+    uint64_t toggle_count;
+};
+
+// Millisecond timer at 0x4000_0000.
+//   +0x0 CTRL    [0] enable
+//   +0x4 COUNT   milliseconds of simulated time since enable
+// The count includes the initiator's local time offset (the delay argument),
+// so it advances between quantum synchronisations.
+class TimerModel : public sc_core::sc_module {
+public:
+    tlm_utils::simple_target_socket<TimerModel> socket;
+
+    SC_HAS_PROCESS(TimerModel);
+    TimerModel(sc_core::sc_module_name name);
+
+    void b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
+
+    static const uint32_t CTRL_REG_OFFSET = 0x0;
+    static const uint32_t COUNT_REG_OFFSET = 0x4;
+
+private:
+    uint32_t control_register;
+    sc_core::sc_time start_time;
+};
+
+#endif
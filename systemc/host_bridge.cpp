@@ -0,0 +1,134 @@
+#include "host_bridge.h"
+#include "firmware_peripherals.h"
+#include "payload_extensions.h"
+#include "router.h"
+#include "tlm_data_path.h"
+#include <tlm_utils/simple_initiator_socket.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+const sc_dt::uint64 TIMER_BASE = 0x40000000;
+const sc_dt::uint64 UART_BASE = 0x40004400;
+const sc_dt::uint64 GPIO_BASE = 0x40020000;
+const sc_dt::uint64 REGION_SIZE = 0x400;
+const sc_core::sc_time QUANTUM(1, sc_core::SC_US);
+
+// Firmware-side initiator plus the models it reaches through the router.
+class HostSystem : public sc_core::sc_module {
+public:
+    tlm_utils::simple_initiator_socket<HostSystem> socket;
+
+    SC_HAS_PROCESS(HostSystem);
+    HostSystem(sc_core::sc_module_name name)
+        : sc_core::sc_module(name), socket("socket"), router("router"), timer("timer"),
+          uart("uart"), gpio("gpio"), limit(sc_core::sc_time(5000, sc_core::SC_MS)),
+          local_time(sc_core::SC_ZERO_TIME), accesses(0), start(std::chrono::steady_clock::now()) {
+        router.map(0, TIMER_BASE, REGION_SIZE);
+        router.map(1, UART_BASE, REGION_SIZE);
+        router.map(2, GPIO_BASE, REGION_SIZE);
+        router.initiator_socket[0]->bind(timer.socket);
+        router.initiator_socket[1]->bind(uart.socket);
+        router.initiator_socket[2]->bind(gpio.socket);
+        socket.bind(router.target_socket);
+
+        if (const char* env = std::getenv("FIRMWARE_HOST_SIM_MS")) {
+            limit = sc_core::sc_time(std::strtod(env, nullptr), sc_core::SC_MS);
+        }
+    }
+
+    uint32_t access(bool is_write, uint32_t addr, uint32_t size, uint32_t value) {
+        tlm::tlm_generic_payload* trans = pool.allocate();
+        trans->acquire();
+        unsigned char buffer[4];
+
+        tlm_data_path::store_le<uint32_t>(buffer, is_write ? value : 0);
+        trans->set_command(is_write ? tlm::TLM_WRITE_COMMAND : tlm::TLM_READ_COMMAND);
+        trans->set_address(addr);
+        trans->set_data_ptr(buffer);
+        trans->set_data_length(size);
+        trans->set_streaming_width(size);
+        trans->set_byte_enable_ptr(nullptr);
+        trans->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+
+        socket->b_transport(*trans, local_time);
+        accesses++;
+
+        if (trans->is_response_error()) {
+            std::cerr << "[Host] Bus error: " << (is_write ? "write" : "read") << " of " << size
+                      << " bytes at 0x" << std::hex << addr << std::dec << " ("
+                      << trans->get_response_string() << ")" << std::endl;
+            trans->release();
+            finish(1);
+        }
+        trans->release();
+
+        uint32_t result = 0;
+        if (!is_write) {
+            // Bytes past `size` are still zero from the store above.
+            result = tlm_data_path::load_le<uint32_t>(buffer);
+        }
+        if (local_time >= QUANTUM) {
+            sync();
+        }
+        return result;
+    }
+
+    void finish(int status) {
+        double host_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        sc_core::sc_time sim_time = sc_core::sc_time_stamp() + local_time;
+        std::cout << "[Host] " << accesses << " accesses, " << sim_time.to_seconds() * 1e3
+                  << " ms simulated in " << host_s << " s (" << (host_s > 0 ? accesses / host_s : 0)
+                  << " accesses/s)" << std::endl;
+        std::cout << "[Host] UART: " << uart.tx_bytes() << " bytes sent, GPIO: " << gpio.toggles()
+                  << " pin changes" << std::endl;
+        std::exit(status);
+    }
+
+private:
+    // Hands the accumulated local time to the kernel so anything scheduled
+    // in the models runs, then checks the run limit.
+    void sync() {
+        sc_core::sc_start(local_time);
+        local_time = sc_core::SC_ZERO_TIME;
+        if (sc_core::sc_time_stamp() >= limit) {
+            finish(0);
+        }
+    }
+
+    Router<3> router;
+    TimerModel timer;
+    UartModel uart;
+    GpioModel gpio;
+    sc_core::sc_time limit;
+    sc_core::sc_time local_time;
+    uint64_t accesses;
+    std::chrono::steady_clock::time_point start;
+    sideband::PayloadPool pool;
+};
+
+HostSystem& host_system() {
+    static HostSystem* system = nullptr;
+    if (!system) {
+        system = new HostSystem("host");
+        sc_core::sc_start(sc_core::SC_ZERO_TIME);
+    }
+    return *system;
+}
+
+} // namespace
+
+extern "C" uint32_t host_mmio_read(uint32_t addr, uint32_t size) {
+    return host_system().access(false, addr, size, 0);
+}
+
+extern "C" void host_mmio_write(uint32_t addr, uint32_t size, uint32_t value) {
+    host_system().access(true, addr, size, value);
+}
+
+extern "C" void host_system_reset(void) {
+    std::cout << "[Host] System reset requested" << std::endl;
+    host_system().finish(0);
+}
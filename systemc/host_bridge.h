@@ -0,0 +1,35 @@
+#ifndef HOST_BRIDGE_H
+#define HOST_BRIDGE_H
+
+// C ABI between host-compiled firmware (cargo feature "host-target", see
+// firmware/src/mmio.rs) and the SystemC peripheral models. Each MMIO access
+// becomes a direct b_transport call on the firmware's own thread. There is
+// no instruction-set simulation and no co-sim channel.
+//
+// The first access elaborates the design:
+//   0x4000_0000  TimerModel
+//   0x4000_4400  UartModel
+//   0x4002_0000  GpioModel
+// Model latencies accumulate as local time. SystemC time is advanced once
+// per quantum (1 us). The run ends with a summary once simulated time
+// reaches FIRMWARE_HOST_SIM_MS (default 5000 ms). A bus error ends it
+// immediately with exit status 1.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// `size` is 1, 2 or 4 bytes.
+uint32_t host_mmio_read(uint32_t addr, uint32_t size);
+void host_mmio_write(uint32_t addr, uint32_t size, uint32_t value);
+
+// Firmware-requested system reset; ends the run like the time limit does.
+void host_system_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
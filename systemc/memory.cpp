@@ -0,0 +1,88 @@
+#include "memory.h"
+#include <algorithm>
+#include <cstring>
+
+template <unsigned int BUSWIDTH>
+Memory<BUSWIDTH>::Memory(sc_core::sc_module_name name, sc_dt::uint64 size,
+                         sc_core::sc_time beat_latency)
+    : sc_core::sc_module(name), socket("socket"), storage(size, 0), beat_latency(beat_latency) {
+    socket.register_b_transport(this, &Memory::b_transport);
+    socket.register_get_direct_mem_ptr(this, &Memory::get_direct_mem_ptr);
+    socket.register_transport_dbg(this, &Memory::transport_dbg);
+}
+
+template <unsigned int BUSWIDTH>
+void Memory<BUSWIDTH>::b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+    sc_dt::uint64 addr = trans.get_address();
+    unsigned char* ptr = trans.get_data_ptr();
+    unsigned int len = trans.get_data_length();
+    const unsigned char* be = trans.get_byte_enable_ptr();
+    unsigned int be_len = trans.get_byte_enable_length();
+    // Streaming: byte i goes to addr + i % width. 0 means no streaming.
+    unsigned int width = trans.get_streaming_width();
+    if (width == 0 || width > len) {
+        width = len;
+    }
+
+    if (addr >= storage.size() || width > storage.size() - addr) {
+        trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+        return;
+    }
+
+    unsigned char* mem = &storage[addr];
+    if (width == len && !(be && be_len)) {
+        if (trans.is_read()) {
+            std::memcpy(ptr, mem, len);
+        } else if (trans.is_write()) {
+            std::memcpy(mem, ptr, len);
+        }
+    } else {
+        for (unsigned int i = 0; i < len; i++) {
+            if (be && be_len && be[i % be_len] != tlm::TLM_BYTE_ENABLED) {
+                continue;
+            }
+            if (trans.is_read()) {
+                ptr[i] = mem[i % width];
+            } else if (trans.is_write()) {
+                mem[i % width] = ptr[i];
+            }
+        }
+    }
+
+    trans.set_dmi_allowed(true);
+    trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    delay += beat_latency * ((len + BEAT_BYTES - 1) / BEAT_BYTES);
+}
+
+template <unsigned int BUSWIDTH>
+bool Memory<BUSWIDTH>::get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data) {
+    dmi_data.allow_read_write();
+    dmi_data.set_dmi_ptr(storage.data());
+    dmi_data.set_start_address(0);
+    dmi_data.set_end_address(storage.size() - 1);
+    dmi_data.set_read_latency(beat_latency);
+    dmi_data.set_write_latency(beat_latency);
+    return true;
+}
+
+template <unsigned int BUSWIDTH>
+unsigned int Memory<BUSWIDTH>::transport_dbg(tlm::tlm_generic_payload& trans) {
+    sc_dt::uint64 addr = trans.get_address();
+    if (addr >= storage.size()) {
+        return 0;
+    }
+
+    unsigned int len = std::min<sc_dt::uint64>(trans.get_data_length(), storage.size() - addr);
+    if (trans.is_read()) {
+        std::memcpy(trans.get_data_ptr(), &storage[addr], len);
+    } else if (trans.is_write()) {
+        std::memcpy(&storage[addr], trans.get_data_ptr(), len);
+    }
+    return len;
+}
+
+template class Memory<32>;
+template class Memory<64>;
+template class Memory<128>;
+template class Memory<256>;
+template class Memory<512>;
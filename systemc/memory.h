@@ -0,0 +1,36 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_target_socket.h>
+#include <vector>
+
+// Flat RAM target. Grants read/write DMI over the whole array; latency is
+// charged per bus beat for both transport and DMI users. Transports honour
+// byte enables and the streaming width.
+template <unsigned int BUSWIDTH = 32>
+class Memory : public sc_core::sc_module {
+public:
+    tlm_utils::simple_target_socket<Memory, BUSWIDTH> socket;
+
+    SC_HAS_PROCESS(Memory);
+    Memory(sc_core::sc_module_name name, sc_dt::uint64 size,
+           sc_core::sc_time beat_latency = sc_core::sc_time(10, sc_core::SC_NS));
+
+    virtual void b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
+    virtual bool get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data);
+    virtual unsigned int transport_dbg(tlm::tlm_generic_payload& trans);
+
+    // Backing store, for preloading images and checking results.
+    unsigned char* data() { return storage.data(); }
+    sc_dt::uint64 size() const { return storage.size(); }
+
+    static const unsigned int BEAT_BYTES = BUSWIDTH / 8;
+
+private:
+    std::vector<unsigned char> storage;
+    sc_core::sc_time beat_latency;
+};
+
+#endif
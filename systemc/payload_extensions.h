@@ -0,0 +1,151 @@
+#ifndef PAYLOAD_EXTENSIONS_H
+#define PAYLOAD_EXTENSIONS_H
+
+#include <systemc>
+#include <tlm>
+#include <vector>
+
+// Side-band transaction attributes carried as generic payload extensions.
+// Extension IDs are registered during static initialisation; payloads come
+// from PayloadPool with all extensions attached once, so setting attributes
+// on the hot path never allocates.
+namespace sideband {
+
+struct InitiatorExtension : tlm::tlm_extension<InitiatorExtension> {
+    unsigned int master_id = 0;
+    unsigned int qos = 0;  // 0 (lowest) .. 15, as AXI AxQOS
+
+    tlm::tlm_extension_base* clone() const override {
+        return new InitiatorExtension(*this);
+    }
+    void copy_from(const tlm::tlm_extension_base& ext) override {
+        *this = static_cast<const InitiatorExtension&>(ext);
+    }
+};
+
+struct SecurityExtension : tlm::tlm_extension<SecurityExtension> {
+    bool non_secure = false;
+    bool privileged = true;
+
+    tlm::tlm_extension_base* clone() const override {
+        return new SecurityExtension(*this);
+    }
+    void copy_from(const tlm::tlm_extension_base& ext) override {
+        *this = static_cast<const SecurityExtension&>(ext);
+    }
+};
+
+// `exclusive` is set by the initiator; the target sets `exclusive_ok`
+// when an exclusive access succeeds (AXI EXOKAY).
+struct ExclusiveExtension : tlm::tlm_extension<ExclusiveExtension> {
+    bool exclusive = false;
+    bool exclusive_ok = false;
+
+    tlm::tlm_extension_base* clone() const override {
+        return new ExclusiveExtension(*this);
+    }
+    void copy_from(const tlm::tlm_extension_base& ext) override {
+        *this = static_cast<const ExclusiveExtension&>(ext);
+    }
+};
+
+// Accessors returning the architectural defaults when an extension is
+// absent: master 0, QoS 0, secure privileged, non-exclusive.
+inline unsigned int master_id(const tlm::tlm_generic_payload& trans) {
+    InitiatorExtension* ext = trans.get_extension<InitiatorExtension>();
+    return ext ? ext->master_id : 0;
+}
+
+inline unsigned int qos(const tlm::tlm_generic_payload& trans) {
+    InitiatorExtension* ext = trans.get_extension<InitiatorExtension>();
+    return ext ? ext->qos : 0;
+}
+
+inline bool is_non_secure(const tlm::tlm_generic_payload& trans) {
+    SecurityExtension* ext = trans.get_extension<SecurityExtension>();
+    return ext && ext->non_secure;
+}
+
+inline bool is_exclusive(const tlm::tlm_generic_payload& trans) {
+    ExclusiveExtension* ext = trans.get_extension<ExclusiveExtension>();
+    return ext && ext->exclusive;
+}
+
+inline void set_exclusive_ok(tlm::tlm_generic_payload& trans, bool ok) {
+    ExclusiveExtension* ext = trans.get_extension<ExclusiveExtension>();
+    if (ext) {
+        ext->exclusive_ok = ok;
+    }
+}
+
+// Memory manager recycling payloads with every side-band extension
+// pre-attached. Usage: allocate(), acquire(), fill in, transport, release().
+class PayloadPool : public tlm::tlm_mm_interface {
+public:
+    PayloadPool() {}
+
+    ~PayloadPool() {
+        for (tlm::tlm_generic_payload* trans : free_list) {
+            delete trans;
+        }
+    }
+
+    tlm::tlm_generic_payload* allocate() {
+        if (free_list.empty()) {
+            tlm::tlm_generic_payload* trans = new tlm::tlm_generic_payload(this);
+            trans->set_extension(new InitiatorExtension);
+            trans->set_extension(new SecurityExtension);
+            trans->set_extension(new ExclusiveExtension);
+            return trans;
+        }
+
+        tlm::tlm_generic_payload* trans = free_list.back();
+        free_list.pop_back();
+        return trans;
+    }
+
+    void free(tlm::tlm_generic_payload* trans) override {
+        // reset() only drops auto extensions; ours stay attached.
+        trans->reset();
+        trans->set_byte_enable_ptr(nullptr);
+        trans->set_byte_enable_length(0);
+        trans->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+        trans->set_dmi_allowed(false);
+        *trans->get_extension<InitiatorExtension>() = InitiatorExtension();
+        *trans->get_extension<SecurityExtension>() = SecurityExtension();
+        *trans->get_extension<ExclusiveExtension>() = ExclusiveExtension();
+        free_list.push_back(trans);
+    }
+
+private:
+    PayloadPool(const PayloadPool&) = delete;
+    PayloadPool& operator=(const PayloadPool&) = delete;
+
+    std::vector<tlm::tlm_generic_payload*> free_list;
+};
+
+// One reference to a payload from a PayloadPool, released on scope exit,
+// so an exception (e.g. from SC_REPORT_ERROR) cannot leak it.
+class PooledPayload {
+public:
+    explicit PooledPayload(PayloadPool& pool) : trans(pool.allocate()) {
+        trans->acquire();
+    }
+
+    ~PooledPayload() {
+        trans->release();
+    }
+
+    tlm::tlm_generic_payload& operator*() const { return *trans; }
+    tlm::tlm_generic_payload* operator->() const { return trans; }
+
+private:
+    PooledPayload(const PooledPayload&) = delete;
+    PooledPayload& operator=(const PooledPayload&) = delete;
+
+    tlm::tlm_generic_payload* trans;
+};
+
+} // namespace sideband
+
+#endif
@@ -1,74 +1,237 @@
 #include "peripheral_model.h"
+#include "payload_extensions.h"
+#include "tlm_data_path.h"
+#include <algorithm>
 #include <iostream>
 
-void PeripheralModel::b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+template <unsigned int BUSWIDTH>
+void PeripheralModel<BUSWIDTH>::b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
     tlm::tlm_command cmd = trans.get_command();
     sc_dt::uint64 addr = trans.get_address();
     unsigned char* ptr = trans.get_data_ptr();
     unsigned int len = trans.get_data_length();
-    
-    if (len != 4) {
-        trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
+
+    if (!tlm_data_path::is_supported_length(len, std::max(8u, BUSWIDTH / 8))) {
+        trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
         return;
     }
-    
+
     uint32_t offset = addr & 0xFF;
-    
-    if (cmd == tlm::TLM_READ_COMMAND) {
-        switch (offset) {
-            case CTRL_REG_OFFSET:
-                *reinterpret_cast<uint32_t*>(ptr) = control_register;
-                break;
-            case STATUS_REG_OFFSET:
-                *reinterpret_cast<uint32_t*>(ptr) = status_register;
-                break;
-            case DATA_REG_OFFSET:
-                *reinterpret_cast<uint32_t*>(ptr) = data_register;
-                status_register &= ~0x01; // Clear data ready bit
-                break;
-            default:
-                trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
-                return;
+    bool is_write = cmd == tlm::TLM_WRITE_COMMAND;
+
+    if (is_write && secure_control && offset < CTRL_REG_OFFSET + 4 &&
+        sideband::is_non_secure(trans)) {
+        trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
+        return;
+    }
+
+    // An exclusive write only takes effect while the master still holds the
+    // reservation from its exclusive read; otherwise it completes without
+    // writing and without EXOKAY.
+    unsigned int master = sideband::master_id(trans);
+    bool exclusive = sideband::is_exclusive(trans);
+    if (exclusive && is_write && !exclusive_held(master, offset)) {
+        sideband::set_exclusive_ok(trans, false);
+        trans.set_response_status(tlm::TLM_OK_RESPONSE);
+        delay += sc_core::sc_time(10, sc_core::SC_NS);
+        return;
+    }
+
+    // Reject the whole access if any register it touches does not exist,
+    // before a wide write has applied its first lanes or a read popped data.
+    for (uint32_t reg_offset = offset & ~0x3u; reg_offset < offset + len; reg_offset += 4) {
+        if (!is_register(reg_offset, is_write)) {
+            trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+            return;
         }
-    } else if (cmd == tlm::TLM_WRITE_COMMAND) {
-        switch (offset) {
-            case CTRL_REG_OFFSET:
-                control_register = *reinterpret_cast<uint32_t*>(ptr);
-                if (control_register & 0x01) {
-                    interrupt_event.notify();
-                }
-                break;
-            case DATA_REG_OFFSET:
-                data_register = *reinterpret_cast<uint32_t*>(ptr);
-                std::cout << "[SystemC] Data written: 0x" << std::hex << data_register << std::endl;
-                break;
-            default:
-                trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
-                return;
+    }
+
+    // Split the access into the 32-bit registers it touches; sub-word and
+    // wide accesses become one partial or several full register accesses.
+    for (unsigned int pos = 0; pos < len; ) {
+        uint32_t reg_offset = (offset + pos) & ~0x3u;
+        unsigned int lane = (offset + pos) & 0x3u;
+        unsigned int n = std::min(4u - lane, len - pos);
+        uint32_t byte_mask = tlm_data_path::byte_enable_mask(trans, pos, n) << lane;
+
+        bool ok = true;
+        if (cmd == tlm::TLM_READ_COMMAND) {
+            uint32_t value = 0;
+            ok = read_register(reg_offset, value);
+            if (ok) {
+                tlm_data_path::extract_lanes(ptr + pos, value, lane, n, byte_mask);
+            }
+        } else if (cmd == tlm::TLM_WRITE_COMMAND) {
+            uint32_t value = tlm_data_path::insert_lanes(ptr + pos, lane, n);
+            ok = write_register(reg_offset, value, tlm_data_path::byte_mask_to_bits(byte_mask));
         }
+
+        if (!ok) {
+            trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+            return;
+        }
+        pos += n;
+    }
+
+    if (is_write) {
+        clear_reservations(offset, len);
+    } else if (exclusive && cmd == tlm::TLM_READ_COMMAND) {
+        reserve(master, offset);
+    }
+    if (exclusive) {
+        sideband::set_exclusive_ok(trans, true);
     }
-    
+
     trans.set_response_status(tlm::TLM_OK_RESPONSE);
-    delay += sc_core::sc_time(10, sc_core::SC_NS);
+
+    // One bus beat per BEAT_BYTES, so wide buses finish data bursts sooner.
+    unsigned int beats = (len + BEAT_BYTES - 1) / BEAT_BYTES;
+    delay += sc_core::sc_time(10, sc_core::SC_NS) * beats;
+}
+
+template <unsigned int BUSWIDTH>
+bool PeripheralModel<BUSWIDTH>::is_register(uint32_t offset, bool write) const {
+    if (offset >= FIFO_WINDOW_OFFSET && offset < FIFO_WINDOW_OFFSET + FIFO_WINDOW_SIZE) {
+        return true;
+    }
+    switch (offset) {
+        case CTRL_REG_OFFSET:
+        case DATA_REG_OFFSET:
+            return true;
+        case STATUS_REG_OFFSET:
+        case FIFO_LEVEL_REG_OFFSET:
+            return !write;
+        default:
+            return false;
+    }
+}
+
+template <unsigned int BUSWIDTH>
+bool PeripheralModel<BUSWIDTH>::read_register(uint32_t offset, uint32_t& value) {
+    if (offset >= FIFO_WINDOW_OFFSET && offset < FIFO_WINDOW_OFFSET + FIFO_WINDOW_SIZE) {
+        value = pop_rx();
+        return true;
+    }
+
+    switch (offset) {
+        case CTRL_REG_OFFSET:
+            value = control_register;
+            return true;
+        case STATUS_REG_OFFSET:
+            value = status_register;
+            return true;
+        case DATA_REG_OFFSET:
+            value = pop_rx();
+            return true;
+        case FIFO_LEVEL_REG_OFFSET:
+            value = rx_fifo.size();
+            return true;
+        default:
+            return false;
+    }
+}
+
+template <unsigned int BUSWIDTH>
+bool PeripheralModel<BUSWIDTH>::write_register(uint32_t offset, uint32_t value, uint32_t bits) {
+    if (offset >= FIFO_WINDOW_OFFSET && offset < FIFO_WINDOW_OFFSET + FIFO_WINDOW_SIZE) {
+        offset = DATA_REG_OFFSET;
+    }
+
+    switch (offset) {
+        case CTRL_REG_OFFSET:
+            control_register = (control_register & ~bits) | (value & bits);
+            if (control_register & 0x01) {
+                interrupt_event.notify();
+            }
+            irq_update_event.notify();
+            return true;
+        case DATA_REG_OFFSET:
+            data_register = (data_register & ~bits) | (value & bits);
+            std::cout << "[SystemC] Data written: 0x" << std::hex << data_register << std::endl;
+            return true;
+        default:
+            return false;
+    }
+}
+
+template <unsigned int BUSWIDTH>
+uint32_t PeripheralModel<BUSWIDTH>::pop_rx() {
+    if (!rx_fifo.empty()) {
+        data_register = rx_fifo.front();
+        rx_fifo.pop_front();
+    }
+    update_status();
+    return data_register;
+}
+
+template <unsigned int BUSWIDTH>
+void PeripheralModel<BUSWIDTH>::update_status() {
+    if (rx_fifo.empty()) {
+        status_register &= ~0x01; // Clear data ready bit
+    } else {
+        status_register |= 0x01; // Set data ready bit
+    }
+    irq_update_event.notify();
+}
+
+template <unsigned int BUSWIDTH>
+void PeripheralModel<BUSWIDTH>::update_irq() {
+    irq.write((status_register & 0x01) && (control_register & CTRL_IRQ_ENABLE));
 }
 
-bool PeripheralModel::get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data) {
+template <unsigned int BUSWIDTH>
+bool PeripheralModel<BUSWIDTH>::exclusive_held(unsigned int master_id, uint32_t offset) const {
+    const Reservation& r = reservations[master_id % EXCLUSIVE_MONITORS];
+    return r.valid && r.master_id == master_id && r.offset == (offset & ~0x3u);
+}
+
+template <unsigned int BUSWIDTH>
+void PeripheralModel<BUSWIDTH>::reserve(unsigned int master_id, uint32_t offset) {
+    Reservation& r = reservations[master_id % EXCLUSIVE_MONITORS];
+    r.valid = true;
+    r.master_id = master_id;
+    r.offset = offset & ~0x3u;
+}
+
+template <unsigned int BUSWIDTH>
+void PeripheralModel<BUSWIDTH>::clear_reservations(uint32_t offset, unsigned int len) {
+    for (unsigned int i = 0; i < EXCLUSIVE_MONITORS; ++i) {
+        Reservation& r = reservations[i];
+        if (r.valid && r.offset + 4 > offset && r.offset < offset + len) {
+            r.valid = false;
+        }
+    }
+}
+
+template <unsigned int BUSWIDTH>
+bool PeripheralModel<BUSWIDTH>::get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data) {
     return false;
 }
 
-unsigned int PeripheralModel::transport_dbg(tlm::tlm_generic_payload& trans) {
+template <unsigned int BUSWIDTH>
+unsigned int PeripheralModel<BUSWIDTH>::transport_dbg(tlm::tlm_generic_payload& trans) {
     return 0;
 }
 
-void PeripheralModel::interrupt_generator() {
+template <unsigned int BUSWIDTH>
+void PeripheralModel<BUSWIDTH>::interrupt_generator() {
     while (true) {
-        wait(interrupt_event);
-        wait(100, sc_core::SC_US);
-        
-        // Simulate data arrival
-        data_register = rand() & 0xFFFF;
-        status_register |= 0x01; // Set data ready bit
-        
-        std::cout << "[SystemC] Interrupt generated, data: 0x" << std::hex << data_register << std::endl;
+        sc_core::wait(interrupt_event);
+        sc_core::wait(100, sc_core::SC_US);
+
+        // Simulate data arrival; CTRL[11:8] + 1 entries per interrupt
+        unsigned int entries = ((control_register >> 8) & 0xF) + 1;
+        for (unsigned int i = 0; i < entries && rx_fifo.size() < RX_FIFO_DEPTH; ++i) {
+            rx_fifo.push_back(rand() & 0xFFFF);
+        }
+        update_status();
+
+        std::cout << "[SystemC] Interrupt generated, data: 0x" << std::hex << rx_fifo.back() << std::endl;
     }
-}
\ No newline at end of file
+}
+
+template class PeripheralModel<32>;
+template class PeripheralModel<64>;
+template class PeripheralModel<128>;
+template class PeripheralModel<256>;
+template class PeripheralModel<512>;
@@ -4,34 +4,82 @@
 #include <systemc>
 #include <tlm>
 #include <tlm_utils/simple_target_socket.h>
+#include <deque>
 
+// BUSWIDTH is the socket width in bits. Wider buses carry several 32-bit
+// registers or FIFO entries per transaction; the model is explicitly
+// instantiated for 32, 64, 128, 256 and 512 bits.
+//
+// `irq` is high while RX data is ready (STATUS[0]) and CTRL.IRQ_ENABLE
+// (CTRL[1]) is set. It must be bound even when unused.
+template <unsigned int BUSWIDTH = 32>
 class PeripheralModel : public sc_core::sc_module {
 public:
-    tlm_utils::simple_target_socket<PeripheralModel> socket;
+    tlm_utils::simple_target_socket<PeripheralModel, BUSWIDTH> socket;
+    sc_core::sc_out<bool> irq;
     
-    SC_CTOR(PeripheralModel) : socket("socket") {
+    SC_CTOR(PeripheralModel)
+        : socket("socket"), irq("irq"), control_register(0), status_register(0), data_register(0),
+          secure_control(false), reservations() {
         socket.register_b_transport(this, &PeripheralModel::b_transport);
         socket.register_get_direct_mem_ptr(this, &PeripheralModel::get_direct_mem_ptr);
         socket.register_transport_dbg(this, &PeripheralModel::transport_dbg);
         
         SC_THREAD(interrupt_generator);
+        SC_METHOD(update_irq);
+        this->sensitive << irq_update_event;
     }
     
     virtual void b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
     virtual bool get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data);
     virtual unsigned int transport_dbg(tlm::tlm_generic_payload& trans);
     
+    // When set, non-secure writes to CTRL are rejected (TrustZone-style
+    // secure-only configuration register).
+    void set_secure_control(bool secure_only) { secure_control = secure_only; }
+    
+    static const unsigned int BEAT_BYTES = BUSWIDTH / 8;
+    
 private:
     void interrupt_generator();
+    bool is_register(uint32_t offset, bool write) const;
+    bool read_register(uint32_t offset, uint32_t& value);
+    bool write_register(uint32_t offset, uint32_t value, uint32_t bits);
+    uint32_t pop_rx();
+    void update_status();
+    void update_irq();
+    bool exclusive_held(unsigned int master_id, uint32_t offset) const;
+    void reserve(unsigned int master_id, uint32_t offset);
+    void clear_reservations(uint32_t offset, unsigned int len);
     
     sc_core::sc_event interrupt_event;
+    sc_core::sc_event irq_update_event;
     uint32_t control_register;
     uint32_t status_register;
     uint32_t data_register;
+    std::deque<uint32_t> rx_fifo;
+    bool secure_control;
+    
+    // Exclusive monitor, one reservation slot per master (modulo slots).
+    struct Reservation {
+        bool valid;
+        unsigned int master_id;
+        uint32_t offset;
+    };
+    static const unsigned int EXCLUSIVE_MONITORS = 8;
+    Reservation reservations[EXCLUSIVE_MONITORS];
     
     static const uint32_t CTRL_REG_OFFSET = 0x00;
     static const uint32_t STATUS_REG_OFFSET = 0x04;
     static const uint32_t DATA_REG_OFFSET = 0x08;
+    static const uint32_t FIFO_LEVEL_REG_OFFSET = 0x0C;
+    static const uint32_t CTRL_IRQ_ENABLE = 1u << 1;
+    
+    // Every 32-bit word in this window aliases DATA: reads pop one RX entry
+    // each, writes transmit one word each, so a wide beat moves several.
+    static const uint32_t FIFO_WINDOW_OFFSET = 0x40;
+    static const uint32_t FIFO_WINDOW_SIZE = 0x40;
+    static const unsigned int RX_FIFO_DEPTH = 16;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,132 @@
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <tlm_utils/simple_target_socket.h>
+#include <algorithm>
+#include <sstream>
+#include "payload_extensions.h"
+
+// Address decoder between one initiator and N_TARGETS targets. Each target
+// owns one [base, base + size) region set with map(); addresses are
+// rebased to the region before forwarding. BUSWIDTH is shared by all
+// sockets so wide initiators reach wide targets without splitting.
+// Regions mapped secure-only answer non-secure accesses (see
+// sideband::SecurityExtension) with an address error, like an AXI DECERR.
+template <unsigned int N_TARGETS, unsigned int BUSWIDTH = 32>
+class Router : public sc_core::sc_module {
+public:
+    tlm_utils::simple_target_socket<Router, BUSWIDTH> target_socket;
+    tlm_utils::simple_initiator_socket_tagged<Router, BUSWIDTH>* initiator_socket[N_TARGETS];
+
+    SC_CTOR(Router) : target_socket("target_socket") {
+        target_socket.register_b_transport(this, &Router::b_transport);
+        target_socket.register_get_direct_mem_ptr(this, &Router::get_direct_mem_ptr);
+        target_socket.register_transport_dbg(this, &Router::transport_dbg);
+
+        for (unsigned int i = 0; i < N_TARGETS; i++) {
+            std::ostringstream name;
+            name << "initiator_socket_" << i;
+            initiator_socket[i] = new tlm_utils::simple_initiator_socket_tagged<Router, BUSWIDTH>(
+                name.str().c_str());
+            initiator_socket[i]->register_invalidate_direct_mem_ptr(
+                this, &Router::invalidate_direct_mem_ptr, i);
+            regions[i].base = 0;
+            regions[i].size = 0;
+            regions[i].secure_only = false;
+        }
+    }
+
+    ~Router() {
+        for (unsigned int i = 0; i < N_TARGETS; i++) {
+            delete initiator_socket[i];
+        }
+    }
+
+    void map(unsigned int target, sc_dt::uint64 base, sc_dt::uint64 size,
+             bool secure_only = false) {
+        sc_assert(target < N_TARGETS);
+        regions[target].base = base;
+        regions[target].size = size;
+        regions[target].secure_only = secure_only;
+    }
+
+    void b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+        sc_dt::uint64 addr = trans.get_address();
+        int target = decode(addr, trans.get_data_length());
+        if (target < 0 || !permitted(target, trans)) {
+            trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+            return;
+        }
+
+        trans.set_address(addr - regions[target].base);
+        (*initiator_socket[target])->b_transport(trans, delay);
+        trans.set_address(addr);
+    }
+
+    bool get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data) {
+        sc_dt::uint64 addr = trans.get_address();
+        int target = decode(addr, 1);
+        if (target < 0 || !permitted(target, trans)) {
+            return false;
+        }
+
+        const Region& r = regions[target];
+        trans.set_address(addr - r.base);
+        bool granted = (*initiator_socket[target])->get_direct_mem_ptr(trans, dmi_data);
+        trans.set_address(addr);
+
+        // Translate back to the initiator's view and clip to the region.
+        sc_dt::uint64 end = std::min(dmi_data.get_end_address(), r.size - 1);
+        dmi_data.set_start_address(dmi_data.get_start_address() + r.base);
+        dmi_data.set_end_address(end + r.base);
+        return granted;
+    }
+
+    unsigned int transport_dbg(tlm::tlm_generic_payload& trans) {
+        sc_dt::uint64 addr = trans.get_address();
+        int target = decode(addr, trans.get_data_length());
+        if (target < 0) {
+            return 0;
+        }
+
+        trans.set_address(addr - regions[target].base);
+        unsigned int count = (*initiator_socket[target])->transport_dbg(trans);
+        trans.set_address(addr);
+        return count;
+    }
+
+    void invalidate_direct_mem_ptr(int target, sc_dt::uint64 start, sc_dt::uint64 end) {
+        const Region& r = regions[target];
+        end = std::min(end, r.size - 1);
+        target_socket->invalidate_direct_mem_ptr(start + r.base, end + r.base);
+    }
+
+private:
+    struct Region {
+        sc_dt::uint64 base;
+        sc_dt::uint64 size;
+        bool secure_only;
+    };
+
+    bool permitted(int target, const tlm::tlm_generic_payload& trans) const {
+        return !regions[target].secure_only || !sideband::is_non_secure(trans);
+    }
+
+    // Returns the target whose region holds the whole access, or -1.
+    int decode(sc_dt::uint64 addr, unsigned int len) const {
+        for (unsigned int i = 0; i < N_TARGETS; i++) {
+            const Region& r = regions[i];
+            if (addr >= r.base && addr - r.base < r.size && len <= r.size - (addr - r.base)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    Region regions[N_TARGETS];
+};
+
+#endif
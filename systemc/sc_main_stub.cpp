@@ -0,0 +1,8 @@
+// For programs that provide their own main() and drive SystemC from it:
+// the Rust memory_controller, firmware_host and the cim_sim extension.
+// libsystemc's own main() is never linked, but a shared libsystemc still
+// expects sc_main to resolve.
+
+int sc_main(int, char*[]) {
+    return 1;
+}
@@ -0,0 +1,113 @@
+#ifndef TESTBENCH_H
+#define TESTBENCH_H
+
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <iostream>
+#include <string>
+#include "payload_extensions.h"
+#include "tlm_data_path.h"
+
+// Parameters of one test run. The defaults reproduce the original
+// single-scenario testbench sequence.
+struct Scenario {
+    std::string name = "default";
+    unsigned int seed = 1;
+    uint32_t control = 0x01;
+    unsigned int wait_us = 200;
+};
+
+struct ScenarioResult {
+    uint32_t status;
+    uint32_t data;
+    unsigned int transaction_errors;
+    double sim_time_us;
+};
+
+class TestBench : public sc_core::sc_module {
+public:
+    tlm_utils::simple_initiator_socket<TestBench> socket;
+
+    // Set before sc_start(); read back after the simulation stops.
+    Scenario scenario;
+    ScenarioResult result;
+    unsigned int master_id = 0;
+
+    SC_CTOR(TestBench) : socket("socket"), result() {
+        SC_THREAD(run_test);
+    }
+
+    void run_test() {
+        wait(10, sc_core::SC_NS);
+
+        // Write to control register
+        write_register(0x00, scenario.control);
+
+        // Read status register
+        uint32_t status = read_register(0x04);
+        std::cout << "[TB] Status: 0x" << std::hex << status << std::endl;
+
+        // Wait for interrupt
+        wait(scenario.wait_us, sc_core::SC_US);
+
+        // Read data
+        result.status = read_register(0x04);
+        result.data = read_register(0x08);
+        std::cout << "[TB] Data received: 0x" << std::hex << result.data << std::endl;
+
+        result.sim_time_us = sc_core::sc_time_stamp().to_seconds() * 1e6;
+        sc_core::sc_stop();
+    }
+
+private:
+    void write_register(uint32_t addr, uint32_t data) {
+        sideband::PooledPayload trans(pool);
+        init_transaction(*trans);
+        sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+        unsigned char buffer[4];
+
+        tlm_data_path::store_le<uint32_t>(buffer, data);
+        trans->set_command(tlm::TLM_WRITE_COMMAND);
+        trans->set_address(addr);
+        trans->set_data_ptr(buffer);
+        trans->set_data_length(4);
+
+        socket->b_transport(*trans, delay);
+
+        if (trans->is_response_error()) {
+            result.transaction_errors++;
+            SC_REPORT_ERROR("TestBench", "Transaction error");
+        }
+    }
+
+    uint32_t read_register(uint32_t addr) {
+        sideband::PooledPayload trans(pool);
+        init_transaction(*trans);
+        sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+        unsigned char buffer[4] = {0, 0, 0, 0};
+
+        trans->set_command(tlm::TLM_READ_COMMAND);
+        trans->set_address(addr);
+        trans->set_data_ptr(buffer);
+        trans->set_data_length(4);
+
+        socket->b_transport(*trans, delay);
+
+        if (trans->is_response_error()) {
+            result.transaction_errors++;
+            SC_REPORT_ERROR("TestBench", "Transaction error");
+        }
+
+        return tlm_data_path::load_le<uint32_t>(buffer);
+    }
+
+    void init_transaction(tlm::tlm_generic_payload& trans) {
+        trans.set_streaming_width(4);
+        trans.get_extension<sideband::InitiatorExtension>()->master_id = master_id;
+    }
+
+    sideband::PayloadPool pool;
+};
+
+#endif
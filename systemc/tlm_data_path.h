@@ -0,0 +1,116 @@
+#ifndef TLM_DATA_PATH_H
+#define TLM_DATA_PATH_H
+
+#include <cstdint>
+#include <cstring>
+#include <tlm>
+
+// Helpers for moving register values in and out of generic payload data
+// arrays. Payload bytes are in bus (little-endian) order. All loads and
+// stores go through memcpy, which is valid for any buffer alignment and is
+// lowered to a single move on the hosts we build for.
+namespace tlm_data_path {
+
+inline uint8_t byte_swap(uint8_t v) { return v; }
+inline uint16_t byte_swap(uint16_t v) { return __builtin_bswap16(v); }
+inline uint32_t byte_swap(uint32_t v) { return __builtin_bswap32(v); }
+inline uint64_t byte_swap(uint64_t v) { return __builtin_bswap64(v); }
+
+template <typename T>
+inline T from_little_endian(T v) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return byte_swap(v);
+#else
+    return v;
+#endif
+}
+
+template <typename T>
+inline T to_little_endian(T v) {
+    return from_little_endian(v);
+}
+
+template <typename T>
+inline T load_le(const unsigned char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return from_little_endian(v);
+}
+
+template <typename T>
+inline void store_le(unsigned char* p, T v) {
+    v = to_little_endian(v);
+    std::memcpy(p, &v, sizeof(T));
+}
+
+// Power-of-two lengths up to `max_len` bytes (normally the bus width).
+inline bool is_supported_length(unsigned int len, unsigned int max_len = 8) {
+    return len != 0 && len <= max_len && (len & (len - 1)) == 0;
+}
+
+inline bool has_byte_enables(const tlm::tlm_generic_payload& trans) {
+    return trans.get_byte_enable_ptr() != nullptr && trans.get_byte_enable_length() != 0;
+}
+
+// One bit per byte for `n` payload bytes starting at data offset `pos`.
+// The byte-enable array repeats when it is shorter than the data array.
+inline uint32_t byte_enable_mask(const tlm::tlm_generic_payload& trans,
+                                 unsigned int pos, unsigned int n) {
+    if (!has_byte_enables(trans)) {
+        return (1u << n) - 1;
+    }
+
+    const unsigned char* be = trans.get_byte_enable_ptr();
+    unsigned int be_len = trans.get_byte_enable_length();
+    uint32_t mask = 0;
+    for (unsigned int i = 0; i < n; ++i) {
+        if (be[(pos + i) % be_len] == tlm::TLM_BYTE_ENABLED) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+// Expands a 4-bit byte mask into a 32-bit bit mask.
+inline uint32_t byte_mask_to_bits(uint32_t byte_mask) {
+    uint32_t bits = 0;
+    for (unsigned int i = 0; i < 4; ++i) {
+        if (byte_mask & (1u << i)) {
+            bits |= 0xFFu << (8 * i);
+        }
+    }
+    return bits;
+}
+
+// Copies `n` bytes of `word`, starting at byte lane `lane`, to `dst`.
+// `byte_mask` is lane-relative; disabled bytes in `dst` are left untouched.
+inline void extract_lanes(unsigned char* dst, uint32_t word, unsigned int lane,
+                          unsigned int n, uint32_t byte_mask) {
+    if (lane == 0 && n == 4 && byte_mask == 0xF) {
+        store_le<uint32_t>(dst, word);
+        return;
+    }
+
+    unsigned char bytes[4];
+    store_le<uint32_t>(bytes, word);
+    for (unsigned int i = 0; i < n; ++i) {
+        if (byte_mask & (1u << (lane + i))) {
+            dst[i] = bytes[lane + i];
+        }
+    }
+}
+
+// Places `n` bytes from `src` at byte lane `lane` of a 32-bit word.
+inline uint32_t insert_lanes(const unsigned char* src, unsigned int lane, unsigned int n) {
+    if (lane == 0 && n == 4) {
+        return load_le<uint32_t>(src);
+    }
+
+    unsigned char bytes[4] = {0, 0, 0, 0};
+    std::memcpy(bytes + lane, src, n);
+    return load_le<uint32_t>(bytes);
+}
+
+} // namespace tlm_data_path
+
+#endif
@@ -0,0 +1,419 @@
+// Co-simulation orchestrator: runs one QEMU + SystemC server pair per
+// firmware image, several pairs at a time. Each pair gets its own
+// shared-memory channel (systemc/cosim_channel.h) and its own CPUs: one
+// for the server and one per emulated core. QEMU is only started once the
+// server has reported readiness on a pipe.
+//
+// A pair passes when QEMU exits with status 0 (semihosting exit) and the
+// server served every access without error. Firmware that never exits,
+// like firmware/src/main.rs, is run with --run-for instead: the pair is
+// stopped after that many seconds and passes if the server served at
+// least one access, none with an error, and QEMU had not failed first.
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "qemu/custom_arm.h"
+#include "systemc/cosim_channel.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Each core is a vCPU with its own response slot on the channel.
+static_assert(CUSTOM_ARM_MC_MAX_CORES <= COSIM_MAX_VCPUS, "more cores than channel slots");
+
+struct Options {
+    unsigned int jobs = 0;
+    unsigned int timeout_s = 120;
+    unsigned int ready_timeout_s = 10;
+    unsigned int cores = 1;
+    double run_for_s = 0;
+    bool pin = true;
+    std::string server = "bazel-bin/systemc/cosim_server";
+    std::string qemu;
+    std::string log_dir;
+    std::string output_file;
+    std::vector<std::string> firmware;
+    std::vector<std::string> qemu_args;
+    std::vector<std::string> server_args;
+};
+
+struct Pair {
+    size_t job;
+    unsigned int slot;
+    std::string shm_name;
+    CosimChannel* channel = nullptr;
+    pid_t server_pid = -1;
+    pid_t qemu_pid = -1;
+    int server_status = 0;
+    int qemu_status = 0;
+    Clock::time_point start;
+    Clock::time_point deadline;
+    Clock::time_point stop_at;
+    bool timed_out = false;
+    bool stopped = false;
+    uint64_t transactions = 0;
+    std::string failure;
+};
+
+struct Outcome {
+    std::string name;
+    std::string result = "not run";
+    double wall_s = 0;
+    uint64_t transactions = 0;
+};
+
+volatile sig_atomic_t interrupted = 0;
+
+void on_signal(int) {
+    interrupted = 1;
+}
+
+void usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [-j pairs] [--timeout seconds] [--ready-timeout seconds]"
+              << " [--run-for seconds] [--cores n] [--server path] [--server-arg arg]... [--qemu path]"
+              << " [--log-dir dir] [--output results.csv] [--no-pin] firmware... [-- extra QEMU args]" << std::endl;
+}
+
+bool parse_options(int argc, char* argv[], Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--") {
+            opts.qemu_args.assign(argv + i + 1, argv + argc);
+            break;
+        } else if (arg == "-j" && has_value) {
+            opts.jobs = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--timeout" && has_value) {
+            opts.timeout_s = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--ready-timeout" && has_value) {
+            opts.ready_timeout_s = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--run-for" && has_value) {
+            opts.run_for_s = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--cores" && has_value) {
+            opts.cores = std::strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--server" && has_value) {
+            opts.server = argv[++i];
+        } else if (arg == "--server-arg" && has_value) {
+            opts.server_args.push_back(argv[++i]);
+        } else if (arg == "--qemu" && has_value) {
+            opts.qemu = argv[++i];
+        } else if (arg == "--log-dir" && has_value) {
+            opts.log_dir = argv[++i];
+        } else if (arg == "--output" && has_value) {
+            opts.output_file = argv[++i];
+        } else if (arg == "--no-pin") {
+            opts.pin = false;
+        } else if (!arg.empty() && arg[0] != '-') {
+            opts.firmware.push_back(arg);
+        } else {
+            return false;
+        }
+    }
+    if (opts.cores < 1 || opts.cores > CUSTOM_ARM_MC_MAX_CORES) {
+        std::cerr << "[Cosim] --cores must be 1 to " << CUSTOM_ARM_MC_MAX_CORES << ", the cores of custom-arm-mc"
+                  << std::endl;
+        return false;
+    }
+    return !opts.firmware.empty() && opts.run_for_s >= 0 && opts.run_for_s < opts.timeout_s;
+}
+
+std::string pair_name(size_t job, const std::string& firmware) {
+    return std::to_string(job) + "-" + firmware.substr(firmware.find_last_of('/') + 1);
+}
+
+// Forks and execs argv with stdout/stderr in log_path (or /dev/null),
+// optionally pinned to num_cpus CPUs starting at first_cpu. keep_fd stays
+// open across exec.
+pid_t spawn(const std::vector<std::string>& args, int first_cpu, unsigned int num_cpus,
+            const std::string& log_path, int keep_fd) {
+    std::cout.flush();
+    std::cerr.flush();
+    pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+
+    if (first_cpu >= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (unsigned int i = 0; i < num_cpus; i++) {
+            CPU_SET((first_cpu + i) % cpus, &set);
+        }
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+
+    int null_fd = open("/dev/null", O_RDWR);
+    int log_fd = log_path.empty() ? null_fd : open(log_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    dup2(null_fd, STDIN_FILENO);
+    if (log_fd >= 0) {
+        dup2(log_fd, STDOUT_FILENO);
+        dup2(log_fd, STDERR_FILENO);
+    }
+    if (keep_fd >= 0) {
+        fcntl(keep_fd, F_SETFD, 0);
+    }
+
+    std::vector<char*> argv;
+    for (const std::string& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    execvp(argv[0], argv.data());
+    perror(argv[0]);
+    _exit(127);
+}
+
+// Waits up to timeout_s for the server's "ready" line.
+bool wait_ready(int fd, unsigned int timeout_s) {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    char buffer[16];
+    int ready = poll(&pfd, 1, static_cast<int>(timeout_s * 1000));
+    return ready > 0 && read(fd, buffer, sizeof(buffer)) > 0;
+}
+
+void kill_pair(Pair& pair, int sig) {
+    if (pair.qemu_pid > 0) {
+        kill(pair.qemu_pid, sig);
+    }
+    if (pair.server_pid > 0) {
+        kill(pair.server_pid, sig);
+    }
+}
+
+bool start_pair(Pair& pair, const Options& opts, const std::string& name) {
+    pair.shm_name = "/cosim-" + std::to_string(getpid()) + "-" + std::to_string(pair.job);
+    pair.channel = cosim_channel_open(pair.shm_name.c_str(), 1);
+    if (!pair.channel) {
+        pair.failure = std::string("shm: ") + std::strerror(errno);
+        return false;
+    }
+
+    int server_cpu = -1;
+    int qemu_cpu = -1;
+    if (opts.pin) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        unsigned int stride = 1 + opts.cores;
+        server_cpu = static_cast<int>((stride * pair.slot) % cpus);
+        qemu_cpu = static_cast<int>((stride * pair.slot + 1) % cpus);
+    }
+    std::string log_prefix = opts.log_dir.empty() ? "" : opts.log_dir + "/" + name;
+
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        pair.failure = "pipe";
+        return false;
+    }
+    std::vector<std::string> server_cmd = {opts.server, "--shm", pair.shm_name, "--ready-fd", std::to_string(fds[1])};
+    server_cmd.insert(server_cmd.end(), opts.server_args.begin(), opts.server_args.end());
+    pair.server_pid = spawn(server_cmd, server_cpu, 1, log_prefix.empty() ? "" : log_prefix + ".systemc.log", fds[1]);
+    close(fds[1]);
+    bool ready = wait_ready(fds[0], opts.ready_timeout_s);
+    close(fds[0]);
+    if (!ready) {
+        pair.failure = "server not ready";
+        return false;
+    }
+
+    // Several cores run on custom-arm-mc, one MTTCG thread per core.
+    std::string machine = opts.cores > 1 ? "custom-arm-mc" : "custom-arm";
+    std::vector<std::string> qemu_cmd = {
+        opts.qemu,
+        "-machine", machine + ",cosim-shm=" + pair.shm_name,
+        "-nographic",
+        "-monitor", "none",
+        "-semihosting-config", "enable=on,target=native",
+        "-kernel", opts.firmware[pair.job],
+    };
+    if (opts.cores > 1) {
+        qemu_cmd.insert(qemu_cmd.end(), {"-smp", std::to_string(opts.cores), "-accel", "tcg,thread=multi"});
+    }
+    qemu_cmd.insert(qemu_cmd.end(), opts.qemu_args.begin(), opts.qemu_args.end());
+    pair.qemu_pid = spawn(qemu_cmd, qemu_cpu, opts.cores, log_prefix.empty() ? "" : log_prefix + ".qemu.log", -1);
+    return true;
+}
+
+std::string describe(const Pair& pair) {
+    if (!pair.failure.empty()) {
+        return pair.failure;
+    }
+    if (pair.timed_out) {
+        return "timeout";
+    }
+    if (WIFEXITED(pair.server_status) && WEXITSTATUS(pair.server_status) == 1) {
+        return "transaction errors";
+    }
+    if (!WIFEXITED(pair.server_status) || WEXITSTATUS(pair.server_status) != 0) {
+        return "server failed";
+    }
+    // Stopped by --run-for: QEMU ends on the SIGTERM sent to it.
+    if (pair.stopped) {
+        return pair.transactions ? "pass" : "no accesses";
+    }
+    if (WIFSIGNALED(pair.qemu_status)) {
+        return std::string("qemu ") + strsignal(WTERMSIG(pair.qemu_status));
+    }
+    if (WEXITSTATUS(pair.qemu_status) != 0) {
+        return "firmware exit " + std::to_string(WEXITSTATUS(pair.qemu_status));
+    }
+    return "pass";
+}
+
+void write_report(const std::string& path, const std::vector<Outcome>& outcomes) {
+    std::ofstream out(path);
+    out << "name,result,wall_s,transactions\n";
+    for (const Outcome& o : outcomes) {
+        out << o.name << "," << o.result << "," << o.wall_s << "," << o.transactions << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options opts;
+    if (!parse_options(argc, argv, opts)) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (opts.qemu.empty()) {
+        const char* env = std::getenv("QEMU_SYSTEM_ARM");
+        opts.qemu = env ? env : "qemu-system-arm";
+    }
+    if (opts.jobs == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        unsigned int per_pair = 1 + opts.cores;
+        opts.jobs = cpus > per_pair ? static_cast<unsigned int>(cpus / per_pair) : 1;
+    }
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    std::vector<Outcome> outcomes(opts.firmware.size());
+    std::vector<Pair> running;
+    std::vector<bool> slot_busy(opts.jobs, false);
+    size_t next = 0;
+    auto start = Clock::now();
+
+    while ((next < opts.firmware.size() || !running.empty()) && !interrupted) {
+        while (next < opts.firmware.size() && running.size() < opts.jobs) {
+            Pair pair;
+            pair.job = next;
+            pair.slot = std::find(slot_busy.begin(), slot_busy.end(), false) - slot_busy.begin();
+            pair.start = Clock::now();
+            pair.deadline = pair.start + std::chrono::seconds(opts.timeout_s);
+            pair.stop_at = pair.start + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(opts.run_for_s));
+            outcomes[next].name = pair_name(next, opts.firmware[next]);
+            if (!start_pair(pair, opts, outcomes[next].name)) {
+                kill_pair(pair, SIGKILL);
+            }
+            slot_busy[pair.slot] = true;
+            running.push_back(pair);
+            ++next;
+        }
+
+        int status = 0;
+        pid_t pid;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+            for (Pair& pair : running) {
+                if (pid == pair.qemu_pid) {
+                    pair.qemu_status = status;
+                    pair.qemu_pid = 0;
+                } else if (pid == pair.server_pid) {
+                    pair.server_status = status;
+                    pair.server_pid = 0;
+                } else {
+                    continue;
+                }
+                // Either side ending releases the other: the server stops
+                // serving, and a QEMU still waiting for a response faults.
+                if (pair.channel) {
+                    cosim_store(&pair.channel->shutdown, 1);
+                }
+                if (pair.qemu_pid > 0 && pair.server_pid == 0) {
+                    kill(pair.qemu_pid, SIGTERM);
+                }
+                break;
+            }
+        }
+
+        auto now = Clock::now();
+        for (auto it = running.begin(); it != running.end();) {
+            Pair& pair = *it;
+            if (now > pair.deadline && !pair.timed_out) {
+                pair.timed_out = true;
+                kill_pair(pair, SIGKILL);
+            }
+            // The server leaves on shutdown with its error count as status.
+            if (opts.run_for_s > 0 && now > pair.stop_at && !pair.stopped && pair.qemu_pid > 0 &&
+                pair.server_pid > 0) {
+                pair.stopped = true;
+                cosim_store(&pair.channel->shutdown, 1);
+                kill(pair.qemu_pid, SIGTERM);
+            }
+            if (pair.qemu_pid > 0 || pair.server_pid > 0) {
+                ++it;
+                continue;
+            }
+
+            Outcome& outcome = outcomes[pair.job];
+            if (pair.channel) {
+                pair.transactions = __atomic_load_n(&pair.channel->transactions, __ATOMIC_RELAXED);
+                cosim_channel_close(pair.channel);
+                shm_unlink(pair.shm_name.c_str());
+            }
+            outcome.result = describe(pair);
+            outcome.wall_s = std::chrono::duration<double>(now - pair.start).count();
+            outcome.transactions = pair.transactions;
+            std::cout << "[Cosim] " << outcome.name << ": " << outcome.result << " ("
+                      << outcome.wall_s << " s, " << outcome.transactions << " transactions)"
+                      << std::endl;
+
+            slot_busy[pair.slot] = false;
+            it = running.erase(it);
+        }
+
+        usleep(10000);
+    }
+
+    if (interrupted) {
+        for (Pair& pair : running) {
+            kill_pair(pair, SIGKILL);
+            if (pair.channel) {
+                shm_unlink(pair.shm_name.c_str());
+            }
+        }
+        while (waitpid(-1, nullptr, 0) > 0) {
+        }
+        std::cerr << "[Cosim] Interrupted" << std::endl;
+        return 130;
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    size_t pass_count = std::count_if(outcomes.begin(), outcomes.end(),
+                                      [](const Outcome& o) { return o.result == "pass"; });
+    std::cout << "[Cosim] " << pass_count << "/" << outcomes.size() << " pairs passed in " << elapsed
+              << " s (" << opts.jobs << " parallel pairs)" << std::endl;
+
+    if (!opts.output_file.empty()) {
+        write_report(opts.output_file, outcomes);
+    }
+    return pass_count == outcomes.size() ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+"""Mapping of neural-network layers onto memory_array geometry.
+
+A layer is a GEMM: M input vectors of length K against a K x N weight
+matrix. A convolution becomes one by im2col: M output pixels, K =
+in_channels * kernel^2 inputs per pixel and N = out_channels. The weight
+matrix is cut into tile_size x tile_size tiles (K along the rows, N along
+the columns), and the tiles are placed round robin on the physical tiles
+of the array. A layer with more tiles than the array holds is run in
+passes, reloading the weights each time.
+
+The geometry mirrors the memory_array macro in tools/rtl/rtl_rules.bzl.
+Keep the two in step.
+"""
+
+import math
+
+import yaml
+
+PRECISIONS = {"int%d" % bits: bits for bits in range(1, 9)}
+
+
+class ArrayConfig:
+    """The attributes of one memory_array() and the hierarchy they imply."""
+
+    def __init__(self, size, cell_type, precision="int8", power_mode="balanced", compute_width=16):
+        rows, cols = size.split("x")
+        self.rows = int(rows)
+        self.cols = int(cols)
+        self.size = size
+        self.cell_type = cell_type
+        self.precision = precision
+        self.power_mode = power_mode
+        self.compute_width = compute_width
+        if precision not in PRECISIONS:
+            raise ValueError("unsupported precision %s" % precision)
+        self.data_width = PRECISIONS[precision]
+
+        total_cells = self.rows * self.cols
+        if total_cells > 1000000:
+            self.tile_size, self.bank_size, self.build_strategy = 64, 256, "distributed"
+        elif total_cells > 100000:
+            self.tile_size, self.bank_size, self.build_strategy = 32, 128, "parallel"
+        else:
+            self.tile_size, self.bank_size, self.build_strategy = 16, 64, "single"
+
+    @classmethod
+    def from_dict(cls, attrs):
+        known = ("size", "cell_type", "precision", "power_mode", "compute_width")
+        unknown = set(attrs) - set(known)
+        if unknown:
+            raise ValueError("unknown array attributes: %s" % ", ".join(sorted(unknown)))
+        return cls(**attrs)
+
+    @property
+    def tiles(self):
+        """Physical tiles in the array."""
+        return (self.rows // self.tile_size) * (self.cols // self.tile_size)
+
+    @property
+    def tiles_per_bank(self):
+        return (self.bank_size // self.tile_size) ** 2
+
+    @property
+    def banks(self):
+        return max(1, self.tiles // self.tiles_per_bank)
+
+    def bank_of(self, tile):
+        return tile // self.tiles_per_bank if self.tiles >= self.tiles_per_bank else 0
+
+    def describe(self):
+        return "%s %s %s %s: %d tiles of %dx%d in %d banks of %dx%d" % (
+            self.size, self.cell_type, self.precision, self.power_mode, self.tiles,
+            self.tile_size, self.tile_size, self.banks, self.bank_size, self.bank_size)
+
+
+class Layer:
+    """One layer as a GEMM: outputs (m, n) = inputs (m, k) x weights (k, n)."""
+
+    def __init__(self, name, m, k, n):
+        if m < 1 or k < 1 or n < 1:
+            raise ValueError("layer %s: empty GEMM %dx%dx%d" % (name, m, k, n))
+        self.name = name
+        self.m = m
+        self.k = k
+        self.n = n
+
+    @classmethod
+    def from_dict(cls, index, attrs):
+        attrs = dict(attrs)
+        name = attrs.pop("name", "layer%d" % index)
+        kind = attrs.pop("type", "gemm")
+        try:
+            if kind == "gemm":
+                layer = cls(name, int(attrs.pop("m", 1)), int(attrs.pop("k")), int(attrs.pop("n")))
+            elif kind == "conv":
+                kernel = attrs.pop("kernel")
+                kh, kw = (kernel, kernel) if isinstance(kernel, int) else kernel
+                height, width = attrs.pop("input")
+                stride = attrs.pop("stride", 1)
+                padding = attrs.pop("padding", 0)
+                batch = attrs.pop("batch", 1)
+                out_h = (height + 2 * padding - kh) // stride + 1
+                out_w = (width + 2 * padding - kw) // stride + 1
+                layer = cls(name, batch * out_h * out_w, attrs.pop("in_channels") * kh * kw,
+                            attrs.pop("out_channels"))
+            else:
+                raise ValueError("layer %s: unknown type %s" % (name, kind))
+        except KeyError as missing:
+            raise ValueError("layer %s: missing %s" % (name, missing))
+        if attrs:
+            raise ValueError("layer %s: unknown attributes %s" % (name, ", ".join(sorted(attrs))))
+        return layer
+
+    @property
+    def macs(self):
+        return self.m * self.k * self.n
+
+
+class Tile:
+    """One tile_size x tile_size block of a layer's weights."""
+
+    def __init__(self, row_block, col_block, rows_used, cols_used):
+        self.row_block = row_block
+        self.col_block = col_block
+        self.rows_used = rows_used
+        self.cols_used = cols_used
+
+
+class TilePlan:
+    """A layer cut into tiles and placed round robin on the array."""
+
+    def __init__(self, config, layer):
+        size = config.tile_size
+        self.config = config
+        self.layer = layer
+        self.row_blocks = math.ceil(layer.k / size)
+        self.col_blocks = math.ceil(layer.n / size)
+        self.tiles = [Tile(r, c, min(size, layer.k - r * size), min(size, layer.n - c * size))
+                      for c in range(self.col_blocks) for r in range(self.row_blocks)]
+        # Ordered by output column block, so the row blocks whose partial
+        # sums add up land on neighbouring physical tiles.
+        self.placement = [i % config.tiles for i in range(len(self.tiles))]
+        self.passes = math.ceil(len(self.tiles) / config.tiles)
+
+    @property
+    def cell_utilisation(self):
+        """Share of the cells in the used tiles that hold a weight."""
+        used = self.layer.k * self.layer.n
+        return used / (len(self.tiles) * self.config.tile_size ** 2)
+
+
+class Schedule:
+    """Timeline of a TilePlan given per-tile load and compute times.
+
+    Each physical tile double buffers its weights: the load of its next
+    tile overlaps its current compute, and the swap waits for both. Loads
+    within one bank share its write port and run one at a time. Layers run
+    one after the other.
+    """
+
+    def __init__(self, plan, load_time, compute_time):
+        config = plan.config
+        port_free = [0.0] * config.banks
+        shadow_free = [0.0] * config.tiles
+        compute_free = [0.0] * config.tiles
+        self.busy = 0.0
+        for tile, slot in enumerate(plan.placement):
+            bank = config.bank_of(slot)
+            load_start = max(port_free[bank], shadow_free[slot])
+            load_end = load_start + load_time(tile)
+            port_free[bank] = load_end
+            compute_start = max(load_end, compute_free[slot])
+            compute_free[slot] = compute_start + compute_time(tile)
+            # The shadow bank is free again once the swap made it active.
+            shadow_free[slot] = compute_start
+            self.busy += compute_time(tile)
+        self.makespan = max(compute_free)
+        self.used_tiles = min(len(plan.placement), config.tiles)
+
+    @property
+    def array_utilisation(self):
+        """Share of time the physical tiles in use spend computing."""
+        return self.busy / (self.makespan * self.used_tiles) if self.makespan else 0.0
+
+
+def load_workload(path):
+    """Reads a YAML workload: an `array` mapping of memory_array attributes
+    (optional) and a `layers` list. Returns (array attributes, layers)."""
+    with open(path) as stream:
+        workload = yaml.safe_load(stream) or {}
+    array = workload.get("array", {})
+    layers = [Layer.from_dict(i, attrs) for i, attrs in enumerate(workload.get("layers", []))]
+    if not layers:
+        raise ValueError("%s: no layers" % path)
+    return array, layers
@@ -0,0 +1,100 @@
+"""TilePlan and Schedule on small arrays where every tile, pass and
+timeline can be worked out by hand."""
+
+import unittest
+
+from cim_mapping import ArrayConfig, Layer, Schedule, TilePlan
+
+
+class TilePlanTest(unittest.TestCase):
+    def setUp(self):
+        # 4096 cells: 16x16 tiles in one 64x64 bank, so 16 physical tiles.
+        self.config = ArrayConfig("64x64", "sram")
+
+    def test_geometry(self):
+        config = self.config
+        self.assertEqual((config.tile_size, config.tiles, config.banks), (16, 16, 1))
+
+    def test_layer_of_one_tile(self):
+        plan = TilePlan(self.config, Layer("fc", 1, 16, 16))
+        self.assertEqual((plan.row_blocks, plan.col_blocks, len(plan.tiles), plan.passes), (1, 1, 1, 1))
+        self.assertEqual(plan.cell_utilisation, 1.0)
+
+    def test_non_divisible_shape(self):
+        # K = 20 is 16 + 4 rows, N = 40 is 16 + 16 + 8 columns.
+        plan = TilePlan(self.config, Layer("fc", 1, 20, 40))
+        self.assertEqual((plan.row_blocks, plan.col_blocks, plan.passes), (2, 3, 1))
+        self.assertEqual([(t.row_block, t.col_block) for t in plan.tiles],
+                         [(0, 0), (1, 0), (0, 1), (1, 1), (0, 2), (1, 2)])
+        self.assertEqual([(t.rows_used, t.cols_used) for t in plan.tiles],
+                         [(16, 16), (4, 16), (16, 16), (4, 16), (16, 8), (4, 8)])
+        self.assertEqual(plan.placement, [0, 1, 2, 3, 4, 5])
+        self.assertAlmostEqual(plan.cell_utilisation, 20 * 40 / (6 * 256))
+
+    def test_layer_larger_than_the_array(self):
+        # 7 x 4 = 28 tiles on 16 physical ones: two passes, wrapping round.
+        plan = TilePlan(self.config, Layer("fc", 1, 100, 50))
+        self.assertEqual((plan.row_blocks, plan.col_blocks, len(plan.tiles), plan.passes), (7, 4, 28, 2))
+        self.assertEqual(plan.placement, list(range(16)) + list(range(12)))
+        self.assertEqual((plan.tiles[-1].rows_used, plan.tiles[-1].cols_used), (4, 2))
+
+    def test_conv_from_dict(self):
+        # 8x8 input, 3x3 kernel, padding 1: 64 pixels of 4 * 9 inputs.
+        layer = Layer.from_dict(0, {"type": "conv", "input": [8, 8], "kernel": 3, "padding": 1,
+                                    "in_channels": 4, "out_channels": 8})
+        self.assertEqual((layer.m, layer.k, layer.n), (64, 36, 8))
+
+    def test_bad_layers(self):
+        with self.assertRaises(ValueError):
+            Layer("empty", 1, 0, 16)
+        with self.assertRaises(ValueError):
+            Layer.from_dict(0, {"k": 16})
+        with self.assertRaises(ValueError):
+            Layer.from_dict(0, {"k": 16, "n": 16, "bias": True})
+
+
+class ScheduleTest(unittest.TestCase):
+    def test_one_tile(self):
+        plan = TilePlan(ArrayConfig("64x64", "sram"), Layer("fc", 1, 16, 16))
+        schedule = Schedule(plan, lambda i: 2.0, lambda i: 3.0)
+        self.assertEqual(schedule.makespan, 5.0)
+        self.assertAlmostEqual(schedule.array_utilisation, 3.0 / 5.0)
+
+    def test_double_buffering_on_one_tile(self):
+        # One physical tile, two weight tiles: the second load (2..4)
+        # overlaps the first compute (2..5), and its compute waits for it.
+        config = ArrayConfig("16x16", "sram")
+        self.assertEqual(config.tiles, 1)
+        plan = TilePlan(config, Layer("fc", 1, 32, 16))
+        self.assertEqual(plan.passes, 2)
+        schedule = Schedule(plan, lambda i: 2.0, lambda i: 3.0)
+        self.assertEqual(schedule.makespan, 8.0)
+        self.assertAlmostEqual(schedule.array_utilisation, 6.0 / 8.0)
+
+    def test_loads_share_the_bank_port(self):
+        # Two tiles in one bank: the second load waits for the first.
+        plan = TilePlan(ArrayConfig("64x64", "sram"), Layer("fc", 1, 32, 16))
+        schedule = Schedule(plan, lambda i: 2.0, lambda i: 3.0)
+        self.assertEqual(schedule.makespan, 7.0)
+        self.assertAlmostEqual(schedule.array_utilisation, 6.0 / (7.0 * 2))
+
+    def test_banks_load_in_parallel(self):
+        # 512x512: 32x32 tiles, 16 per 128x128 bank, 16 banks. Tile 16
+        # lands in bank 1 and loads alongside bank 0's sixteen.
+        config = ArrayConfig("512x512", "sram")
+        self.assertEqual((config.tile_size, config.tiles, config.banks), (32, 256, 16))
+        plan = TilePlan(config, Layer("fc", 1, 17 * 32, 32))
+        self.assertEqual(config.bank_of(plan.placement[16]), 1)
+        schedule = Schedule(plan, lambda i: 1.0, lambda i: 1.0)
+        self.assertEqual(schedule.makespan, 17.0)
+
+    def test_per_tile_costs(self):
+        # Uneven computes on one physical tile: loads 0..1 and 1..2,
+        # computes 1..5 then 5..6.
+        plan = TilePlan(ArrayConfig("16x16", "sram"), Layer("fc", 1, 32, 16))
+        schedule = Schedule(plan, lambda i: 1.0, lambda i: [4.0, 1.0][i])
+        self.assertEqual(schedule.makespan, 6.0)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,229 @@
+"""Analytical latency and throughput of a memory_array configuration.
+
+A roofline over the same mapping as map_layers (cim_mapping.TilePlan),
+in closed form, so one configuration and layer costs microseconds
+instead of a simulation:
+
+  compute  each physical tile runs ceil(tiles / array tiles) tiles of M
+           vectors, at vector_cycles per vector
+  load     weight loads share one write port per bank; a tile costs
+           load_cycles, stretched by the cell type's write cost
+  overlap  with double buffering the layer takes the larger of the two,
+           plus the first load (fill) or the last compute (drain)
+  extra    accumulation of the K partial sums through an adder tree, and
+           power-domain wake-ups, per layer or per pass by power_mode
+
+vector_cycles and load_cycles default to the costs MemoryWrapper charges
+through the memif bridge (128-bit bus, one row per clock into the shadow
+bank), or with --timing rtl to VerilatedArray's two cycles per input bit.
+--calibrate measures them on cim_sim instead. The cell-type and
+power-mode costs are not modelled by the simulators. Their defaults
+below are placeholders, to be replaced from characterisation through
+--params.
+
+    bazel run //tools/mapper:estimate -- $PWD/tools/mapper/examples/cnn_edge.yaml
+    bazel run //tools/mapper:estimate -- model.yaml --size 1024x1024 --precision int8 --check
+"""
+
+import argparse
+import json
+import math
+import sys
+import time
+
+from cim_mapping import ArrayConfig, Schedule, TilePlan, load_workload
+
+BRIDGE_BUS_BYTES = 16
+CLOCK_NS = 1.0
+
+# Write cycles per row relative to SRAM.
+CELL_WRITE_FACTOR = {"sram": 1.0, "mram": 2.0, "rram": 4.0, "pcm": 8.0}
+
+# Wake-up cycles of a gated power domain, and how often it is paid.
+POWER_WAKE = {
+    "performance": (0, "never"),
+    "balanced": (8, "layer"),
+    "low_power": (16, "pass"),
+    "ultra_low": (32, "pass"),
+}
+
+
+def default_params(config, timing="model"):
+    size = config.tile_size
+    bus_in = math.ceil(size / BRIDGE_BUS_BYTES)
+    bus_out = math.ceil(size * 4 / BRIDGE_BUS_BYTES)
+    # Input write, CTRL write, the compute itself, result read.
+    compute = 1 if timing == "model" else 2 * config.data_width
+    params = {
+        "clock_ns": CLOCK_NS,
+        "vector_cycles": bus_in + 1 + compute + bus_out,
+        # Shadow write (bus beats or one row per clock, whichever is
+        # longer), then the SWAP cycle and its CTRL write.
+        "load_cycles": max(math.ceil(size * size / BRIDGE_BUS_BYTES), size) + 2,
+        "cell_write_factor": CELL_WRITE_FACTOR.get(config.cell_type, 1.0),
+        "adder_cycles": 1,
+    }
+    wake, every = POWER_WAKE.get(config.power_mode, (0, "never"))
+    params["wake_cycles"] = wake
+    params["wake_every"] = every
+    return params
+
+
+class Estimate:
+    def __init__(self, config, layer, params):
+        # The counts of TilePlan, without building its tile list.
+        self.layer = layer
+        row_blocks = math.ceil(layer.k / config.tile_size)
+        tiles = row_blocks * math.ceil(layer.n / config.tile_size)
+        slots = config.tiles
+        self.tiles = tiles
+        self.passes = math.ceil(tiles / slots)
+        clock = params["clock_ns"]
+
+        per_tile_compute = layer.m * params["vector_cycles"]
+        per_tile_load = params["load_cycles"] * params["cell_write_factor"]
+        # Round robin fills slot 0 (and so bank 0) first and most.
+        busiest_slot = math.ceil(tiles / slots)
+        first_bank = range(min(config.tiles_per_bank, slots))
+        busiest_bank = sum(tiles // slots + (1 if s < tiles % slots else 0) for s in first_bank)
+
+        self.compute_ns = busiest_slot * per_tile_compute * clock
+        self.load_ns = busiest_bank * per_tile_load * clock
+        pipeline = max(per_tile_load + busiest_slot * per_tile_compute,
+                       busiest_bank * per_tile_load + per_tile_compute)
+        self.bound = "compute" if self.compute_ns >= self.load_ns else "load"
+
+        accumulate = params["adder_cycles"] * math.ceil(math.log2(row_blocks)) if row_blocks > 1 else 0
+        wakes = {"never": 0, "layer": 1, "pass": self.passes}[params["wake_every"]]
+        self.overhead_ns = (accumulate + wakes * params["wake_cycles"]) * clock
+        self.latency_ns = pipeline * clock + self.overhead_ns
+        self.gops = 2.0 * layer.macs / self.latency_ns
+
+    def as_dict(self):
+        layer = self.layer
+        return {
+            "name": layer.name,
+            "m": layer.m,
+            "k": layer.k,
+            "n": layer.n,
+            "tiles": self.tiles,
+            "passes": self.passes,
+            "bound": self.bound,
+            "compute_ns": self.compute_ns,
+            "load_ns": self.load_ns,
+            "overhead_ns": self.overhead_ns,
+            "latency_ns": self.latency_ns,
+            "gops": self.gops,
+        }
+
+
+def ridge_point(config, params):
+    """Vectors per weight tile at which loads stop being the bound."""
+    return params["load_cycles"] * params["cell_write_factor"] * config.tiles_per_bank / params["vector_cycles"]
+
+
+def scheduled_ns(config, layer, params):
+    """Latency from the tile-by-tile Schedule map_layers uses, with the
+    same per-tile costs; what the closed form approximates."""
+    plan = TilePlan(config, layer)
+    load = params["load_cycles"] * params["cell_write_factor"] * params["clock_ns"]
+    compute = layer.m * params["vector_cycles"] * params["clock_ns"]
+    return Schedule(plan, lambda i: load, lambda i: compute).makespan
+
+
+def calibrate(config, vectors=64):
+    """Measures vector_cycles and load_cycles on a tile-sized cim_sim array."""
+    import numpy as np
+    import cim_sim
+
+    size = config.tile_size
+    array = cim_sim.CimArray(size, size, config.data_width, config.compute_width)
+    weights = np.zeros((size, size), dtype=np.int8)
+    inputs = np.zeros((vectors, size), dtype=np.int8)
+    out = np.empty((vectors, size), dtype=np.int32)
+
+    start = array.sim_time_ps
+    array.load_weights(weights, shadow=True)
+    array.swap_weights()
+    loaded = array.sim_time_ps
+    array.compute(inputs, cim_sim.ComputeMode.MAC, out=out)
+    done = array.sim_time_ps
+
+    clock_ps = CLOCK_NS * 1000
+    return {
+        "load_cycles": (loaded - start) / clock_ps,
+        "vector_cycles": (done - loaded) / clock_ps / vectors,
+    }
+
+
+def print_report(config, params, estimates, out, check=None):
+    out.write("[Estimate] %s\n" % config.describe())
+    out.write("[Estimate] %.1f cycles/vector, %.1f cycles/tile load, ridge at M = %.1f\n" % (
+        params["vector_cycles"], params["load_cycles"] * params["cell_write_factor"], ridge_point(config, params)))
+    out.write("%-16s %20s %6s %6s %8s %12s %12s %12s %8s%s\n" % (
+        "layer", "M x K x N", "tiles", "passes", "bound", "compute_us", "load_us", "latency_us", "GOPS",
+        "  schedule_us  error" if check else ""))
+    total_ns = 0.0
+    total_ops = 0
+    for i, estimate in enumerate(estimates):
+        row = estimate.as_dict()
+        total_ns += row["latency_ns"]
+        total_ops += 2 * estimate.layer.macs
+        line = "%-16s %20s %6d %6d %8s %12.3f %12.3f %12.3f %8.2f" % (
+            row["name"], "%dx%dx%d" % (row["m"], row["k"], row["n"]), row["tiles"], row["passes"], row["bound"],
+            row["compute_ns"] / 1e3, row["load_ns"] / 1e3, row["latency_ns"] / 1e3, row["gops"])
+        if check:
+            reference = check[i]
+            line += "  %11.3f %5.1f%%" % (reference / 1e3, 100 * (row["latency_ns"] - reference) / reference)
+        out.write(line + "\n")
+    out.write("[Estimate] total %.3f us, %.2f GOPS\n" % (total_ns / 1e3, total_ops / total_ns))
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("workload", help="YAML with an optional `array` section and a `layers` list")
+    parser.add_argument("--size", help="memory_array size, e.g. 256x256")
+    parser.add_argument("--cell-type", help="memory_array cell_type")
+    parser.add_argument("--precision", help="memory_array precision, e.g. int4")
+    parser.add_argument("--power-mode", help="memory_array power_mode")
+    parser.add_argument("--timing", choices=("model", "rtl"), default="model",
+                        help="per-vector cost of the TLM model or of the Verilated RTL")
+    parser.add_argument("--params", help="JSON overriding the estimator parameters")
+    parser.add_argument("--calibrate", action="store_true",
+                        help="measure vector and load cycles on cim_sim first")
+    parser.add_argument("--check", action="store_true",
+                        help="compare against the tile-by-tile schedule with the same costs")
+    parser.add_argument("--json", help="also write the parameters and per-layer estimates to this file")
+    args = parser.parse_args(argv)
+
+    attrs, layers = load_workload(args.workload)
+    for key in ("size", "cell_type", "precision", "power_mode"):
+        if getattr(args, key) is not None:
+            attrs[key] = getattr(args, key)
+    if "size" not in attrs or "cell_type" not in attrs:
+        parser.error("the array needs a size and cell_type, from the workload or the command line")
+    config = ArrayConfig.from_dict(attrs)
+
+    params = default_params(config, args.timing)
+    if args.calibrate:
+        params.update(calibrate(config))
+    if args.params:
+        with open(args.params) as stream:
+            params.update(json.load(stream))
+
+    start = time.perf_counter()
+    estimates = [Estimate(config, layer, params) for layer in layers]
+    elapsed = time.perf_counter() - start
+    check = [scheduled_ns(config, layer, params) for layer in layers] if args.check else None
+    print_report(config, params, estimates, sys.stdout, check)
+    print("[Estimate] %d layers in %.1f us" % (len(layers), elapsed * 1e6))
+
+    if args.json:
+        with open(args.json, "w") as stream:
+            json.dump({"array": attrs, "params": params, "layers": [e.as_dict() for e in estimates]}, stream,
+                      indent=2)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
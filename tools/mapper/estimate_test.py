@@ -0,0 +1,79 @@
+"""Estimate against roofline numbers worked out by hand on a 64x64 array:
+16x16 tiles, 16 physical tiles, one bank."""
+
+import unittest
+
+from cim_mapping import ArrayConfig, Layer
+from estimate import Estimate, default_params, ridge_point, scheduled_ns
+
+
+class DefaultParamsTest(unittest.TestCase):
+    def test_model_timing(self):
+        params = default_params(ArrayConfig("64x64", "sram"))
+        # 1 input beat + CTRL + 1 compute + 4 result beats.
+        self.assertEqual(params["vector_cycles"], 7)
+        # 256 weight bytes in 16 beats, then SWAP and its CTRL write.
+        self.assertEqual(params["load_cycles"], 18)
+        self.assertEqual((params["wake_cycles"], params["wake_every"]), (8, "layer"))
+
+    def test_rtl_timing(self):
+        params = default_params(ArrayConfig("64x64", "sram", precision="int4"), "rtl")
+        self.assertEqual(params["vector_cycles"], 1 + 1 + 2 * 4 + 4)
+
+
+class EstimateTest(unittest.TestCase):
+    def test_load_bound(self):
+        # M=10, K=20, N=40: 2 x 3 = 6 tiles, all in bank 0.
+        #   compute  1 tile per slot * 10 vectors * 7 cycles  =  70
+        #   load     6 tiles * 18 cycles                      = 108
+        #   pipeline max(18 + 70, 108 + 70)                   = 178
+        #   overhead adder tree ceil(log2 2) + one wake of 8   =   9
+        config = ArrayConfig("64x64", "sram")
+        estimate = Estimate(config, Layer("fc", 10, 20, 40), default_params(config))
+        self.assertEqual((estimate.tiles, estimate.passes, estimate.bound), (6, 1, "load"))
+        self.assertEqual(estimate.compute_ns, 70)
+        self.assertEqual(estimate.load_ns, 108)
+        self.assertEqual(estimate.overhead_ns, 9)
+        self.assertEqual(estimate.latency_ns, 187)
+        self.assertAlmostEqual(estimate.gops, 2.0 * 10 * 20 * 40 / 187)
+
+    def test_compute_bound(self):
+        # M=100 on one tile: 18 to load, then 700 to compute, no overhead.
+        config = ArrayConfig("64x64", "sram", power_mode="performance")
+        params = default_params(config)
+        layer = Layer("fc", 100, 16, 16)
+        estimate = Estimate(config, layer, params)
+        self.assertEqual(estimate.bound, "compute")
+        self.assertEqual((estimate.compute_ns, estimate.load_ns, estimate.overhead_ns), (700, 18, 0))
+        self.assertEqual(estimate.latency_ns, 718)
+        # One tile leaves nothing to approximate.
+        self.assertEqual(scheduled_ns(config, layer, params), estimate.latency_ns)
+
+    def test_layer_larger_than_the_array(self):
+        # K=100, N=50: 7 x 4 = 28 tiles over 16 slots, so 2 passes.
+        # RRAM loads cost 4 x 18 = 72; low_power wakes (16) every pass.
+        #   compute  2 tiles in slot 0 * 4 vectors * 7 = 56
+        #   load     28 tiles * 72                     = 2016
+        #   pipeline max(72 + 56, 2016 + 28)            = 2044
+        #   overhead ceil(log2 7) + 2 * 16              = 35
+        config = ArrayConfig("64x64", "rram", power_mode="low_power")
+        estimate = Estimate(config, Layer("fc", 4, 100, 50), default_params(config))
+        self.assertEqual((estimate.tiles, estimate.passes, estimate.bound), (28, 2, "load"))
+        self.assertEqual((estimate.compute_ns, estimate.load_ns, estimate.overhead_ns), (56, 2016, 35))
+        self.assertEqual(estimate.latency_ns, 2079)
+
+    def test_clock_scales_time(self):
+        config = ArrayConfig("64x64", "sram")
+        params = default_params(config)
+        params["clock_ns"] = 2.0
+        estimate = Estimate(config, Layer("fc", 10, 20, 40), params)
+        self.assertEqual(estimate.latency_ns, 2 * 187)
+
+    def test_ridge_point(self):
+        # 18-cycle loads for 16 tiles in a bank, against 7-cycle vectors.
+        config = ArrayConfig("64x64", "sram")
+        self.assertAlmostEqual(ridge_point(config, default_params(config)), 18 * 16 / 7)
+
+
+if __name__ == "__main__":
+    unittest.main()
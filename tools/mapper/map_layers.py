@@ -0,0 +1,160 @@
+"""Maps a YAML layer description onto a memory_array and runs it.
+
+Every tile of every layer is loaded into the shadow bank of a
+tile_size x tile_size cim_sim.CimArray, swapped in and computed, and the
+simulated time of each step is recorded. The column sums of each tile are
+checked against NumPy with the same compute-width wrap. The per-tile
+times are then scheduled across the physical tiles of the full array
+(cim_mapping.Schedule), giving the latency, utilisation and throughput
+of the layer on that configuration.
+
+    bazel run //tools/mapper:map_layers -- $PWD/tools/mapper/examples/cnn_edge.yaml
+    bazel run //tools/mapper:map_layers -- model.yaml --size 1024x1024 --precision int8
+
+SystemC elaborates once per process, so one configuration per run.
+"""
+
+import argparse
+import json
+import sys
+
+import numpy as np
+
+from cim_mapping import ArrayConfig, Schedule, TilePlan, load_workload
+
+
+def wrap(values, width):
+    """Two's-complement wrap to `width` bits, like the RTL col_sum."""
+    span = 1 << width
+    return (values + (span >> 1)) % span - (span >> 1)
+
+
+class LayerResult:
+    def __init__(self, plan, schedule, vectors, mismatches):
+        self.plan = plan
+        self.schedule = schedule
+        self.vectors = vectors
+        self.mismatches = mismatches
+
+    def as_dict(self):
+        layer = self.plan.layer
+        return {
+            "name": layer.name,
+            "m": layer.m,
+            "k": layer.k,
+            "n": layer.n,
+            "tiles": len(self.plan.tiles),
+            "passes": self.plan.passes,
+            "cell_utilisation": self.plan.cell_utilisation,
+            "array_utilisation": self.schedule.array_utilisation,
+            "latency_ps": self.schedule.makespan,
+            "gops": 2.0 * layer.macs / (self.schedule.makespan / 1000.0) if self.schedule.makespan else 0.0,
+            "simulated_vectors": self.vectors,
+            "mismatches": self.mismatches,
+        }
+
+
+def run_layer(array, config, layer, rng, max_vectors):
+    import cim_sim
+
+    plan = TilePlan(config, layer)
+    size = config.tile_size
+    vectors = min(layer.m, max_vectors) if max_vectors else layer.m
+    low, high = -(1 << (config.data_width - 1)), 1 << (config.data_width - 1)
+
+    # Zero padding to whole tiles contributes nothing to the sums.
+    inputs = np.zeros((vectors, plan.row_blocks * size), dtype=np.int8)
+    inputs[:, :layer.k] = rng.integers(low, high, size=(vectors, layer.k), dtype=np.int8)
+    weights = np.zeros((plan.row_blocks * size, plan.col_blocks * size), dtype=np.int8)
+    weights[:layer.k, :layer.n] = rng.integers(low, high, size=(layer.k, layer.n), dtype=np.int8)
+
+    load_times = []
+    compute_times = []
+    mismatches = 0
+    out = np.empty((vectors, size), dtype=np.int32)
+    for tile in plan.tiles:
+        rows = slice(tile.row_block * size, (tile.row_block + 1) * size)
+        cols = slice(tile.col_block * size, (tile.col_block + 1) * size)
+        block = np.ascontiguousarray(weights[rows, cols])
+        tile_inputs = np.ascontiguousarray(inputs[:, rows])
+
+        start = array.sim_time_ps
+        array.load_weights(block, shadow=True)
+        array.swap_weights()
+        loaded = array.sim_time_ps
+        array.compute(tile_inputs, cim_sim.ComputeMode.MAC, out=out)
+        done = array.sim_time_ps
+
+        load_times.append(loaded - start)
+        # Every vector costs the same, so a capped run scales to all of M.
+        compute_times.append((done - loaded) * layer.m / vectors)
+        expected = wrap(tile_inputs.astype(np.int64) @ block.astype(np.int64), config.compute_width)
+        mismatches += int(np.count_nonzero(out != expected))
+
+    schedule = Schedule(plan, lambda i: load_times[i], lambda i: compute_times[i])
+    return LayerResult(plan, schedule, vectors, mismatches)
+
+
+def print_report(config, results, out):
+    out.write("[Mapper] %s\n" % config.describe())
+    out.write("%-16s %20s %6s %6s %6s %6s %12s %8s\n" %
+              ("layer", "M x K x N", "tiles", "passes", "cells", "busy", "latency_us", "GOPS"))
+    total_ps = 0.0
+    total_ops = 0
+    for result in results:
+        row = result.as_dict()
+        total_ps += row["latency_ps"]
+        total_ops += 2 * result.plan.layer.macs
+        out.write("%-16s %20s %6d %6d %5.1f%% %5.1f%% %12.3f %8.2f%s\n" % (
+            row["name"], "%dx%dx%d" % (row["m"], row["k"], row["n"]), row["tiles"], row["passes"],
+            100 * row["cell_utilisation"], 100 * row["array_utilisation"], row["latency_ps"] / 1e6,
+            row["gops"], "  MISMATCH %d" % row["mismatches"] if row["mismatches"] else ""))
+    if total_ps:
+        out.write("[Mapper] total %.3f us, %.2f GOPS\n" % (total_ps / 1e6, total_ops / (total_ps / 1000.0)))
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("workload", help="YAML with an optional `array` section and a `layers` list")
+    parser.add_argument("--size", help="memory_array size, e.g. 256x256")
+    parser.add_argument("--cell-type", help="memory_array cell_type")
+    parser.add_argument("--precision", help="memory_array precision, e.g. int4")
+    parser.add_argument("--power-mode", help="memory_array power_mode")
+    parser.add_argument("--max-vectors", type=int, default=256,
+                        help="input vectors simulated per tile, scaled up to M (0: all)")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--map-only", action="store_true", help="print the tiling without simulating")
+    parser.add_argument("--json", help="also write the per-layer results to this file")
+    args = parser.parse_args(argv)
+
+    attrs, layers = load_workload(args.workload)
+    for key in ("size", "cell_type", "precision", "power_mode"):
+        if getattr(args, key) is not None:
+            attrs[key] = getattr(args, key)
+    if "size" not in attrs or "cell_type" not in attrs:
+        parser.error("the array needs a size and cell_type, from the workload or the command line")
+    config = ArrayConfig.from_dict(attrs)
+
+    if args.map_only:
+        print("[Mapper] %s" % config.describe())
+        for layer in layers:
+            plan = TilePlan(config, layer)
+            print("%-16s %dx%dx%d: %dx%d tiles, %d passes, %.1f%% of cells used" % (
+                layer.name, layer.m, layer.k, layer.n, plan.row_blocks, plan.col_blocks, plan.passes,
+                100 * plan.cell_utilisation))
+        return 0
+
+    import cim_sim
+
+    array = cim_sim.CimArray(config.tile_size, config.tile_size, config.data_width, config.compute_width)
+    rng = np.random.default_rng(args.seed)
+    results = [run_layer(array, config, layer, rng, args.max_vectors) for layer in layers]
+    print_report(config, results, sys.stdout)
+    if args.json:
+        with open(args.json, "w") as stream:
+            json.dump({"array": attrs, "layers": [result.as_dict() for result in results]}, stream, indent=2)
+    return 1 if any(result.mismatches for result in results) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,54 @@
+"""Renders one RTL or C++ file from a Jinja2 template, for rtl_macro_gen.
+
+The templates read the array size from `output_name` (array_ROWSxCOLS.*)
+and anything else, e.g. DATA_WIDTH and COMPUTE_WIDTH, from the rule's
+defines, each passed as --define KEY=VALUE.
+
+    jinja_gen.py --template cell_array.v.jinja2 --output out/array_8x8.v \\
+        --params gen/array_8x8.v --define DATA_WIDTH=4
+"""
+
+import argparse
+import os
+import sys
+
+import jinja2
+
+
+def parse_define(text):
+    key, sep, value = text.partition("=")
+    if not sep or not key:
+        raise argparse.ArgumentTypeError("expected KEY=VALUE, got %r" % text)
+    return key, value
+
+
+def render(template_path, output_name, defines):
+    loader = jinja2.FileSystemLoader(os.path.dirname(os.path.abspath(template_path)))
+    env = jinja2.Environment(loader=loader, undefined=jinja2.StrictUndefined, keep_trailing_newline=True)
+    template = env.get_template(os.path.basename(template_path))
+    context = dict(defines)
+    context["output_name"] = output_name
+    return template.render(**context)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--template", required=True, help="Jinja2 template")
+    parser.add_argument("--output", required=True, help="file to write")
+    parser.add_argument("--params", help="name the template parses for its size (default: --output)")
+    parser.add_argument("--define", type=parse_define, action="append", default=[], metavar="KEY=VALUE",
+                        help="template variable; may be repeated")
+    args = parser.parse_args(argv)
+
+    try:
+        text = render(args.template, args.params or args.output, args.define)
+    except jinja2.TemplateError as error:
+        sys.stderr.write("[jinja_gen] %s: %s\n" % (args.template, error))
+        return 1
+    with open(args.output, "w") as stream:
+        stream.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
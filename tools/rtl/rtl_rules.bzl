@@ -1,5 +1,7 @@
 """RTL build rules for Bazel - Memory Array compilation support"""
 
+load("@bazel_tools//tools/cpp:toolchain_utils.bzl", "find_cpp_toolchain")
+
 def _rtl_library_impl(ctx):
     """Implementation of rtl_library rule"""
     srcs = ctx.files.srcs
@@ -53,6 +55,8 @@ def _rtl_macro_gen_impl(ctx):
         args.add_all(["--template", template])
         args.add_all(["--output", output])
         args.add_all(["--params", output_name])
+        for key, value in ctx.attr.defines.items():
+            args.add_all(["--define", "%s=%s" % (key, value)])
         
         ctx.actions.run(
             inputs = [template],
@@ -98,6 +102,72 @@ def _rtl_synthesis_impl(ctx):
         ),
     ]
 
+def _rtl_verilate_impl(ctx):
+    """Implementation of rtl_verilate rule"""
+    verilog_files = [src for src in ctx.files.srcs if src.extension in ["v", "sv"]]
+    prefix = "V" + ctx.attr.top
+    
+    # Verilator's file set depends on the design, so it goes to a directory
+    out_dir = ctx.actions.declare_directory(ctx.label.name + "_verilated")
+    
+    args = ctx.actions.args()
+    args.add_all(["--cc", "-O3", "--x-assign", "fast", "--x-initial", "fast", "-Wno-fatal"])
+    args.add_all(["--top-module", ctx.attr.top])
+    args.add_all(["--prefix", prefix])
+    args.add_all(["--Mdir", out_dir.path])
+    for key, value in ctx.attr.parameters.items():
+        args.add("-G%s=%s" % (key, value))
+    args.add_all(verilog_files)
+    
+    ctx.actions.run(
+        inputs = verilog_files,
+        outputs = [out_dir],
+        executable = ctx.executable._verilator,
+        arguments = [args],
+        mnemonic = "RTLVerilate",
+        progress_message = "Verilating %s" % ctx.attr.top,
+    )
+    
+    # Compile the generated model against the Verilator runtime
+    cc_toolchain = find_cpp_toolchain(ctx)
+    feature_configuration = cc_common.configure_features(
+        ctx = ctx,
+        cc_toolchain = cc_toolchain,
+        requested_features = ctx.features,
+        unsupported_features = ctx.disabled_features,
+    )
+    runtime = ctx.attr._runtime[CcInfo]
+    compilation_context, compilation_outputs = cc_common.compile(
+        name = ctx.label.name,
+        actions = ctx.actions,
+        feature_configuration = feature_configuration,
+        cc_toolchain = cc_toolchain,
+        srcs = [out_dir],
+        public_hdrs = [out_dir],
+        includes = [out_dir.path],
+        user_compile_flags = ["-std=c++14", "-O2", "-w"],
+        compilation_contexts = [runtime.compilation_context],
+    )
+    linking_context, _ = cc_common.create_linking_context_from_compilation_outputs(
+        name = ctx.label.name,
+        actions = ctx.actions,
+        feature_configuration = feature_configuration,
+        cc_toolchain = cc_toolchain,
+        compilation_outputs = compilation_outputs,
+        linking_contexts = [runtime.linking_context],
+    )
+    
+    return [
+        DefaultInfo(files = depset([out_dir])),
+        cc_common.merge_cc_infos(
+            direct_cc_infos = [CcInfo(
+                compilation_context = compilation_context,
+                linking_context = linking_context,
+            )],
+            cc_infos = [runtime],
+        ),
+    ]
+
 # Rule definitions
 rtl_library = rule(
     implementation = _rtl_library_impl,
@@ -131,13 +201,16 @@ rtl_macro_gen = rule(
             mandatory = True,
             doc = "List of output files to generate",
         ),
+        "defines": attr.string_dict(
+            doc = "Template variables, e.g. DATA_WIDTH and COMPUTE_WIDTH",
+        ),
         "_generator": attr.label(
-            default = "@rtl_tools//:jinja_gen",
+            default = "//tools/rtl:jinja_gen",
             executable = True,
             cfg = "exec",
         ),
     },
-    doc = "Generates RTL files from Jinja2 templates",
+    doc = "Generates RTL files (and their C++ models) from Jinja2 templates",
 )
 
 rtl_synthesis = rule(
@@ -161,6 +234,72 @@ rtl_synthesis = rule(
     doc = "Synthesizes RTL to gate-level netlist",
 )
 
+rtl_verilate = rule(
+    implementation = _rtl_verilate_impl,
+    attrs = {
+        "srcs": attr.label_list(
+            allow_files = [".v", ".sv"],
+            mandatory = True,
+            doc = "Verilog sources, including generated ones",
+        ),
+        "top": attr.string(
+            mandatory = True,
+            doc = "Top module; the C++ class is V<top> in V<top>.h",
+        ),
+        "parameters": attr.string_dict(
+            doc = "Top-level parameter overrides (-G)",
+        ),
+        "_verilator": attr.label(
+            default = "@rtl_tools//:verilator",
+            executable = True,
+            cfg = "exec",
+        ),
+        "_runtime": attr.label(
+            default = "@rtl_tools//:verilator_runtime",
+            providers = [CcInfo],
+        ),
+        "_cc_toolchain": attr.label(
+            default = "@bazel_tools//tools/cpp:current_cc_toolchain",
+        ),
+    },
+    fragments = ["cpp"],
+    toolchains = ["@bazel_tools//tools/cpp:toolchain_type"],
+    doc = "Verilates RTL into a C++ model usable as a cc_library dependency",
+)
+
+def precision_defines(precision, compute_width = 16):
+    """Template defines for a precision string such as int4 or int8"""
+    if not precision.startswith("int"):
+        fail("unsupported precision %s" % precision)
+    data_width = int(precision[3:])
+    if data_width < 1 or data_width > 8:
+        fail("unsupported precision %s" % precision)
+    return {
+        "DATA_WIDTH": str(data_width),
+        "COMPUTE_WIDTH": str(compute_width),
+    }
+
+def cim_array_model(name, sizes, defines = {}, **kwargs):
+    """C++ models of generated cell arrays, from cell_array.h.jinja2
+
+    Each "ROWSxCOLS" in sizes yields <name>/array_ROWSxCOLS.h, declaring
+    cim::gen::CellArrayROWSxCOLS with constexpr geometry and precision.
+    Use the same defines as the Verilog generation so both match.
+    """
+    rtl_macro_gen(
+        name = name + "_gen",
+        template = "//tools/rtl/templates:cell_array.h.jinja2",
+        outputs = ["%s/array_%s.h" % (name, size) for size in sizes],
+        defines = defines,
+    )
+
+    native.cc_library(
+        name = name,
+        hdrs = [":" + name + "_gen"],
+        deps = ["//rtl/memory:cim_engine"],
+        **kwargs
+    )
+
 def memory_array(name, size, cell_type, precision = "int8", power_mode = "balanced", **kwargs):
     """High-level macro for building memory arrays"""
     
@@ -181,6 +320,8 @@ def memory_array(name, size, cell_type, precision = "int8", power_mode = "balanc
         bank_size = 64
         build_strategy = "single"
     
+    defines = precision_defines(precision)
+    
     # Generate cell array templates
     rtl_macro_gen(
         name = name + "_arrays_gen",
@@ -189,6 +330,14 @@ def memory_array(name, size, cell_type, precision = "int8", power_mode = "balanc
             "gen/array_%dx%d.v" % (tile_size, tile_size),
             "gen/bank_%dx%d.v" % (bank_size, bank_size),
         ],
+        defines = defines,
+    )
+    
+    # C++ model of the tile, from the same parameters
+    cim_array_model(
+        name = name + "_model",
+        sizes = ["%dx%d" % (tile_size, tile_size)],
+        defines = defines,
     )
     
     # Build the memory cell
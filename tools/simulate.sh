@@ -24,31 +24,35 @@ case $MODE in
         echo "Running SystemC simulation..."
         bazel run //systemc:testbench
         ;;
+
+    batch)
+        echo "Running SystemC scenario batch..."
+        bazel build //systemc:batch_runner
+        bazel-bin/systemc/batch_runner "${@:2}" systemc/scenarios.txt
+        ;;
     
     co-sim)
         echo "Running co-simulation with SystemC and QEMU..."
-        # Start SystemC simulation in background
-        bazel-bin/systemc/testbench &
-        SYSTEMC_PID=$!
-        
-        # Give SystemC time to initialize
-        sleep 2
-        
-        # Start QEMU with connection to SystemC
-        qemu-system-arm \
-            -machine lm3s6965evb \
-            -cpu cortex-m3 \
-            -nographic \
-            -kernel bazel-bin/firmware/firmware \
-            -chardev socket,id=systemc,host=localhost,port=5555,server=on,wait=off \
-            -serial chardev:systemc
-        
-        # Clean up
-        kill $SYSTEMC_PID 2>/dev/null || true
+        # One QEMU + SystemC pair per firmware image, in parallel
+        bazel build //systemc:cosim_server //tools/cosim:orchestrator
+        FIRMWARE=("${@:3}")
+        PAIR_ARGS=()
+        if [ ${#FIRMWARE[@]} -eq 0 ]; then
+            # The bundled firmware never exits and drives the timer, UART
+            # and GPIO, so serve those and stop it after a fixed time.
+            FIRMWARE=(bazel-bin/firmware/firmware)
+            PAIR_ARGS=(--server-arg --map --server-arg firmware --run-for "${COSIM_RUN_FOR:-5}")
+        fi
+        bazel-bin/tools/cosim/orchestrator \
+            --server bazel-bin/systemc/cosim_server \
+            --log-dir "${COSIM_LOG_DIR:-/tmp}" \
+            ${COSIM_JOBS:+-j $COSIM_JOBS} \
+            "${PAIR_ARGS[@]}" \
+            "${FIRMWARE[@]}"
         ;;
     
     *)
-        echo "Usage: $0 [qemu|systemc|co-sim] [arm|riscv]"
+        echo "Usage: $0 [qemu|systemc|batch|co-sim] [arm|riscv]"
         exit 1
         ;;
 esac
\ No newline at end of file